@@ -0,0 +1,39 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+//
+// Host replacement for ESP-IDF's esp_log.h (logging HAL of the host build).
+// ESP_LOGx calls in the firmware sources route to idrive::sim::Log(), which
+// writes to stderr. Arguments are only evaluated when the level is enabled,
+// so benchmarks are not log-bound.
+
+#pragma once
+
+typedef enum {
+    ESP_LOG_NONE,
+    ESP_LOG_ERROR,
+    ESP_LOG_WARN,
+    ESP_LOG_INFO,
+    ESP_LOG_DEBUG,
+    ESP_LOG_VERBOSE,
+} esp_log_level_t;
+
+namespace idrive::sim {
+
+void SetLogLevel(esp_log_level_t level);
+bool LogEnabled(esp_log_level_t level);
+void Log(esp_log_level_t level, const char *tag, const char *format, ...);
+
+}  // namespace idrive::sim
+
+#define IDRIVE_SIM_LOG(level, tag, format, ...)                        \
+    do {                                                               \
+        if (idrive::sim::LogEnabled(level)) {                          \
+            idrive::sim::Log(level, tag, format, ##__VA_ARGS__);       \
+        }                                                              \
+    } while (0)
+
+#define ESP_LOGE(tag, format, ...) IDRIVE_SIM_LOG(ESP_LOG_ERROR, tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) IDRIVE_SIM_LOG(ESP_LOG_WARN, tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) IDRIVE_SIM_LOG(ESP_LOG_INFO, tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) IDRIVE_SIM_LOG(ESP_LOG_DEBUG, tag, format, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...) IDRIVE_SIM_LOG(ESP_LOG_VERBOSE, tag, format, ##__VA_ARGS__)
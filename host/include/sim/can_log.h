@@ -0,0 +1,57 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+//
+// Text CAN log formats.
+// candump log format ("candump -l"): one frame per line,
+//   (1700000000.123456) can0 0BF#0011223344556677
+// Vector ASC: "   12.345678 1  BF              Rx   d 8 00 11 22 33 44 55 66 77"
+// Only classic CAN data frames are handled; RTR and CAN FD lines are skipped.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+#include "can/can_message.h"
+
+namespace idrive::sim {
+
+// Parse one line. The timestamp is converted to microseconds. Returns false
+// for blank, comment, malformed, RTR or CAN FD lines.
+bool ParseCandumpLine(const char *line, CanMessage &msg);
+
+// Parse one ASC frame line. decimal_ids follows the "base dec" header.
+// Returns false for headers, events, error, remote and CAN FD frames.
+bool ParseAscLine(const char *line, bool decimal_ids, CanMessage &msg);
+
+// Format a frame as one candump log line (no trailing newline).
+// Returns the number of characters written (snprintf semantics).
+int FormatCandumpLine(const CanMessage &msg, const char *iface, char *out, size_t size);
+
+// Format a frame as one ASC line on channel 1, time relative to base_us.
+int FormatAscLine(const CanMessage &msg, bool tx, uint64_t base_us, char *out, size_t size);
+
+// ASC file header and footer lines (no trailing newline after the last).
+const char *AscHeader();
+const char *AscFooter();
+
+// Streams frames out of a candump or ASC log; the format is detected per line.
+class CanLogReader {
+   public:
+    explicit CanLogReader(std::FILE *in) : in_(in) {}
+
+    // Next frame in file order. Returns false at end of file.
+    bool Next(CanMessage &msg);
+
+    uint64_t Lines() const { return lines_; }
+    uint64_t Frames() const { return frames_; }
+
+   private:
+    std::FILE *in_;
+    bool       decimal_ids_ = false;
+    uint64_t   lines_       = 0;
+    uint64_t   frames_      = 0;
+};
+
+}  // namespace idrive::sim
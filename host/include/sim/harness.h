@@ -0,0 +1,82 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+//
+// Pieces shared by the idrive_sim modes: the command line options and the
+// pass/fail bookkeeping of the check modes. The modes are grouped by area in
+// host/src/check_*.cpp; main.cpp parses the options and picks one.
+
+#pragma once
+
+#include <cstdint>
+
+#include "can/can_message.h"
+#include "config/config.h"
+#include "esp_log.h"
+#include "hid/hid_mouse.h"
+#include "sim/sim_ports.h"
+
+namespace idrive::sim {
+
+struct Args {
+    const char     *mode         = nullptr;
+    const char     *operand      = nullptr;
+    uint32_t        detection_id = can_id::kRotaryInit;
+    esp_log_level_t log_level    = ESP_LOG_WARN;
+    bool            asc          = false;
+    bool            rx_only      = false;
+    double          speed        = 0.0;
+    const char     *golden       = nullptr;
+    int             noise        = 0;
+};
+
+// Failures of one check mode. Each named check prints one aligned line;
+// Finish() prints the count and gives the exit status (3 on any failure).
+class Checks {
+   public:
+    void operator()(const char *what, bool ok);
+
+    // A result the caller printed itself, e.g. one row of a table.
+    void Count(bool ok) { failures_ += ok ? 0 : 1; }
+
+    int Finish() const;
+
+   private:
+    int failures_ = 0;
+};
+
+// Resolution Multiplier feature byte of a host that reads wheel and pan in
+// high-resolution units (logical 1 in both 2-bit fields).
+constexpr uint8_t kHiResMultiplier = 0x05;
+
+// ZBE4 touchpad frame: contact at (x, y), second contact at (x2, y2).
+CanMessage TouchFrame(uint64_t t_us, uint8_t state, int x, int y, int x2 = 0, int y2 = 0);
+
+// Mouse report as sent in report protocol (report ID kReportIdMouse).
+MouseReport MouseOf(const HidReportRecord &r);
+
+// Touchpad pipeline (check_touch.cpp)
+int RunAccel(const Args &args);
+int RunDrag(const Args &args);
+int RunFilter(const Args &args);
+int RunSwipe(const Args &args);
+int RunPinch(const Args &args);
+int RunTap(const Args &args);
+
+// USB HID (check_hid.cpp)
+int RunDigitizer(const Args &args);
+int RunMouse(const Args &args);
+int RunTaps(const Args &args);
+
+// Knob, joystick and buttons (check_controls.cpp)
+int RunRotary(const Args &args);
+int RunJoystick(const Args &args);
+int RunButtons(const Args &args);
+
+// Periodic scheduler (check_sched.cpp)
+int RunSched(const Args &args);
+
+// CAN receive path (check_can.cpp)
+int RunRing(const Args &args);
+int RunDispatch(const Args &args);
+
+}  // namespace idrive::sim
@@ -0,0 +1,70 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+//
+// Replay of recorded CAN logs through the simulator.
+// Frames keep their relative timing in virtual time. By default virtual time
+// runs as fast as the host allows; a speed factor paces it against the wall
+// clock instead (1.0 = original timing). The HID reports produced can be
+// diffed against a golden file to catch behaviour changes.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+
+#include "sim/can_log.h"
+#include "sim/simulator.h"
+
+namespace idrive::sim {
+
+struct ReplayOptions {
+    double   speed           = 0.0;     // Wall-clock pacing factor; 0 = as fast as possible
+    uint64_t start_offset_us = 1000;    // First frame lands this long after the current time
+    uint64_t drain_us        = 200000;  // Time run after the last frame for releases to fire
+};
+
+struct ReplayResult {
+    uint64_t frames  = 0;
+    uint64_t reports = 0;
+    double   bus_s   = 0.0;  // Virtual time covered
+    double   wall_s  = 0.0;  // Host time taken
+};
+
+using ReportSink = std::function<void(const HidReportRecord &)>;
+
+// Feed every frame from reader into sim and hand each polled report to sink.
+// Reports are not kept in the simulator, so logs of any length stream through.
+ReplayResult Replay(Simulator &sim, CanLogReader &reader, const ReplayOptions &options,
+                    const ReportSink &sink);
+
+// One report as a text line (no newline): "<time_us> <kind> <hex bytes...>".
+int FormatReportLine(const HidReportRecord &report, char *out, size_t size);
+
+// Compares report lines against a golden file, line by line.
+class GoldenDiff {
+   public:
+    static constexpr uint32_t kMaxShown = 10;  // Mismatches printed in full
+
+    explicit GoldenDiff(std::FILE *golden) : golden_(golden) {}
+
+    // Check the next produced line.
+    void Check(const char *line);
+
+    // Account for golden lines that were never produced. Returns true if the
+    // output matched the golden file exactly.
+    bool Finish();
+
+    uint64_t Lines() const { return lines_; }
+    uint64_t Mismatches() const { return mismatches_; }
+
+   private:
+    std::FILE *golden_;
+    uint64_t   lines_      = 0;
+    uint64_t   mismatches_ = 0;
+
+    void Report(const char *expected, const char *actual);
+};
+
+}  // namespace idrive::sim
@@ -0,0 +1,16 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+//
+// Virtual clock behind utils::GetMillis()/GetMicros() in the host build.
+// Time only moves when the simulator sets it.
+
+#pragma once
+
+#include <cstdint>
+
+namespace idrive::sim {
+
+void     SetTimeUs(uint64_t now_us);
+uint64_t TimeUs();
+
+}  // namespace idrive::sim
@@ -0,0 +1,155 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+//
+// In-memory CanPort and HidPort for the host simulator.
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "can/can_port.h"
+#include "hid/hid_port.h"
+#include "sim/sim_clock.h"
+
+namespace idrive::sim {
+
+// A HID report as the host received it.
+struct HidReportRecord {
+    uint64_t time_us   = 0;  // Host poll that picked it up
+    uint8_t  report_id = 0;
+    uint8_t  len       = 0;
+    uint8_t  data[16]  = {0};
+};
+
+// =============================================================================
+// CAN
+// =============================================================================
+
+class SimCanPort : public CanPort {
+   public:
+    bool Send(uint32_t id, const uint8_t *data, uint8_t length, bool extended = false) override
+    {
+        tx_count_++;
+        if (record_tx_) {
+            CanMessage msg;
+            msg.id           = id;
+            msg.length       = length > 8 ? 8 : length;
+            msg.extended     = extended;
+            msg.timestamp_us = TimeUs();
+            std::memcpy(msg.data, data, msg.length);
+            tx_log_.push_back(msg);
+        }
+        return true;
+    }
+
+    void SetCallback(MessageCallback callback) override { callback_ = std::move(callback); }
+    void SetBurstEndCallback(BurstEndCallback callback) override
+    {
+        burst_end_ = std::move(callback);
+    }
+
+    // Deliver a received frame to the controller.
+    void Deliver(const CanMessage &msg)
+    {
+        in_burst_ = true;
+        if (callback_) {
+            callback_(msg);
+        }
+    }
+
+    // Everything delivered since the last call was one dispatch burst.
+    void EndBurst()
+    {
+        if (in_burst_ && burst_end_) {
+            burst_end_();
+        }
+        in_burst_ = false;
+    }
+
+    void                           RecordTx(bool enable) { record_tx_ = enable; }
+    const std::vector<CanMessage> &TxLog() const { return tx_log_; }
+    uint64_t                       TxCount() const { return tx_count_; }
+
+   private:
+    MessageCallback         callback_;
+    BurstEndCallback        burst_end_;
+    bool                    in_burst_  = false;
+    bool                    record_tx_ = false;
+    uint64_t                tx_count_  = 0;
+    std::vector<CanMessage> tx_log_;
+};
+
+// =============================================================================
+// HID
+// =============================================================================
+
+// Models one interrupt IN endpoint: a submitted report waits until the next
+// host poll, which then signals completion.
+class SimHidPort : public HidPort {
+   public:
+    static constexpr uint64_t kNoWakeup = UINT64_MAX;
+
+    void SetMounted(bool mounted) { mounted_ = mounted; }
+
+    bool IsMounted() const override { return mounted_; }
+    bool IsReady() const override { return mounted_ && !in_flight_; }
+
+    bool SendReport(uint8_t report_id, const void *data, uint16_t len) override
+    {
+        if (!IsReady()) {
+            return false;
+        }
+        if (len > sizeof(pending_.data)) {
+            len = sizeof(pending_.data);
+        }
+        in_flight_         = true;
+        pending_.report_id = report_id;
+        pending_.len       = static_cast<uint8_t>(len);
+        std::memcpy(pending_.data, data, len);
+        return true;
+    }
+
+    void ArmReleaseTimer(uint64_t delay_us) override
+    {
+        if (wakeup_us_ == kNoWakeup) {
+            wakeup_us_ = TimeUs() + delay_us;
+        }
+    }
+
+    // Host poll at now_us. Returns true if a report was picked up; the caller
+    // must then call UsbHidDevice::OnReportComplete().
+    bool Poll(uint64_t now_us)
+    {
+        if (!in_flight_) {
+            return false;
+        }
+        in_flight_       = false;
+        pending_.time_us = now_us;
+        if (record_) {
+            reports_.push_back(pending_);
+        }
+        report_count_++;
+        return true;
+    }
+
+    uint64_t WakeupUs() const { return wakeup_us_; }
+    void     ClearWakeup() { wakeup_us_ = kNoWakeup; }
+
+    void                                Record(bool enable) { record_ = enable; }
+    const std::vector<HidReportRecord> &Reports() const { return reports_; }
+    void                                ClearReports() { reports_.clear(); }
+    uint64_t                            ReportCount() const { return report_count_; }
+
+   private:
+    bool                         mounted_      = false;
+    bool                         in_flight_    = false;
+    bool                         record_       = true;
+    uint64_t                     wakeup_us_    = kNoWakeup;
+    uint64_t                     report_count_ = 0;
+    HidReportRecord              pending_;
+    std::vector<HidReportRecord> reports_;
+};
+
+}  // namespace idrive::sim
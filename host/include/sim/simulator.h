@@ -0,0 +1,74 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+//
+// Host simulator for the input pipeline.
+// Runs the real IDriveController, protocols, input handlers, UsbHidDevice and
+// PeriodicScheduler against in-memory ports and a virtual clock. Feed
+// timestamped CAN frames in; HID reports come out as the host would poll them.
+// Everything runs on the calling thread, in virtual time.
+
+#pragma once
+
+#include <cstdint>
+
+#include "config/config.h"
+#include "hid/usb_hid_device.h"
+#include "idrive/idrive_controller.h"
+#include "sched/periodic_scheduler.h"
+#include "sim/sim_ports.h"
+
+namespace idrive::sim {
+
+struct SimOptions {
+    uint32_t usb_poll_interval_us  = 10000;  // bInterval of the HID endpoint (10 ms)
+    uint32_t main_loop_interval_us = 50000;  // IDriveController::Update() cadence in app_main
+    bool     record_reports        = true;   // Keep every report (off for pure throughput)
+    bool     record_tx             = false;  // Keep every transmitted CAN frame
+};
+
+class Simulator {
+   public:
+    explicit Simulator(const Config &config = DefaultConfig(), const SimOptions &options = {});
+
+    Simulator(const Simulator &)            = delete;
+    Simulator &operator=(const Simulator &) = delete;
+
+    // Mount USB, initialize the controller and take it to ready by feeding a
+    // detection frame (ZBE4 rotary init response by default) and running
+    // through the cooldown. Returns IDriveController::IsReady().
+    bool BringUp(uint32_t detection_id = can_id::kRotaryInit);
+
+    // Run virtual time up to msg.timestamp_us, then deliver the frame.
+    // Frames with a timestamp in the past are delivered at the current time.
+    // Frames delivered at one instant form one CAN burst.
+    void Feed(const CanMessage &msg);
+
+    // Run scheduler jobs, USB polls, tap releases and main-loop updates up to
+    // and including t_us.
+    void AdvanceTo(uint64_t t_us);
+
+    uint64_t NowUs() const { return now_us_; }
+    uint64_t FramesFed() const { return frames_fed_; }
+
+    UsbHidDevice     &Hid() { return hid_; }
+    IDriveController &Controller() { return controller_; }
+    SimCanPort       &Can() { return can_; }
+    SimHidPort       &HidPort() { return hid_port_; }
+
+    static Config DefaultConfig();
+
+   private:
+    SimOptions        options_;
+    SimCanPort        can_;
+    SimHidPort        hid_port_;
+    UsbHidDevice      hid_;
+    PeriodicScheduler scheduler_;
+    IDriveController  controller_;
+
+    uint64_t now_us_        = 0;
+    uint64_t next_usb_poll_ = 0;
+    uint64_t next_update_   = 0;
+    uint64_t frames_fed_    = 0;
+};
+
+}  // namespace idrive::sim
@@ -0,0 +1,38 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+//
+// Reader for CAN trace dumps captured from the firmware console.
+// CanTraceBuffer::Dump() prints
+//   CANTRACE begin start_us=... bytes=... records=... overwritten=...
+//   CANTRACE data 0A1B2C...
+//   CANTRACE end
+// Anything else on the line before "CANTRACE" (log prefixes) and all other
+// lines are ignored, so a raw serial capture can be fed in as is.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "can/can_message.h"
+
+namespace idrive::sim {
+
+struct TraceFrame {
+    CanMessage msg;  // timestamp_us is firmware time (us since boot)
+    bool       tx = false;
+};
+
+struct TraceDumpInfo {
+    size_t   dumps       = 0;  // Complete dumps found
+    size_t   records     = 0;  // Records decoded
+    size_t   truncated   = 0;  // Dumps that ended early or did not decode cleanly
+    uint32_t overwritten = 0;  // Frames the firmware had already dropped (sum)
+};
+
+// Decode every complete dump in the input, in order, appending to frames.
+TraceDumpInfo ReadTraceDumps(std::FILE *in, std::vector<TraceFrame> &frames);
+
+}  // namespace idrive::sim
@@ -0,0 +1,254 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+
+#include "sim/can_log.h"
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace idrive::sim {
+
+namespace {
+
+int HexDigit(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+const char *SkipSpaces(const char *p)
+{
+    while (*p == ' ' || *p == '\t') {
+        ++p;
+    }
+    return p;
+}
+
+// Parse "<seconds>.<fraction>" into microseconds. Returns the end, or nullptr.
+const char *ParseSeconds(const char *p, uint64_t &time_us)
+{
+    if (!std::isdigit(static_cast<unsigned char>(*p))) {
+        return nullptr;
+    }
+    char    *end     = nullptr;
+    uint64_t seconds = std::strtoull(p, &end, 10);
+    if (*end != '.') {
+        return nullptr;
+    }
+    p = end + 1;
+
+    uint64_t micros = 0;
+    int      digits = 0;
+    for (; std::isdigit(static_cast<unsigned char>(*p)); ++p, ++digits) {
+        if (digits < 6) {
+            micros = micros * 10 + (*p - '0');
+        }
+    }
+    for (; digits < 6; ++digits) {
+        micros *= 10;
+    }
+
+    time_us = seconds * 1000000ULL + micros;
+    return p;
+}
+
+const char *SkipToken(const char *p)
+{
+    while (*p && *p != ' ' && *p != '\t') {
+        ++p;
+    }
+    return SkipSpaces(p);
+}
+
+}  // namespace
+
+bool ParseCandumpLine(const char *line, CanMessage &msg)
+{
+    const char *p = SkipSpaces(line);
+    if (*p != '(') {
+        return false;
+    }
+
+    // Timestamp: seconds '.' microseconds (always 6 digits in candump logs).
+    uint64_t time_us = 0;
+    p                = ParseSeconds(p + 1, time_us);
+    if (!p || *p != ')') {
+        return false;
+    }
+
+    // Interface name.
+    p = SkipToken(SkipSpaces(p + 1));
+
+    // Identifier: 3 hex digits for standard, 8 for extended frames.
+    uint32_t id     = 0;
+    int      id_len = 0;
+    for (int d; (d = HexDigit(*p)) >= 0; ++p, ++id_len) {
+        id = (id << 4) | static_cast<uint32_t>(d);
+    }
+    if (*p != '#' || (id_len != 3 && id_len != 8)) {
+        return false;
+    }
+    ++p;
+    if (*p == '#' || *p == 'R') {
+        return false;  // CAN FD or remote frame
+    }
+
+    msg          = CanMessage();
+    msg.id       = id;
+    msg.extended = (id_len == 8);
+
+    while (msg.length < 8) {
+        int hi = HexDigit(p[0]);
+        int lo = hi >= 0 ? HexDigit(p[1]) : -1;
+        if (lo < 0) {
+            break;
+        }
+        msg.data[msg.length++] = static_cast<uint8_t>((hi << 4) | lo);
+        p += 2;
+    }
+
+    msg.timestamp_us = time_us;
+    return true;
+}
+
+bool ParseAscLine(const char *line, bool decimal_ids, CanMessage &msg)
+{
+    // "   12.345678 1  264             Rx   d 8 01 02 03 04 05 06 07 08"
+    uint64_t    time_us = 0;
+    const char *p       = ParseSeconds(SkipSpaces(line), time_us);
+    if (!p || (*p != ' ' && *p != '\t')) {
+        return false;
+    }
+
+    // Channel number; event lines ("ErrorFrame", "CANFD", ...) fail here.
+    p = SkipSpaces(p);
+    if (!std::isdigit(static_cast<unsigned char>(*p))) {
+        return false;
+    }
+    p = SkipToken(p);
+
+    // Identifier, 'x' suffix for extended frames.
+    char    *end = nullptr;
+    uint32_t id  = static_cast<uint32_t>(std::strtoul(p, &end, decimal_ids ? 10 : 16));
+    if (end == p) {
+        return false;
+    }
+    bool extended = (*end == 'x' || *end == 'X');
+    if (extended) {
+        ++end;
+    }
+    if (*end != ' ' && *end != '\t') {
+        return false;
+    }
+
+    // Direction, then 'd' for data frames ('r' is remote).
+    p = SkipSpaces(end);
+    if (std::strncmp(p, "Rx", 2) != 0 && std::strncmp(p, "Tx", 2) != 0) {
+        return false;
+    }
+    p = SkipToken(p);
+    if (*p != 'd' || (p[1] != ' ' && p[1] != '\t')) {
+        return false;
+    }
+    p = SkipSpaces(p + 1);
+
+    int dlc = HexDigit(*p);
+    if (dlc < 0 || dlc > 8) {
+        return false;
+    }
+    p = SkipSpaces(p + 1);
+
+    msg          = CanMessage();
+    msg.id       = id;
+    msg.extended = extended;
+    for (int i = 0; i < dlc; ++i) {
+        int hi = HexDigit(p[0]);
+        int lo = hi >= 0 ? HexDigit(p[1]) : -1;
+        if (lo < 0) {
+            return false;
+        }
+        msg.data[msg.length++] = static_cast<uint8_t>((hi << 4) | lo);
+        p                      = SkipSpaces(p + 2);
+    }
+
+    msg.timestamp_us = time_us;
+    return true;
+}
+
+int FormatCandumpLine(const CanMessage &msg, const char *iface, char *out, size_t size)
+{
+    const char *format = msg.extended ? "(%llu.%06llu) %s %08lX#" : "(%llu.%06llu) %s %03lX#";
+
+    int n = std::snprintf(out, size, format,
+                          static_cast<unsigned long long>(msg.timestamp_us / 1000000ULL),
+                          static_cast<unsigned long long>(msg.timestamp_us % 1000000ULL), iface,
+                          static_cast<unsigned long>(msg.id));
+    for (uint8_t i = 0; i < msg.length && i < 8 && n >= 0 && static_cast<size_t>(n) < size; ++i) {
+        n += std::snprintf(out + n, size - n, "%02X", msg.data[i]);
+    }
+    return n;
+}
+
+int FormatAscLine(const CanMessage &msg, bool tx, uint64_t base_us, char *out, size_t size)
+{
+    char id[16];
+    std::snprintf(id, sizeof(id), msg.extended ? "%lXx" : "%lX",
+                  static_cast<unsigned long>(msg.id));
+
+    uint64_t rel_us = msg.timestamp_us >= base_us ? msg.timestamp_us - base_us : 0;
+    uint8_t  length = msg.length > 8 ? 8 : msg.length;
+
+    int n = std::snprintf(out, size, "%4llu.%06llu 1  %-15s %s   d %u",
+                          static_cast<unsigned long long>(rel_us / 1000000ULL),
+                          static_cast<unsigned long long>(rel_us % 1000000ULL), id,
+                          tx ? "Tx" : "Rx", length);
+    for (uint8_t i = 0; i < length && n >= 0 && static_cast<size_t>(n) < size; ++i) {
+        n += std::snprintf(out + n, size - n, " %02X", msg.data[i]);
+    }
+    return n;
+}
+
+const char *AscHeader()
+{
+    return "date Thu Jan 1 00:00:00.000 am 1970\n"
+           "base hex  timestamps absolute\n"
+           "internal events logged\n"
+           "Begin Triggerblock Thu Jan 1 00:00:00.000 am 1970";
+}
+
+const char *AscFooter()
+{
+    return "End TriggerBlock";
+}
+
+bool CanLogReader::Next(CanMessage &msg)
+{
+    char line[512];
+    while (std::fgets(line, sizeof(line), in_)) {
+        lines_++;
+
+        const char *p = SkipSpaces(line);
+        if (*p == '(') {
+            if (ParseCandumpLine(p, msg)) {
+                frames_++;
+                return true;
+            }
+            continue;
+        }
+        if (std::strncmp(p, "base ", 5) == 0) {
+            decimal_ids_ = std::strncmp(SkipSpaces(p + 5), "dec", 3) == 0;
+            continue;
+        }
+        if (ParseAscLine(p, decimal_ids_, msg)) {
+            frames_++;
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace idrive::sim
@@ -0,0 +1,350 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+//
+// idrive_sim checks of the CAN receive path: the RX ring between the driver
+// task and the dispatch task, and the routing of frames by ID.
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "idrive/can_dispatch_table.h"
+#include "idrive/zbe4_protocol.h"
+#include "idrive/zbe4_rev03_protocol.h"
+#include "sim/harness.h"
+#include "utils/spsc_ring.h"
+
+namespace idrive::sim {
+
+// =============================================================================
+// CAN RX Ring
+// =============================================================================
+
+namespace {
+
+// Same depth as can_bus_config::kRxRingSize (can_bus.h needs the IDF driver).
+constexpr size_t kRxRingSize = 64;
+using RxRing                 = utils::SpscRing<CanMessage, kRxRingSize>;
+
+// Frame number `seq`, stamped so the consumer can check order and contents.
+CanMessage SequencedFrame(uint32_t seq)
+{
+    CanMessage msg;
+    msg.id           = 0x100 + (seq & 0x3FF);
+    msg.length       = 8;
+    msg.timestamp_us = seq;
+    std::memcpy(msg.data, &seq, sizeof(seq));
+    uint32_t check = ~seq;
+    std::memcpy(msg.data + 4, &check, sizeof(check));
+    return msg;
+}
+
+bool SequencedFrameOk(const CanMessage &msg, uint32_t seq)
+{
+    CanMessage expected = SequencedFrame(seq);
+    return msg.id == expected.id && msg.timestamp_us == seq &&
+           std::memcmp(msg.data, expected.data, sizeof(msg.data)) == 0;
+}
+
+// What the consumer thread saw.
+struct RingRun {
+    uint32_t received  = 0;
+    uint32_t out_order = 0;  // Frames not after the previous one, or torn
+    uint32_t gaps      = 0;  // Frames missing between two received ones
+    double   wall_s    = 0;
+};
+
+// Frames a lossy producer pushes before giving the consumer a turn.
+constexpr uint32_t kRingBurst = 16;
+
+// Push `frames` from a producer thread to a consumer thread. A lossless
+// producer retries while the ring is full; a lossy one drops the frame, as
+// the CAN RX task does, and sends in bursts. The consumer stalls now and
+// then, like a dispatch task that was preempted, so the ring does fill up.
+RingRun RunRingThreads(RxRing &ring, uint32_t frames, bool lossless)
+{
+    RingRun           run;
+    std::atomic<bool> done {false};
+    auto              start = std::chrono::steady_clock::now();
+
+    std::thread consumer([&] {
+        uint32_t   expected = 0;
+        CanMessage msg;
+        for (;;) {
+            if (!ring.Pop(msg)) {
+                if (done.load(std::memory_order_acquire) && ring.Empty()) {
+                    break;
+                }
+                std::this_thread::yield();
+                continue;
+            }
+            uint32_t seq = static_cast<uint32_t>(msg.timestamp_us);
+            if (seq < expected || !SequencedFrameOk(msg, seq)) {
+                run.out_order++;
+            } else {
+                run.gaps += seq - expected;
+                expected = seq + 1;
+            }
+            if (++run.received % 4096 == 0) {
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+        }
+    });
+
+    for (uint32_t seq = 0; seq < frames; ++seq) {
+        CanMessage msg = SequencedFrame(seq);
+        while (!ring.Push(msg) && lossless) {
+            std::this_thread::yield();
+        }
+        if (!lossless && seq % kRingBurst == kRingBurst - 1) {
+            std::this_thread::yield();  // Bus idle between bursts
+        }
+    }
+    done.store(true, std::memory_order_release);
+    consumer.join();
+
+    run.wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return run;
+}
+
+}  // namespace
+
+int RunRing(const Args &args)
+{
+    Checks check;
+
+    uint32_t frames = args.operand ? static_cast<uint32_t>(std::strtoul(args.operand, nullptr, 0))
+                                   : 4000000;
+
+    // One thread: fill past capacity, then drain.
+    std::printf("Single thread (%zu slots):\n", kRxRingSize);
+    {
+        static RxRing ring;
+        uint32_t      accepted = 0;
+        for (uint32_t seq = 0; seq < kRxRingSize + 3; ++seq) {
+            accepted += ring.Push(SequencedFrame(seq));
+        }
+        CanMessage msg;
+        uint32_t   popped   = 0;
+        bool       in_order = true;
+        while (ring.Pop(msg)) {
+            in_order = in_order && SequencedFrameOk(msg, popped++);
+        }
+        check("a full ring rejects and counts each overrun",
+              accepted == kRxRingSize && ring.Overruns() == 3 && ring.Pushed() == kRxRingSize);
+        check("drains in order, high-water mark at capacity",
+              in_order && popped == kRxRingSize && ring.HighWater() == kRxRingSize &&
+                  ring.Empty());
+    }
+
+    // Two threads, nothing dropped: every frame arrives once, in order.
+    std::printf("\nProducer and consumer threads, %lu frames:\n",
+                static_cast<unsigned long>(frames));
+    {
+        static RxRing ring;
+        RingRun       run = RunRingThreads(ring, frames, true);
+        std::printf("  lossless: received %lu, retried pushes %lu, high water %lu, "
+                    "%.1f Mframes/s\n",
+                    static_cast<unsigned long>(run.received),
+                    static_cast<unsigned long>(ring.Overruns()),
+                    static_cast<unsigned long>(ring.HighWater()), frames / run.wall_s / 1e6);
+        check("lossless: every frame once, in order, intact",
+              run.received == frames && run.out_order == 0 && run.gaps == 0 &&
+                  ring.Pushed() == frames);
+        check("lossless: high-water mark within capacity",
+              ring.HighWater() >= 1 && ring.HighWater() <= kRxRingSize &&
+                  (ring.Overruns() == 0 || ring.HighWater() == kRxRingSize));
+    }
+
+    // Two threads, full ring drops the frame: what arrives is in order, and
+    // every frame is either received or counted as an overrun.
+    {
+        static RxRing ring;
+        RingRun       run = RunRingThreads(ring, frames, false);
+        std::printf("  lossy:    received %lu, overruns %lu, high water %lu, %.1f Mframes/s\n",
+                    static_cast<unsigned long>(run.received),
+                    static_cast<unsigned long>(ring.Overruns()),
+                    static_cast<unsigned long>(ring.HighWater()), frames / run.wall_s / 1e6);
+        check("lossy: received frames in order, intact",
+              run.out_order == 0 && run.received == ring.Pushed());
+        check("lossy: each frame received or counted as an overrun",
+              run.received + ring.Overruns() == frames && run.gaps <= ring.Overruns());
+        check("lossy: the stalled consumer filled the ring",
+              ring.Overruns() > 0 && ring.HighWater() == kRxRingSize);
+    }
+
+    return check.Finish();
+}
+
+// =============================================================================
+// CAN Dispatch
+// =============================================================================
+
+namespace {
+
+// Where a received frame went: 0 dropped, 1 echo, 2 touchpad, 3 status,
+// 10 + i handled by protocol i.
+constexpr int kRouteDropped = 0;
+constexpr int kRouteHandled = 10;
+
+// OnCanMessage's routing before the dispatch table: compare against the echo
+// IDs, touch and status, then ask each protocol.
+int IfChainRoute(const CanMessage &msg,
+                 const std::vector<std::unique_ptr<idrive::ControllerProtocol>> &protocols,
+                 int &active)
+{
+    namespace can_id = idrive::can_id;
+    if (msg.id == can_id::kRotaryInitCmd || msg.id == can_id::kLight ||
+        msg.id == can_id::kPoll || msg.id == can_id::kTouchInitCmd) {
+        return 1;
+    }
+    if (msg.id == can_id::kTouch) {
+        return 2;
+    }
+    if (msg.id == can_id::kStatus) {
+        return 3;
+    }
+    if (active < 0) {
+        for (size_t i = 0; i < protocols.size(); ++i) {
+            if (protocols[i]->DetectionId() == msg.id) {
+                active = static_cast<int>(i);
+                break;
+            }
+        }
+    }
+    if (active >= 0 && protocols[active]->HandlesId(msg.id)) {
+        return kRouteHandled + active;
+    }
+    return kRouteDropped;
+}
+
+// The same decision through CanDispatchTable, as OnCanMessage makes it now.
+int TableRoute(const CanMessage &msg, const idrive::CanDispatchTable &table, int &active)
+{
+    const idrive::CanRouteEntry &entry = table.Lookup(msg.id, msg.extended);
+    switch (entry.route) {
+        case idrive::CanRoute::Ignore: return 1;
+        case idrive::CanRoute::Touch:  return 2;
+        case idrive::CanRoute::Status: return 3;
+        case idrive::CanRoute::Protocol:
+            if (active < 0 && entry.detect_mask != 0) {
+                active = __builtin_ctz(entry.detect_mask);
+            }
+            if (active >= 0 && (entry.handle_mask & (1u << active))) {
+                return kRouteHandled + active;
+            }
+            return kRouteDropped;
+        case idrive::CanRoute::Unrouted: return kRouteDropped;
+    }
+    return kRouteDropped;
+}
+
+// Frames per 100 on a K-CAN with the controller attached: the iDrive's own
+// traffic, our echoes, and body modules the adapter only has to drop.
+struct KCanShare {
+    uint32_t id;
+    int      share;
+};
+
+constexpr KCanShare kKCanMix[] = {
+    {0x0BF, 30},  // Touchpad
+    {0x264, 6},   // Rotary
+    {0x267, 2},   // Buttons and joystick
+    {0x5E7, 1},   // Status
+    {0x273, 1},   {0x202, 2}, {0x501, 4}, {0x317, 4},  // Echoes of our TX
+    {0x130, 6},   {0x1A1, 8}, {0x0AA, 8}, {0x1D0, 4},  // Terminal, speed, engine
+    {0x21A, 4},   {0x2CA, 2}, {0x3B4, 2}, {0x328, 2},  // Lights, temp, battery, clock
+    {0x380, 2},   {0x1D6, 4}, {0x3F9, 4}, {0x2FC, 4},  // VIN, wheel keys, doors
+};
+
+}  // namespace
+
+int RunDispatch(const Args &args)
+{
+    Checks check;
+
+    uint64_t frames = args.operand ? std::strtoull(args.operand, nullptr, 0) : 20000000ULL;
+
+    // The two protocols, registered as the controller registers them.
+    std::vector<std::unique_ptr<idrive::ControllerProtocol>> protocols;
+    protocols.push_back(std::make_unique<idrive::ZBE4Protocol>());
+    protocols.push_back(std::make_unique<idrive::ZBE4Rev03Protocol>());
+    idrive::CanDispatchTable table;
+    for (size_t i = 0; i < protocols.size(); ++i) {
+        auto index = static_cast<uint8_t>(i);
+        if (protocols[i]->DetectionId() != 0) {
+            table.AddDetection(protocols[i]->DetectionId(), index);
+        }
+        for (uint32_t id = 0; id < idrive::CanDispatchTable::kIdCount; ++id) {
+            if (protocols[i]->HandlesId(id)) {
+                table.AddHandler(id, index);
+            }
+        }
+    }
+
+    // Every standard ID, before detection and with each protocol active.
+    std::printf("Routing:\n");
+    int differ = 0;
+    for (int start = -1; start < static_cast<int>(protocols.size()); ++start) {
+        for (uint32_t id = 0; id < idrive::CanDispatchTable::kIdCount; ++id) {
+            CanMessage msg;
+            msg.id           = id;
+            int chain_active = start;
+            int table_active = start;
+            int chain        = IfChainRoute(msg, protocols, chain_active);
+            int routed       = TableRoute(msg, table, table_active);
+            differ += chain != routed || chain_active != table_active;
+        }
+    }
+    check("table routes every ID as the if-chain did", differ == 0);
+
+    // The K-CAN mix, shuffled, with ZBE4 detected.
+    std::vector<CanMessage> mix;
+    for (const KCanShare &share : kKCanMix) {
+        for (int i = 0; i < share.share * 41; ++i) {
+            CanMessage msg;
+            msg.id     = share.id;
+            msg.length = 8;
+            mix.push_back(msg);
+        }
+    }
+    uint32_t seed = 12345;
+    for (size_t i = mix.size() - 1; i > 0; --i) {
+        seed = seed * 1664525u + 1013904223u;
+        std::swap(mix[i], mix[seed % (i + 1)]);
+    }
+
+    auto time_route = [&](auto route) {
+        int      active = 0;
+        uint64_t sum    = 0;
+        auto     start  = std::chrono::steady_clock::now();
+        for (uint64_t n = 0; n < frames; n += mix.size()) {
+            for (const CanMessage &msg : mix) {
+                sum += route(msg, active);
+            }
+        }
+        double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        uint64_t sent = (frames + mix.size() - 1) / mix.size() * mix.size();
+        return std::make_pair(s * 1e9 / static_cast<double>(sent), sum);
+    };
+    auto chain  = time_route(
+        [&](const CanMessage &m, int &a) { return IfChainRoute(m, protocols, a); });
+    auto direct = time_route([&](const CanMessage &m, int &a) { return TableRoute(m, table, a); });
+
+    std::printf("\nK-CAN mix, %zu IDs, %llu frames:\n", sizeof(kKCanMix) / sizeof(kKCanMix[0]),
+                static_cast<unsigned long long>(frames));
+    std::printf("  if-chain %6.2f ns/frame\n", chain.first);
+    std::printf("  table    %6.2f ns/frame (%.1fx)\n", direct.first, chain.first / direct.first);
+    check("same routes on the mix", chain.second == direct.second);
+
+    return check.Finish();
+}
+
+}  // namespace idrive::sim
@@ -0,0 +1,594 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+//
+// idrive_sim checks of the knob, joystick and buttons.
+
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "hid/hid_keycodes.h"
+#include "hid/hid_mouse.h"
+#include "idrive/zbe4_rev03_protocol.h"
+#include "input/rotary_accel.h"
+#include "sim/harness.h"
+#include "sim/sim_ports.h"
+#include "sim/simulator.h"
+
+namespace idrive::sim {
+
+// =============================================================================
+// Rotary Acceleration
+// =============================================================================
+
+namespace {
+
+// A knob spin: `events` rotary frames of `detents` each, `interval_ms` apart.
+struct RotarySpin {
+    const char *name;
+    int         events;
+    int         detents;
+    uint32_t    interval_ms;
+};
+
+constexpr RotarySpin kRotarySpins[] = {
+    {"slow, 4/s", 20, 1, 250},  {"steady, 10/s", 30, 1, 100}, {"brisk, 20/s", 40, 1, 50},
+    {"fast, 50/s", 60, 1, 20},  {"flick, 200/s", 50, 2, 10},
+};
+
+const char *RotaryAccelName(idrive::RotaryAccelProfile profile)
+{
+    switch (profile) {
+        case idrive::RotaryAccelProfile::Off:      return "off";
+        case idrive::RotaryAccelProfile::Moderate: return "moderate";
+        case idrive::RotaryAccelProfile::Fast:     return "fast";
+    }
+    return "?";
+}
+
+CanMessage RotaryFrame(uint64_t t_us, uint16_t position)
+{
+    CanMessage msg;
+    msg.id           = idrive::can_id::kRotary;
+    msg.length       = 8;
+    msg.timestamp_us = t_us;
+    msg.data[3]      = static_cast<uint8_t>(position & 0xFF);
+    msg.data[4]      = static_cast<uint8_t>(position >> 8);
+    return msg;
+}
+
+}  // namespace
+
+int RunRotary(const Args &args)
+{
+    using idrive::RotaryAccel;
+    using idrive::RotaryAccelProfile;
+
+    Checks check;
+
+    const RotaryAccelProfile kProfiles[] = {RotaryAccelProfile::Off, RotaryAccelProfile::Moderate,
+                                            RotaryAccelProfile::Fast};
+
+    std::printf("%-14s %6s", "spin", "knob");
+    for (RotaryAccelProfile profile : kProfiles) {
+        std::printf(" %14s", RotaryAccelName(profile));
+    }
+    std::printf("\n");
+
+    // High-resolution wheel units per spin and profile, printed in detents.
+    constexpr int32_t kUnit   = idrive::kWheelUnitsPerDetent;
+    constexpr size_t  kSpins  = sizeof(kRotarySpins) / sizeof(kRotarySpins[0]);
+    int32_t          wheel[kSpins][3] = {};
+    for (size_t s = 0; s < kSpins; ++s) {
+        const RotarySpin &spin = kRotarySpins[s];
+        int32_t           knob = spin.events * spin.detents;
+        std::printf("%-14s %6ld", spin.name, static_cast<long>(knob));
+        for (size_t p = 0; p < 3; ++p) {
+            RotaryAccel accel(kProfiles[p]);
+            uint64_t    t_us = 1000000;
+            for (int e = 0; e < spin.events; ++e) {
+                wheel[s][p] += accel.Apply(spin.detents, t_us);
+                t_us += spin.interval_ms * 1000ULL;
+            }
+            std::printf(" %8.1f %4.1fx", static_cast<double>(wheel[s][p]) / kUnit,
+                        static_cast<double>(wheel[s][p]) / kUnit / knob);
+        }
+        std::printf("\n");
+    }
+
+    std::printf("\nChecks:\n");
+    bool exact_off = true, exact_slow = true, monotonic = true;
+    for (size_t s = 0; s < kSpins; ++s) {
+        int32_t knob = kRotarySpins[s].events * kRotarySpins[s].detents;
+        exact_off    = exact_off && wheel[s][0] == knob * kUnit;
+        for (size_t p = 1; p < 3; ++p) {
+            monotonic = monotonic && wheel[s][p] >= knob * kUnit &&
+                        (s == 0 || wheel[s][p] * kRotarySpins[s - 1].events *
+                                           kRotarySpins[s - 1].detents >=
+                                       wheel[s - 1][p] * knob);
+        }
+    }
+    exact_slow = wheel[0][1] == 20 * kUnit && wheel[0][2] == 20 * kUnit &&
+                 wheel[1][1] == 30 * kUnit && wheel[1][2] == 30 * kUnit;
+    check("off: one wheel detent per knob detent", exact_off);
+    check("slow and steady turns stay exact in every profile", exact_slow);
+    check("faster spins never scroll less per detent", monotonic);
+    check("a flick scrolls several times further",
+          wheel[kSpins - 1][1] >= 3 * 100 * kUnit && wheel[kSpins - 1][2] >= 8 * 100 * kUnit);
+
+    // Backing off one detent after a spin, and after a pause.
+    RotaryAccel accel(RotaryAccelProfile::Fast);
+    uint64_t    t_us = 1000000;
+    for (int e = 0; e < 40; ++e, t_us += 10000) {
+        accel.Apply(1, t_us);
+    }
+    int32_t back = accel.Apply(-1, t_us + 30000);
+    int32_t next = accel.Apply(1, t_us + 1000000);
+    check("reversal after a spin moves back exactly one", back == -kUnit);
+    check("first detent after a pause is exact", next == kUnit);
+
+    // Through the pipeline: ZBE4 rotary frames, knob up scrolls the wheel down.
+    // A host that set the resolution multiplier gets every unit, one that did
+    // not the whole detents.
+    RotaryAccelProfile profile = Simulator::DefaultConfig().rotary_accel;
+    size_t             p       = static_cast<size_t>(profile);
+    std::printf("\nPipeline (%s):\n", RotaryAccelName(profile));
+    const struct {
+        size_t  spin;
+        uint8_t multiplier;
+    } kRuns[] = {{0, 0}, {kSpins - 1, 0}, {0, kHiResMultiplier}, {kSpins - 1, kHiResMultiplier}};
+    for (const auto &run : kRuns) {
+        size_t            s          = run.spin;
+        uint8_t           multiplier = run.multiplier;
+        const RotarySpin &spin       = kRotarySpins[s];
+        Simulator         sim;
+        if (!sim.BringUp(args.detection_id)) {
+            std::fprintf(stderr, "controller did not become ready\n");
+            return 1;
+        }
+        sim.Hid().OnSetResolutionMultiplier(multiplier);
+        sim.HidPort().ClearReports();
+
+        uint16_t position = 0x1000;
+        uint64_t f_us     = sim.NowUs() + 10000;
+        sim.Feed(RotaryFrame(f_us, position));  // Sets the initial position
+        for (int e = 0; e < spin.events; ++e) {
+            f_us += spin.interval_ms * 1000ULL;
+            position = static_cast<uint16_t>(position + spin.detents);
+            sim.Feed(RotaryFrame(f_us, position));
+        }
+        sim.AdvanceTo(f_us + 1000000);
+
+        int32_t got = 0;
+        for (const HidReportRecord &r : sim.HidPort().Reports()) {
+            got += r.report_id == idrive::kReportIdMouse ? MouseOf(r).wheel : 0;
+        }
+        int32_t expected = multiplier ? -wheel[s][p] : -wheel[s][p] / kUnit;
+        char    what[80];
+        std::snprintf(what, sizeof(what), "%s, %s: wheel %ld, expected %ld", spin.name,
+                      multiplier ? "high-res" : "detents", static_cast<long>(got),
+                      static_cast<long>(expected));
+        check(what, got == expected);
+    }
+
+    // CAN bursts: a 200 detents/s spin whose frames reach the dispatch task
+    // four at a time (it stalled for 20 ms each time), with a reversal inside
+    // one burst. Without acceleration the wheel must match the knob exactly.
+    std::printf("\nBursts (4 frames per dispatch, accel off):\n");
+    {
+        idrive::Config config = Simulator::DefaultConfig();
+        config.rotary_accel   = RotaryAccelProfile::Off;
+        Simulator sim(config);
+        if (!sim.BringUp(args.detection_id)) {
+            std::fprintf(stderr, "controller did not become ready\n");
+            return 1;
+        }
+        sim.HidPort().ClearReports();
+        idrive::CoalesceStats before = sim.Controller().GetRotaryCoalesceStats();
+
+        uint16_t position = 0x1000;
+        int32_t  knob     = 0;
+        uint64_t f_us     = sim.NowUs() + 10000;
+        sim.Feed(RotaryFrame(f_us, position));
+        for (int burst = 0; burst < 20; ++burst) {
+            f_us += 20000;
+            for (int frame = 0; frame < 4; ++frame) {
+                int step = burst == 10 && frame >= 2 ? -1 : 1;
+                position = static_cast<uint16_t>(position + step);
+                knob += step;
+                sim.Feed(RotaryFrame(f_us, position));
+            }
+        }
+        sim.AdvanceTo(f_us + 1000000);
+
+        int32_t got = 0;
+        for (const HidReportRecord &r : sim.HidPort().Reports()) {
+            got += r.report_id == idrive::kReportIdMouse ? MouseOf(r).wheel : 0;
+        }
+        idrive::CoalesceStats after      = sim.Controller().GetRotaryCoalesceStats();
+        uint32_t              events     = after.events - before.events;
+        uint32_t              dispatched = after.dispatched - before.dispatched;
+        std::printf("  knob %ld, wheel %ld; %lu events, %lu dispatched, %lu saved\n",
+                    static_cast<long>(knob), static_cast<long>(got),
+                    static_cast<unsigned long>(events), static_cast<unsigned long>(dispatched),
+                    static_cast<unsigned long>(events - dispatched));
+        check("total detents preserved", got == -knob);
+        check("one dispatch per burst, two for the reversal", events == 80 && dispatched == 21);
+    }
+
+    return check.Finish();
+}
+
+// =============================================================================
+// Joystick Hold
+// =============================================================================
+
+namespace {
+
+// ZBE4 stick frame: direction in the high nibble of the state byte (a
+// direction of kStickCenter sends the center push instead).
+CanMessage JoystickFrame(uint64_t t_us, uint8_t direction, uint8_t state)
+{
+    CanMessage msg;
+    msg.id           = idrive::can_id::kInput;
+    msg.length       = 8;
+    msg.timestamp_us = t_us;
+    msg.data[3]      = static_cast<uint8_t>((direction << 4) | state);
+    msg.data[4]      = direction == idrive::protocol::kStickCenter
+                           ? idrive::protocol::kInputTypeCenter
+                           : idrive::protocol::kInputTypeStick;
+    return msg;
+}
+
+// What a host sees from one joystick hold.
+struct HoldOutcome {
+    int      taps    = 0;  // Key down edges of the arrow key
+    bool     down    = false;
+    int64_t  x       = 0;
+    int64_t  early_x = 0;  // First 100 ms of the glide
+    int64_t  late_x  = 0;  // Last 100 ms before the release
+    uint64_t last_us = 0;  // Last report with the key down or motion
+};
+
+// Hold the stick right for hold_ms, with held frames every frame_ms (0: the
+// press and the release only), then leave it alone for a second.
+HoldOutcome RunHold(const Args &args, bool as_mouse, uint32_t rate_hz, uint32_t hold_ms,
+                    uint32_t frame_ms)
+{
+    namespace protocol = idrive::protocol;
+
+    idrive::Config config          = Simulator::DefaultConfig();
+    config.joystick_as_mouse       = as_mouse;
+    config.joystick_repeat_rate_hz = rate_hz;
+
+    HoldOutcome outcome;
+    Simulator   sim(config);
+    if (!sim.BringUp(args.detection_id)) {
+        std::fprintf(stderr, "controller did not become ready\n");
+        return outcome;
+    }
+    sim.HidPort().ClearReports();
+
+    uint64_t press_us   = sim.NowUs() + 10000;
+    uint64_t release_us = press_us + hold_ms * 1000ULL;
+    sim.Feed(JoystickFrame(press_us, protocol::kStickRight, protocol::kInputPressed));
+    for (uint64_t t_us = press_us + frame_ms * 1000ULL; frame_ms && t_us < release_us;
+         t_us += frame_ms * 1000ULL) {
+        sim.Feed(JoystickFrame(t_us, protocol::kStickRight, protocol::kInputHeld));
+    }
+    sim.Feed(JoystickFrame(release_us, protocol::kStickRight, protocol::kInputReleased));
+    sim.AdvanceTo(release_us + 1000000);
+
+    uint64_t glide_us = press_us + config.joystick_repeat_delay_ms * 1000ULL;
+    for (const HidReportRecord &r : sim.HidPort().Reports()) {
+        if (r.report_id == idrive::kReportIdKeyboard) {
+            bool down = std::memchr(r.data + 2, idrive::hid::key::kRight, 6) != nullptr;
+            outcome.taps += down && !outcome.down;
+            outcome.down = down;
+            if (down) {
+                outcome.last_us = r.time_us;
+            }
+        } else if (r.report_id == idrive::kReportIdMouse) {
+            int16_t x = MouseOf(r).x;
+            outcome.x += x;
+            if (r.time_us >= glide_us && r.time_us < glide_us + 100000) {
+                outcome.early_x += x;
+            }
+            if (r.time_us >= release_us - 100000 && r.time_us < release_us) {
+                outcome.late_x += x;
+            }
+            if (x != 0) {
+                outcome.last_us = r.time_us;
+            }
+        }
+    }
+    outcome.last_us = outcome.last_us > release_us ? outcome.last_us - release_us : 0;
+    return outcome;
+}
+
+}  // namespace
+
+int RunJoystick(const Args &args)
+{
+    Checks check;
+
+    const uint32_t kRate     = idrive::config::kJoystickRepeatRateHz;
+    const uint32_t kDelayMs  = idrive::config::kJoystickRepeatDelayMs;
+    const uint32_t kFrames[] = {0, 20, 100};  // Held frame cadences, 0 = none
+
+    // Arrow keys: a tap on the press, then typematic repeats on the device's
+    // clock, however often the controller reports the hold.
+    std::printf("Arrow keys (%lu ms delay, %lu/s):\n", static_cast<unsigned long>(kDelayMs),
+                static_cast<unsigned long>(kRate));
+    HoldOutcome push = RunHold(args, false, kRate, 150, 20);
+    std::printf("  push 150 ms         %2d taps\n", push.taps);
+    check("a short push types one key", push.taps == 1 && !push.down);
+
+    const uint32_t kHoldMs  = 1200;
+    const int      kRepeats = static_cast<int>((kHoldMs - kDelayMs) * kRate / 1000) + 1;
+    bool           same     = true;
+    bool           stopped  = true;
+    for (uint32_t frame_ms : kFrames) {
+        HoldOutcome hold = RunHold(args, false, kRate, kHoldMs, frame_ms);
+        std::printf("  hold %lu ms, frames %3lu ms %2d taps\n",
+                    static_cast<unsigned long>(kHoldMs), static_cast<unsigned long>(frame_ms),
+                    hold.taps);
+        same    = same && hold.taps == 1 + kRepeats;
+        stopped = stopped && !hold.down && hold.last_us == 0;
+    }
+    check("a hold repeats at the rate, at every frame cadence", same);
+    check("the release stops the repeats", stopped);
+
+    HoldOutcome held = RunHold(args, false, 0, kHoldMs, 20);
+    check("rate 0: the key stays down until the release", held.taps == 1 && !held.down);
+
+    // Mouse: one step on the press, then a glide ramping up to full speed.
+    const int32_t kStep = idrive::config::kJoystickMoveStep;
+    const int32_t kLow  = idrive::config::kJoystickGlideStartSpeed;
+    const int32_t kHigh = idrive::config::kJoystickGlideMaxSpeed;
+    const int32_t kRamp = idrive::config::kJoystickGlideRampMs;
+    std::printf("\nMouse (glide %ld to %ld px/s over %ld ms):\n", static_cast<long>(kLow),
+                static_cast<long>(kHigh), static_cast<long>(kRamp));
+    push = RunHold(args, true, kRate, 150, 20);
+    std::printf("  push 150 ms         x %lld\n", static_cast<long long>(push.x));
+    check("a short push moves one step", push.x == kStep);
+
+    // Hold well past the ramp: the step, the ramp and the rest at full speed.
+    const uint32_t kGlideMs = 1500;
+    const int64_t  kTravel  = kStep + (kLow + kHigh) / 2 * kRamp / 1000 +
+                             kHigh * static_cast<int64_t>(kGlideMs - kDelayMs - kRamp) / 1000;
+    HoldOutcome glide[3];
+    for (size_t i = 0; i < 3; ++i) {
+        glide[i] = RunHold(args, true, kRate, kGlideMs, kFrames[i]);
+        std::printf("  hold %lu ms, frames %3lu ms x %lld (first 100 ms %lld, last %lld)\n",
+                    static_cast<unsigned long>(kGlideMs), static_cast<unsigned long>(kFrames[i]),
+                    static_cast<long long>(glide[i].x), static_cast<long long>(glide[i].early_x),
+                    static_cast<long long>(glide[i].late_x));
+    }
+    std::printf("  expected x %lld\n", static_cast<long long>(kTravel));
+    check("the glide covers the ramp's distance",
+          std::llabs(glide[0].x - kTravel) <= kHigh * idrive::config::kHidPollIntervalMs / 1000);
+    check("the same distance at every frame cadence",
+          glide[0].x == glide[1].x && glide[1].x == glide[2].x);
+    check("the glide speeds up while held",
+          glide[0].early_x > 0 && glide[0].late_x >= 4 * glide[0].early_x);
+    check("the release stops the glide",
+          glide[0].last_us <= idrive::config::kHidPollIntervalMs * 1000ULL);
+
+    // Without timed repeat, every frame steps: the speed is the frame rate's.
+    HoldOutcome fast = RunHold(args, true, 0, 1000, 20);
+    HoldOutcome slow = RunHold(args, true, 0, 1000, 100);
+    std::printf("  rate 0, frames 20 ms x %lld, frames 100 ms x %lld\n",
+                static_cast<long long>(fast.x), static_cast<long long>(slow.x));
+    check("rate 0: one step per frame as before", fast.x == 50 * kStep && slow.x == 10 * kStep);
+
+    return check.Finish();
+}
+
+// =============================================================================
+// ZBE4-03 Buttons
+// =============================================================================
+
+namespace {
+
+// The ZBE4-03 frame layout as documented in zbe4_rev03_protocol.h, kept apart
+// from the decoder's own table so the two check each other.
+struct Rev03Button {
+    size_t  byte;
+    uint8_t mask;
+    uint8_t id;
+};
+
+constexpr Rev03Button kRev03Buttons[] = {
+    {4, 0x04, idrive::protocol::kButtonMenu},   {4, 0x20, idrive::protocol::kButtonBack},
+    {5, 0x01, idrive::protocol::kButtonOption}, {5, 0x08, idrive::protocol::kButtonTel},
+    {6, 0x01, idrive::protocol::kButtonCd},     {6, 0x08, idrive::protocol::kButtonNav},
+    {7, 0x01, idrive::protocol::kButtonMap},
+};
+constexpr size_t kRev03ButtonCount = sizeof(kRev03Buttons) / sizeof(kRev03Buttons[0]);
+
+// byte[3] values and the direction each reports; index 0 is the stick at rest.
+constexpr uint8_t kRev03Sticks[]   = {0x00, 0x01, 0x10, 0x70, 0xA0, 0x40};
+constexpr uint8_t kRev03StickIds[] = {0,
+                                      idrive::protocol::kStickCenter,
+                                      idrive::protocol::kStickUp,
+                                      idrive::protocol::kStickDown,
+                                      idrive::protocol::kStickLeft,
+                                      idrive::protocol::kStickRight};
+constexpr size_t  kRev03StickCount = sizeof(kRev03Sticks);
+
+// Frame with the buttons in `pressed` (bit i: kRev03Buttons[i]) held.
+CanMessage Rev03Frame(uint32_t pressed, size_t stick, uint16_t position = 0x7FFF)
+{
+    static const uint8_t kIdle[8] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC0, 0xF8};
+
+    CanMessage msg;
+    msg.id     = 0x25B;
+    msg.length = 8;
+    std::memcpy(msg.data, kIdle, sizeof(kIdle));
+    msg.data[1] = static_cast<uint8_t>(position & 0xFF);
+    msg.data[2] = static_cast<uint8_t>(position >> 8);
+    msg.data[3] = kRev03Sticks[stick];
+    for (size_t i = 0; i < kRev03ButtonCount; ++i) {
+        if (pressed & (1u << i)) {
+            msg.data[kRev03Buttons[i].byte] |= kRev03Buttons[i].mask;
+        }
+    }
+    return msg;
+}
+
+}  // namespace
+
+int RunButtons(const Args &args)
+{
+    using idrive::InputEvent;
+    namespace protocol = idrive::protocol;
+
+    Checks check;
+
+    idrive::ZBE4Rev03Protocol decoder;
+    std::vector<InputEvent>   events;
+    decoder.SetEventCallback([&](const InputEvent &e) { events.push_back(e); });
+
+    // Every transition between two states: any button chord, with the stick
+    // at rest or in any direction. The second frame must report exactly the
+    // buttons that changed, once each, and the stick's release and press, or
+    // a held frame if the stick stayed in its direction.
+    const uint32_t kChords      = 1u << kRev03ButtonCount;
+    uint64_t       transitions  = 0;
+    uint64_t       edges        = 0;
+    uint64_t       wrong        = 0;
+    int            chord_events = 0;  // MENU+BACK pressed in one frame
+    for (uint32_t from = 0; from < kChords; ++from) {
+        for (size_t from_stick = 0; from_stick < kRev03StickCount; ++from_stick) {
+            for (uint32_t to = 0; to < kChords; ++to) {
+                for (size_t to_stick = 0; to_stick < kRev03StickCount; ++to_stick) {
+                    decoder.Receive(Rev03Frame(from, from_stick));
+                    events.clear();
+                    decoder.Receive(Rev03Frame(to, to_stick));
+                    transitions++;
+                    edges += events.size();
+
+                    // Expected stick edges (or the held direction) first,
+                    // then one per changed button.
+                    size_t expected = 0;
+                    bool   ok       = true;
+                    size_t next     = 0;
+                    if (from_stick == to_stick && to_stick != 0) {
+                        ok = ok && next < events.size() &&
+                             events[next].type == InputEvent::Type::Joystick &&
+                             events[next].id == kRev03StickIds[to_stick] &&
+                             events[next].state == protocol::kInputHeld;
+                        next++;
+                    } else if (from_stick != to_stick) {
+                        if (from_stick != 0) {
+                            ok = ok && next < events.size() &&
+                                 events[next].type == InputEvent::Type::Joystick &&
+                                 events[next].id == kRev03StickIds[from_stick] &&
+                                 events[next].state == protocol::kInputReleased;
+                            next++;
+                        }
+                        if (to_stick != 0) {
+                            ok = ok && next < events.size() &&
+                                 events[next].type == InputEvent::Type::Joystick &&
+                                 events[next].id == kRev03StickIds[to_stick] &&
+                                 events[next].state == protocol::kInputPressed;
+                            next++;
+                        }
+                    }
+                    expected = next;
+                    for (size_t i = 0; i < kRev03ButtonCount; ++i) {
+                        uint32_t bit = 1u << i;
+                        if (((from ^ to) & bit) == 0) {
+                            continue;
+                        }
+                        expected++;
+                        uint8_t state =
+                            (to & bit) ? protocol::kInputPressed : protocol::kInputReleased;
+                        int seen = 0;
+                        for (size_t e = next; e < events.size(); ++e) {
+                            seen += events[e].type == InputEvent::Type::Button &&
+                                    events[e].id == kRev03Buttons[i].id &&
+                                    events[e].state == state;
+                        }
+                        ok = ok && seen == 1;
+                    }
+                    ok = ok && events.size() == expected;
+                    wrong += ok ? 0 : 1;
+
+                    if (from == 0 && to == 3 && from_stick == 0 && to_stick == 0) {
+                        chord_events = static_cast<int>(events.size());
+                    }
+                }
+            }
+        }
+    }
+    std::printf("Transitions:\n");
+    std::printf("  %llu transitions, %llu edges, %llu wrong\n",
+                static_cast<unsigned long long>(transitions),
+                static_cast<unsigned long long>(edges), static_cast<unsigned long long>(wrong));
+    check("every transition reports exactly its edges", wrong == 0);
+    check("MENU+BACK in one frame are two presses", chord_events == 2);
+
+    // Bits that are not buttons (the idle base of bytes[6..7] included)
+    // never report anything, whatever else is held.
+    // The decoder warns about every such frame; the sweep sends them on purpose.
+    idrive::sim::SetLogLevel(std::min(args.log_level, ESP_LOG_ERROR));
+    uint64_t stray = 0;
+    for (uint32_t chord = 0; chord < kChords; ++chord) {
+        CanMessage held = Rev03Frame(chord, 0);
+        for (size_t byte = 4; byte < 8; ++byte) {
+            for (int b = 0; b < 8; ++b) {
+                uint8_t mask   = static_cast<uint8_t>(1u << b);
+                bool    button = false;
+                for (const Rev03Button &btn : kRev03Buttons) {
+                    button = button || (btn.byte == byte && btn.mask == mask);
+                }
+                if (button) {
+                    continue;
+                }
+                CanMessage flipped = held;
+                flipped.data[byte] ^= mask;
+                decoder.Receive(held);
+                events.clear();
+                decoder.Receive(flipped);
+                decoder.Receive(held);
+                stray += events.size();
+            }
+        }
+    }
+    idrive::sim::SetLogLevel(args.log_level);
+    std::printf("\nOther bits:\n");
+    check("bits outside the button table are ignored", stray == 0);
+
+    // Rotary comes from idle frames only: a turn while a button is held is
+    // reported with the release.
+    std::printf("\nRotary:\n");
+    auto rotary = [&]() {
+        int delta = 0;
+        for (const InputEvent &e : events) {
+            delta += e.type == InputEvent::Type::Rotary ? e.delta : 0;
+        }
+        return delta;
+    };
+    decoder.Receive(Rev03Frame(0, 0, 0x7F10));
+    events.clear();
+    decoder.Receive(Rev03Frame(0, 0, 0x7F13));
+    int idle_turn = rotary();
+    events.clear();
+    decoder.Receive(Rev03Frame(1, 0, 0x7F15));
+    int held_turn = rotary();
+    events.clear();
+    decoder.Receive(Rev03Frame(0, 0, 0x7F15));
+    int release_turn = rotary();
+    std::printf("  idle %d, held %d, on release %d\n", idle_turn, held_turn, release_turn);
+    check("turns decoded from idle frames, held ones on release",
+          idle_turn == 3 && held_turn == 0 && release_turn == 2);
+
+    return check.Finish();
+}
+
+}  // namespace idrive::sim
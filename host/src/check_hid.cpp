@@ -0,0 +1,825 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+//
+// idrive_sim checks of the USB HID side: report descriptors, the digitizer
+// encoder, mouse motion and scroll, and timed tap releases.
+
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "hid/hid_digitizer.h"
+#include "hid/hid_keycodes.h"
+#include "hid/hid_mouse.h"
+#include "hid/usb_hid_device.h"
+#include "input/digitizer_encoder.h"
+#include "sim/harness.h"
+#include "sim/sim_clock.h"
+#include "sim/sim_ports.h"
+#include "sim/simulator.h"
+
+namespace idrive::sim {
+
+// =============================================================================
+// Digitizer Descriptor and Encoder
+// =============================================================================
+
+namespace {
+
+// One data or padding field of a report, as a host parses the descriptor.
+struct HidField {
+    uint8_t  main;         // 0x80 Input, 0xB0 Feature
+    uint32_t bit;          // Offset after the report ID
+    uint32_t size;         // Bits
+    uint16_t page;         // Usage page
+    uint16_t usage;        // 0 for constant padding
+    uint32_t logical_max;  // Unsigned
+};
+
+// Minimal short-item parser: enough for the fields of one report ID.
+std::vector<HidField> ParseReportFields(const uint8_t *desc, size_t len, uint8_t report_id)
+{
+    std::vector<HidField> fields;
+    std::vector<uint16_t> usages;
+    uint16_t              page = 0, size = 0, count = 0;
+    uint32_t              logical_max = 0, input_bit = 0, feature_bit = 0;
+    uint8_t               id          = 0;
+
+    for (size_t i = 0; i < len;) {
+        uint8_t  prefix = desc[i++];
+        size_t   bytes  = (prefix & 0x03) == 3 ? 4 : (prefix & 0x03);
+        uint32_t data   = 0;
+        for (size_t b = 0; b < bytes && i < len; ++b) {
+            data |= static_cast<uint32_t>(desc[i++]) << (8 * b);
+        }
+
+        switch (prefix & 0xFC) {
+            case 0x04: page = static_cast<uint16_t>(data); break;         // Usage Page
+            case 0x24: logical_max = data; break;                         // Logical Maximum
+            case 0x74: size = static_cast<uint16_t>(data); break;         // Report Size
+            case 0x84: id = static_cast<uint8_t>(data); break;            // Report ID
+            case 0x94: count = static_cast<uint16_t>(data); break;        // Report Count
+            case 0x08: usages.push_back(static_cast<uint16_t>(data)); break;  // Usage
+            case 0x80:                                                    // Input
+            case 0xB0: {                                                  // Feature
+                uint32_t &bit = (prefix & 0xFC) == 0x80 ? input_bit : feature_bit;
+                for (uint16_t f = 0; f < count; ++f) {
+                    bool     constant = data & 0x01;
+                    uint16_t usage    = 0;
+                    if (!constant && !usages.empty()) {
+                        usage = usages[f < usages.size() ? f : usages.size() - 1];
+                    }
+                    if (id == report_id) {
+                        fields.push_back({static_cast<uint8_t>(prefix & 0xFC), bit, size, page,
+                                          usage, logical_max});
+                    }
+                    bit += id == report_id ? size : 0;
+                }
+                usages.clear();
+                break;
+            }
+            case 0xA0:  // Collection
+            case 0xC0:  // End Collection
+                usages.clear();
+                break;
+            default:
+                break;
+        }
+    }
+    return fields;
+}
+
+const HidField *FindField(const std::vector<HidField> &fields, uint8_t main, uint16_t page,
+                          uint16_t usage, size_t nth)
+{
+    for (const HidField &field : fields) {
+        if (field.main == main && field.page == page && field.usage == usage && nth-- == 0) {
+            return &field;
+        }
+    }
+    return nullptr;
+}
+
+const idrive::DigitizerContact *ContactById(const idrive::DigitizerReport &report, uint8_t id)
+{
+    for (uint8_t i = 0; i < report.count; ++i) {
+        if (report.contacts[i].id == id) {
+            return &report.contacts[i];
+        }
+    }
+    return nullptr;
+}
+
+uint16_t ContactX(const idrive::DigitizerContact &c)
+{
+    return static_cast<uint16_t>(c.x[0] | (c.x[1] << 8));
+}
+
+uint16_t ContactY(const idrive::DigitizerContact &c)
+{
+    return static_cast<uint16_t>(c.y[0] | (c.y[1] << 8));
+}
+
+}  // namespace
+
+int RunDigitizer(const Args &args)
+{
+    using idrive::DigitizerContact;
+    using idrive::DigitizerEncoder;
+    using idrive::DigitizerReport;
+    using idrive::InputEvent;
+    using idrive::TouchOutput;
+    namespace protocol = idrive::protocol;
+
+    Checks check;
+
+    // Descriptor: the bytes the device enumerates with, parsed as a host
+    // would, must put every field where DigitizerReport has it.
+    static const uint8_t kDescriptor[] = {
+        IDRIVE_HID_REPORT_DESC_DIGITIZER(0x85, idrive::kReportIdDigitizer, ),
+    };
+    std::vector<HidField> fields =
+        ParseReportFields(kDescriptor, sizeof(kDescriptor), idrive::kReportIdDigitizer);
+
+    std::printf("Descriptor (%zu bytes), report %u fields:\n", sizeof(kDescriptor),
+                idrive::kReportIdDigitizer);
+    uint32_t input_bits = 0;
+    for (const HidField &f : fields) {
+        std::printf("  %-7s bit %3u size %2u page 0x%02X usage 0x%02X max %u\n",
+                    f.main == 0x80 ? "input" : "feature", f.bit, f.size, f.page, f.usage,
+                    f.logical_max);
+        if (f.main == 0x80) {
+            input_bits = f.bit + f.size;
+        }
+    }
+
+    std::printf("\nLayout:\n");
+    check("input report size matches sizeof(DigitizerReport)",
+          input_bits == sizeof(DigitizerReport) * 8);
+    bool layout = true;
+    for (size_t c = 0; c < idrive::kDigitizerContacts; ++c) {
+        size_t          base = offsetof(DigitizerReport, contacts) + c * sizeof(DigitizerContact);
+        const HidField *tip  = FindField(fields, 0x80, 0x0D, 0x42, c);
+        const HidField *id   = FindField(fields, 0x80, 0x0D, 0x51, c);
+        const HidField *x    = FindField(fields, 0x80, 0x01, 0x30, c);
+        const HidField *y    = FindField(fields, 0x80, 0x01, 0x31, c);
+        layout = layout && tip && tip->size == 1 &&
+                 tip->bit == (base + offsetof(DigitizerContact, tip)) * 8;
+        layout = layout && id && id->size == 8 &&
+                 id->bit == (base + offsetof(DigitizerContact, id)) * 8;
+        layout = layout && x && x->size == 16 && x->logical_max == idrive::kDigitizerLogicalMax &&
+                 x->bit == (base + offsetof(DigitizerContact, x)) * 8;
+        layout = layout && y && y->size == 16 && y->logical_max == idrive::kDigitizerLogicalMax &&
+                 y->bit == (base + offsetof(DigitizerContact, y)) * 8;
+    }
+    check("tip switch, contact ID, X, Y of each contact at their offsets", layout);
+    const HidField *count = FindField(fields, 0x80, 0x0D, 0x54, 0);
+    check("contact count at its offset",
+          count && count->size == 8 && count->bit == offsetof(DigitizerReport, count) * 8);
+    const HidField *max = FindField(fields, 0xB0, 0x0D, 0x55, 0);
+    check("contact count maximum feature, one byte", max && max->size == 8 && max->bit == 0);
+
+    // Encoder: scaling, contact identity across finger changes, lifts.
+    std::printf("\nEncoder:\n");
+    auto event = [](uint8_t state, int x, int y, int x2 = 0, int y2 = 0) {
+        InputEvent e;
+        e.type        = InputEvent::Type::Touchpad;
+        e.state       = state;
+        e.x           = static_cast<int16_t>(x);
+        e.y           = static_cast<int16_t>(y);
+        e.x2          = static_cast<int16_t>(x2);
+        e.y2          = static_cast<int16_t>(y2);
+        e.two_fingers = state == protocol::kTouchMulti;
+        return e;
+    };
+    check("corners scale to 0 and the logical maximum, Y flipped",
+          DigitizerEncoder::ScaleX(0) == 0 && DigitizerEncoder::ScaleX(511) == 4095 &&
+              DigitizerEncoder::ScaleY(511) == 0 && DigitizerEncoder::ScaleY(0) == 4095);
+
+    DigitizerEncoder encoder;
+    DigitizerReport  r;
+    bool             lifts = encoder.Encode(event(protocol::kTouchSingle, 100, 100), r);
+    uint8_t          a     = r.contacts[0].id;
+    check("touch down: one contact, tip on", !lifts && r.count == 1 && r.contacts[0].tip == 1);
+    encoder.Encode(event(protocol::kTouchSingle, 110, 105), r);
+    check("move: same contact ID", r.count == 1 && r.contacts[0].id == a);
+
+    // The second finger lands; the pad lists it first this time.
+    encoder.Encode(event(protocol::kTouchMulti, 400, 300, 112, 106), r);
+    const DigitizerContact *ca = ContactById(r, a);
+    uint8_t                 b  = r.contacts[0].id == a ? r.contacts[1].id : r.contacts[0].id;
+    check("second finger: new ID, first keeps its ID and position",
+          r.count == 2 && b != a && ca && ca->tip == 1 &&
+              ContactX(*ca) == DigitizerEncoder::ScaleX(112));
+
+    // The first finger lifts; the remaining one keeps its ID.
+    lifts = encoder.Encode(event(protocol::kTouchSingle, 402, 302), r);
+    ca    = ContactById(r, a);
+    const DigitizerContact *cb = ContactById(r, b);
+    check("one of two lifts: reported once with tip off",
+          lifts && r.count == 2 && ca && ca->tip == 0 && cb && cb->tip == 1 &&
+              ContactY(*cb) == DigitizerEncoder::ScaleY(302));
+    encoder.Encode(event(protocol::kTouchSingle, 404, 304), r);
+    check("remaining contact moves alone", r.count == 1 && r.contacts[0].id == b);
+
+    lifts = encoder.Encode(event(protocol::kTouchFingerRemoved, 0, 0), r);
+    check("lift: last contact tip off at its last position",
+          lifts && r.count == 1 && r.contacts[0].id == b && r.contacts[0].tip == 0 &&
+              ContactX(r.contacts[0]) == DigitizerEncoder::ScaleX(404));
+    encoder.Encode(event(protocol::kTouchFingerRemoved, 0, 0), r);
+    check("repeated lift: nothing to send", r.count == 0 && encoder.ActiveContacts() == 0);
+
+    // Through the pipeline: no gestures, one report per frame, and switching
+    // modes mid-touch lifts or ends what was in progress.
+    std::printf("\nPipeline:\n");
+    idrive::Config config = Simulator::DefaultConfig();
+    config.touch_output   = TouchOutput::Digitizer;
+    Simulator sim(config);
+    if (!sim.BringUp(args.detection_id)) {
+        std::fprintf(stderr, "controller did not become ready\n");
+        return 1;
+    }
+    sim.HidPort().ClearReports();
+
+    uint64_t t_us   = sim.NowUs() + 10000;
+    int      frames = 0;
+    auto     feed   = [&](uint8_t state, int x, int y, int x2 = 0, int y2 = 0) {
+        sim.Feed(TouchFrame(t_us, state, x, y, x2, y2));
+        t_us += 10000;
+        frames++;
+    };
+    for (int i = 0; i < 20; ++i) {
+        feed(protocol::kTouchSingle, 200 + i * 2, 250);
+    }
+    for (int i = 0; i < 30; ++i) {
+        feed(protocol::kTouchMulti, 240 - i * 3, 250, 300 + i * 3, 250);
+    }
+    feed(protocol::kTouchFingerRemoved, 0, 0);
+    sim.AdvanceTo(t_us + 100000);
+
+    int     touch = 0, other = 0;
+    uint8_t seen[256] = {};
+    int     ids       = 0;
+    bool    lifted    = false;
+    for (const HidReportRecord &rec : sim.HidPort().Reports()) {
+        if (rec.report_id != idrive::kReportIdDigitizer) {
+            other++;
+            continue;
+        }
+        touch++;
+        DigitizerReport report;
+        std::memcpy(&report, rec.data, sizeof(report));
+        lifted = report.count > 0;
+        for (uint8_t i = 0; i < report.count; ++i) {
+            ids += seen[report.contacts[i].id]++ == 0 ? 1 : 0;
+            lifted = lifted && report.contacts[i].tip == 0;
+        }
+    }
+    std::printf("  %d frames -> %d touch reports, %d other reports\n", frames, touch, other);
+    check("touch reports only, about one per frame",
+          other == 0 && touch >= frames - 2 && touch <= frames);
+    check("two contact IDs, all lifted at the end", ids == 2 && lifted);
+
+    // Digitizer -> mouse while a finger is down, then back.
+    sim.HidPort().ClearReports();
+    feed(protocol::kTouchSingle, 100, 100);
+    sim.Controller().SetTouchOutput(TouchOutput::Mouse);
+    for (int i = 1; i <= 20; ++i) {
+        feed(protocol::kTouchSingle, 100 + i * 8, 100);
+    }
+    sim.Controller().SetTouchOutput(TouchOutput::Digitizer);
+    for (int i = 1; i <= 5; ++i) {
+        feed(protocol::kTouchSingle, 260 - i * 8, 100);
+    }
+    feed(protocol::kTouchFingerRemoved, 0, 0);
+    sim.AdvanceTo(t_us + 500000);
+
+    int  moves = 0, touch_after = 0;
+    bool lift_first = false, mouse_seen = false;
+    for (const HidReportRecord &rec : sim.HidPort().Reports()) {
+        if (rec.report_id == idrive::kReportIdMouse) {
+            moves += MouseOf(rec).x != 0 ? 1 : 0;
+            mouse_seen = true;
+        } else if (rec.report_id == idrive::kReportIdDigitizer) {
+            DigitizerReport report;
+            std::memcpy(&report, rec.data, sizeof(report));
+            if (!mouse_seen && report.count == 1 && report.contacts[0].tip == 0) {
+                lift_first = true;
+            }
+            touch_after += mouse_seen ? 1 : 0;
+        }
+    }
+    check("switch to mouse lifts the touch, then the pointer moves", lift_first && moves > 0);
+    check("switch back sends touches again", touch_after > 0);
+    check("output reads back as selected",
+          sim.Controller().GetTouchOutput() == TouchOutput::Digitizer);
+
+    return check.Finish();
+}
+
+// =============================================================================
+// Mouse Motion
+// =============================================================================
+
+namespace {
+
+// Motion as the host sums it from the reports of one protocol.
+struct MotionTotals {
+    int64_t  x        = 0;
+    int64_t  y        = 0;
+    int64_t  wheel    = 0;
+    int64_t  pan      = 0;
+    int      reports  = 0;
+    int      largest  = 0;  // Largest |x| or |y| in one report
+    int      foreign  = 0;  // Reports not in the protocol's mouse layout
+    uint64_t last_us  = 0;  // Poll that picked up the last motion
+};
+
+MotionTotals SumMotion(const std::vector<HidReportRecord> &reports, idrive::HidProtocol protocol)
+{
+    MotionTotals totals;
+    for (const HidReportRecord &r : reports) {
+        int x = 0, y = 0;
+        if (protocol == idrive::HidProtocol::Boot && r.report_id == 0 &&
+            r.len == sizeof(idrive::BootMouseReport)) {
+            idrive::BootMouseReport boot;
+            std::memcpy(&boot, r.data, sizeof(boot));
+            x = boot.x;
+            y = boot.y;
+            totals.wheel += boot.wheel;
+        } else if (protocol == idrive::HidProtocol::Report &&
+                   r.report_id == idrive::kReportIdMouse) {
+            idrive::MouseReport mouse = MouseOf(r);
+            x                         = mouse.x;
+            y                         = mouse.y;
+            totals.wheel += mouse.wheel;
+            totals.pan += mouse.pan;
+        } else {
+            totals.foreign++;
+            continue;
+        }
+        totals.x += x;
+        totals.y += y;
+        totals.reports++;
+        totals.largest = std::max(totals.largest, std::max(std::abs(x), std::abs(y)));
+        totals.last_us = r.time_us;
+    }
+    return totals;
+}
+
+}  // namespace
+
+int RunMouse(const Args &args)
+{
+    using idrive::HidProtocol;
+    using idrive::MouseReport;
+    namespace protocol = idrive::protocol;
+
+    Checks check;
+
+    // Descriptor: parsed as a host would, the input fields must sit where
+    // MouseReport has them and the two multipliers fill one feature byte.
+    static const uint8_t kDescriptor[] = {
+        IDRIVE_HID_REPORT_DESC_MOUSE(0x85, idrive::kReportIdMouse, ),
+    };
+    std::vector<HidField> fields =
+        ParseReportFields(kDescriptor, sizeof(kDescriptor), idrive::kReportIdMouse);
+    uint32_t input_bits = 0, feature_bits = 0;
+    for (const HidField &f : fields) {
+        (f.main == 0x80 ? input_bits : feature_bits) = f.bit + f.size;
+    }
+    auto at = [&](uint8_t main, uint16_t page, uint16_t usage, size_t nth, size_t bit,
+                  uint32_t size) {
+        const HidField *field = FindField(fields, main, page, usage, nth);
+        return field && field->bit == bit && field->size == size;
+    };
+    std::printf("Descriptor (%zu bytes):\n", sizeof(kDescriptor));
+    check("X, Y, wheel and pan at their MouseReport offsets",
+          at(0x80, 0x01, 0x30, 0, offsetof(MouseReport, x) * 8, 16) &&
+              at(0x80, 0x01, 0x31, 0, offsetof(MouseReport, y) * 8, 16) &&
+              at(0x80, 0x01, 0x38, 0, offsetof(MouseReport, wheel) * 8, 16) &&
+              at(0x80, 0x0C, 0x238, 0, offsetof(MouseReport, pan) * 8, 16) &&
+              input_bits == sizeof(MouseReport) * 8);
+    check("wheel and pan resolution multipliers in one feature byte",
+          at(0xB0, 0x01, 0x48, 0, 0, 2) && at(0xB0, 0x01, 0x48, 1, 2, 2) &&
+              (kHiResMultiplier & idrive::kMultiplierWheelMask) == 0x01 &&
+              (kHiResMultiplier & idrive::kMultiplierPanMask) == 0x04 && feature_bits == 8);
+    std::printf("\n");
+
+    // Deltas queued between two host polls, from a nudge to a flick across a
+    // 4K screen with acceleration.
+    struct Burst {
+        int16_t x, y, wheel, pan;
+    };
+    static const Burst kBursts[] = {
+        {3, -2, 0, 0},         {150, 90, 0, 0},    {-700, 1200, 0, 0}, {4000, -3900, 0, 0},
+        {32767, -32767, 0, 0}, {0, 0, 300, 0},     {0, 0, -5, 0},      {0, 0, 0, -1000},
+    };
+
+    for (HidProtocol mode : {HidProtocol::Report, HidProtocol::Boot}) {
+        bool boot = mode == HidProtocol::Boot;
+        std::printf("%s protocol:\n", boot ? "Boot" : "Report");
+
+        Simulator sim;
+        if (!sim.BringUp(args.detection_id)) {
+            std::fprintf(stderr, "controller did not become ready\n");
+            return 1;
+        }
+        sim.Hid().OnProtocolChange(mode);
+        sim.HidPort().ClearReports();
+
+        MotionTotals sent;
+        int          expected_reports = 0;
+        for (const Burst &b : kBursts) {
+            sim.Hid().MouseMove(b.x, b.y);
+            sim.Hid().MouseScroll(b.wheel);
+            sim.Hid().MousePan(b.pan);
+            sent.x += b.x;
+            sent.y += b.y;
+            sent.wheel += b.wheel;
+            sent.pan += boot ? 0 : b.pan;
+
+            // One report per burst, or one per +/-127 of the largest axis.
+            int axis = std::max(std::max(std::abs(b.x), std::abs(b.y)), std::abs(b.wheel));
+            if (!boot) {
+                expected_reports += 1;
+            } else if (axis > 0) {
+                expected_reports += (axis + idrive::kBootMouseReportMax - 1) /
+                                    idrive::kBootMouseReportMax;
+            }
+            sim.AdvanceTo(sim.NowUs() + 3000000);  // Drain before the next burst
+        }
+
+        MotionTotals got = SumMotion(sim.HidPort().Reports(), mode);
+        std::printf("  sent x %lld y %lld wheel %lld pan %lld\n", static_cast<long long>(sent.x),
+                    static_cast<long long>(sent.y), static_cast<long long>(sent.wheel),
+                    static_cast<long long>(sent.pan));
+        std::printf("  got  x %lld y %lld wheel %lld pan %lld in %d reports (largest %d)\n",
+                    static_cast<long long>(got.x), static_cast<long long>(got.y),
+                    static_cast<long long>(got.wheel), static_cast<long long>(got.pan),
+                    got.reports, got.largest);
+        check("every delta arrives",
+              got.x == sent.x && got.y == sent.y && got.wheel == sent.wheel && got.pan == sent.pan);
+        check(boot ? "split into +/-127 boot reports" : "one report per burst",
+              got.reports == expected_reports && got.foreign == 0);
+        check("nothing clipped", sim.Hid().GetReportStats().saturated == 0);
+    }
+
+    // A fast swipe through the pipeline: the same motion in both protocols,
+    // in fewer reports and sooner in report protocol.
+    std::printf("\nFast swipe:\n");
+    MotionTotals swipe[2];
+    uint64_t     last_frame_us = 0;
+    for (HidProtocol mode : {HidProtocol::Report, HidProtocol::Boot}) {
+        size_t    i = mode == HidProtocol::Boot ? 1 : 0;
+        Simulator sim;
+        if (!sim.BringUp(args.detection_id)) {
+            std::fprintf(stderr, "controller did not become ready\n");
+            return 1;
+        }
+        sim.Hid().OnProtocolChange(mode);
+        sim.HidPort().ClearReports();
+
+        uint64_t t_us = sim.NowUs() + 10000;
+        for (int f = 0; f <= 5; ++f) {
+            last_frame_us = t_us;
+            sim.Feed(TouchFrame(t_us, protocol::kTouchSingle, 20 + f * 90, 60 + f * 75));
+            t_us += 10000;
+        }
+        sim.Feed(TouchFrame(t_us, protocol::kTouchFingerRemoved, 0, 0));
+        sim.AdvanceTo(t_us + 3000000);
+        swipe[i] = SumMotion(sim.HidPort().Reports(), mode);
+        std::printf("  %-6s x %lld y %lld in %d reports (largest %d), last %lld ms after the "
+                    "last move\n",
+                    i ? "boot" : "report", static_cast<long long>(swipe[i].x),
+                    static_cast<long long>(swipe[i].y), swipe[i].reports, swipe[i].largest,
+                    (static_cast<long long>(swipe[i].last_us) -
+                     static_cast<long long>(last_frame_us)) /
+                        1000);
+    }
+    check("same displacement in both protocols",
+          swipe[0].x == swipe[1].x && swipe[0].y == swipe[1].y && swipe[0].x != 0);
+    check("report protocol sends deltas beyond +/-127 whole",
+          swipe[0].largest > idrive::kBootMouseReportMax && swipe[0].reports < swipe[1].reports);
+
+    // A slow two-finger scroll and pan, to a host that reads detents and to
+    // one that set the resolution multiplier: the same distance, in many
+    // small steps instead of a few whole detents.
+    std::printf("\nSlow two-finger scroll and pan:\n");
+    const int32_t kUnit = idrive::kWheelUnitsPerDetent;
+    MotionTotals  slow[2][2];  // [pan][high-res]
+    int           steps[2][2] = {};
+    for (int pan = 0; pan < 2; ++pan) {
+        for (uint8_t multiplier : {uint8_t(0), kHiResMultiplier}) {
+            size_t    hi = multiplier ? 1 : 0;
+            Simulator sim;
+            if (!sim.BringUp(args.detection_id)) {
+                std::fprintf(stderr, "controller did not become ready\n");
+                return 1;
+            }
+            sim.Hid().OnSetResolutionMultiplier(multiplier);
+            sim.HidPort().ClearReports();
+
+            // 120 raw units over 2 s, then a rest so no fling follows.
+            uint64_t t_us = sim.NowUs() + 10000;
+            for (int i = 0; i <= 440; ++i, t_us += 5000) {
+                int d = std::min(i, 400) * 120 / 400;
+                sim.Feed(pan ? TouchFrame(t_us, protocol::kTouchMulti, 150 + d, 200, 150 + d, 300)
+                             : TouchFrame(t_us, protocol::kTouchMulti, 200, 150 + d, 300, 150 + d));
+            }
+            sim.Feed(TouchFrame(t_us, protocol::kTouchFingerRemoved, 0, 0));
+            sim.AdvanceTo(t_us + 500000);
+
+            slow[pan][hi] = SumMotion(sim.HidPort().Reports(), HidProtocol::Report);
+            for (const HidReportRecord &r : sim.HidPort().Reports()) {
+                MouseReport m = MouseOf(r);
+                steps[pan][hi] += r.report_id == idrive::kReportIdMouse && (pan ? m.pan : m.wheel);
+            }
+            int64_t total = pan ? slow[pan][hi].pan : slow[pan][hi].wheel;
+            std::printf("  %-6s %-8s %7.2f detents in %3d steps\n", pan ? "pan" : "scroll",
+                        hi ? "high-res" : "detents", static_cast<double>(total) / (hi ? kUnit : 1),
+                        steps[pan][hi]);
+        }
+        int64_t lo = pan ? slow[pan][0].pan : slow[pan][0].wheel;
+        int64_t hi = pan ? slow[pan][1].pan : slow[pan][1].wheel;
+        check(pan ? "pan: same distance, whole detents without multiplier"
+                  : "scroll: same distance, whole detents without multiplier",
+              lo != 0 && lo == hi / kUnit);
+        check(pan ? "pan: several times as many steps with it"
+                  : "scroll: several times as many steps with it",
+              steps[pan][1] >= 4 * steps[pan][0]);
+    }
+
+    // A two-finger flick lifted while moving: the fling that follows goes out
+    // in wheel units too, so it covers the same distance in finer steps.
+    std::printf("\nTwo-finger flick:\n");
+    int64_t fling[2]       = {};
+    int     fling_steps[2] = {};
+    int     fractional     = 0;  // High-res fling steps that are not whole detents
+    for (uint8_t multiplier : {uint8_t(0), kHiResMultiplier}) {
+        size_t    hi = multiplier ? 1 : 0;
+        Simulator sim;
+        if (!sim.BringUp(args.detection_id)) {
+            std::fprintf(stderr, "controller did not become ready\n");
+            return 1;
+        }
+        sim.Hid().OnSetResolutionMultiplier(multiplier);
+
+        uint64_t t_us = sim.NowUs() + 10000;
+        for (int i = 0; i <= 20; ++i, t_us += 5000) {
+            sim.Feed(TouchFrame(t_us, protocol::kTouchMulti, 200, 100 + i * 12, 300, 100 + i * 12));
+        }
+        sim.Feed(TouchFrame(t_us, protocol::kTouchFingerRemoved, 0, 0));
+        sim.AdvanceTo(t_us + 20000);
+        sim.HidPort().ClearReports();
+        sim.AdvanceTo(t_us + 3000000);
+
+        for (const HidReportRecord &r : sim.HidPort().Reports()) {
+            MouseReport m = MouseOf(r);
+            if (r.report_id != idrive::kReportIdMouse || m.wheel == 0) {
+                continue;
+            }
+            fling[hi] += m.wheel;
+            fling_steps[hi]++;
+            fractional += hi && m.wheel % kUnit != 0;
+        }
+        std::printf("  %-8s %7.2f detents in %3d steps\n", hi ? "high-res" : "detents",
+                    static_cast<double>(fling[hi]) / (hi ? kUnit : 1), fling_steps[hi]);
+    }
+    check("fling: same distance to within a detent",
+          fling[0] != 0 && std::abs(fling[0] - fling[1] / kUnit) <= 1);
+    check("fling: fractions of a detent with the multiplier",
+          fractional > 0 && fling_steps[1] > fling_steps[0]);
+
+    return check.Finish();
+}
+
+// =============================================================================
+// Tap Releases
+// =============================================================================
+
+namespace {
+
+// A UsbHidDevice on a SimHidPort, with the release timer and the host polls
+// driven by hand on the virtual clock.
+struct TapRig {
+    idrive::sim::SimHidPort port;
+    idrive::UsbHidDevice    hid;
+    uint64_t                now_us    = 1000000;
+    uint64_t                next_poll = 1000000;
+    uint32_t                wake_late = 0;  // Added to each release timer wakeup
+    std::vector<uint64_t>   serviced;       // ServiceReleases() calls
+
+    TapRig()
+    {
+        hid.Attach(port);
+        port.SetMounted(true);
+        hid.OnMount();
+        idrive::sim::SetTimeUs(now_us);
+    }
+
+    void AdvanceTo(uint64_t t_us)
+    {
+        while (now_us < t_us) {
+            uint64_t wake = port.WakeupUs();
+            if (wake != idrive::sim::SimHidPort::kNoWakeup) {
+                wake += wake_late;
+            }
+            now_us = std::min({t_us, wake, next_poll});
+            idrive::sim::SetTimeUs(now_us);
+            if (wake <= now_us) {
+                port.ClearWakeup();
+                serviced.push_back(now_us);
+                hid.ServiceReleases(now_us);
+            }
+            if (next_poll <= now_us) {
+                if (port.Poll(now_us)) {
+                    hid.OnReportComplete();
+                }
+                next_poll += idrive::config::kHidPollIntervalMs * 1000;
+            }
+        }
+    }
+};
+
+// Down/up edges of one input as the host saw them: (down, poll time).
+std::vector<std::pair<bool, uint64_t>> TapEdges(const std::vector<HidReportRecord> &reports,
+                                                idrive::TimedRelease::Kind kind, uint16_t code)
+{
+    using Kind = idrive::TimedRelease::Kind;
+    std::vector<std::pair<bool, uint64_t>> edges;
+    bool                                   down = false;
+    for (const HidReportRecord &r : reports) {
+        bool now = down;
+        if (kind == Kind::Key && r.report_id == idrive::kReportIdKeyboard) {
+            now = std::memchr(r.data + 2, code, 6) != nullptr;
+        } else if (kind == Kind::MouseButton && r.report_id == idrive::kReportIdMouse) {
+            now = (MouseOf(r).buttons & code) != 0;
+        } else if (kind == Kind::MediaKey && r.report_id == idrive::kReportIdConsumer) {
+            now = static_cast<uint16_t>(r.data[0] | (r.data[1] << 8)) == code;
+        }
+        if (now != down) {
+            edges.emplace_back(now, r.time_us);
+            down = now;
+        }
+    }
+    return edges;
+}
+
+}  // namespace
+
+int RunTaps(const Args &)
+{
+    using Kind = idrive::TimedRelease::Kind;
+    namespace key = idrive::hid::key;
+
+    Checks check;
+
+    const uint64_t kHoldUs = idrive::config::kTapHoldMs * 1000ULL;
+    const uint64_t kPollUs = idrive::config::kHidPollIntervalMs * 1000ULL;
+
+    // A key, a click and a media key tapped at once: the calls return at
+    // once, each press reaches the host, and the release timer fires exactly
+    // kTapHoldMs later for all three.
+    std::printf("Tap (hold %lu ms):\n", static_cast<unsigned long>(idrive::config::kTapHoldMs));
+    {
+        TapRig   rig;
+        uint64_t t0 = rig.now_us + 3000;
+        rig.AdvanceTo(t0);
+        auto wall = std::chrono::steady_clock::now();
+        rig.hid.KeyPressAndRelease(key::kEnter);
+        rig.hid.MouseClick(idrive::hid::mouse::kButtonLeft);
+        rig.hid.MediaKeyPressAndRelease(idrive::hid::media::kPlayPause);
+        double call_ms =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wall)
+                .count();
+        idrive::TimedReleaseStats queued = rig.hid.GetReleaseStats();
+        rig.AdvanceTo(t0 + 200000);
+
+        const struct {
+            Kind     kind;
+            uint16_t code;
+        } kTaps[] = {{Kind::Key, key::kEnter},
+                     {Kind::MouseButton, idrive::hid::mouse::kButtonLeft},
+                     {Kind::MediaKey, idrive::hid::media::kPlayPause}};
+        // One report per host poll: the three releases take three polls.
+        bool tapped = true;
+        for (const auto &tap : kTaps) {
+            auto edges = TapEdges(rig.port.Reports(), tap.kind, tap.code);
+            tapped     = tapped && edges.size() == 2 && edges[0].first && !edges[1].first &&
+                     edges[1].second >= t0 + kHoldUs &&
+                     edges[1].second <= t0 + kHoldUs + 3 * kPollUs;
+        }
+        idrive::TimedReleaseStats stats = rig.hid.GetReleaseStats();
+        std::printf("  calls took %.3f ms wall, timer serviced %zu time(s), %lld us after the "
+                    "taps\n",
+                    call_ms, rig.serviced.size(),
+                    rig.serviced.empty() ? -1LL : static_cast<long long>(rig.serviced[0] - t0));
+        check("taps return without waiting, releases queued",
+              call_ms < 5.0 && rig.now_us == t0 + 200000 && queued.scheduled == 3 &&
+                  queued.fired == 0);
+        check("one timer wakeup, exactly kTapHoldMs after the taps",
+              rig.serviced.size() == 1 && rig.serviced[0] == t0 + kHoldUs);
+        check("host sees each press, then its release", tapped);
+        check("stats: 3 scheduled and fired, none late",
+              stats.scheduled == 3 && stats.fired == 3 && stats.late == 0 &&
+                  stats.max_late_us == 0 && stats.preempted == 0 && stats.overflows == 0);
+    }
+
+    // The same key tapped again while its release is pending: released at
+    // once and pressed again, so the host sees two taps, not one long press.
+    std::printf("\nTap again within the hold:\n");
+    {
+        TapRig   rig;
+        uint64_t t0 = rig.now_us + 3000;
+        rig.AdvanceTo(t0);
+        rig.hid.KeyPressAndRelease(key::kDown);
+        rig.AdvanceTo(t0 + 20000);
+        rig.hid.KeyPressAndRelease(key::kDown);
+        rig.AdvanceTo(t0 + 300000);
+
+        auto                      edges = TapEdges(rig.port.Reports(), Kind::Key, key::kDown);
+        idrive::TimedReleaseStats stats = rig.hid.GetReleaseStats();
+        std::printf("  %zu edges, timer serviced at +%lld us\n", edges.size(),
+                    rig.serviced.empty() ? -1LL : static_cast<long long>(rig.serviced.back() - t0));
+        check("host sees down, up, down, up",
+              edges.size() == 4 && edges[0].first && !edges[1].first && edges[2].first &&
+                  !edges[3].first);
+        // The timer armed by the first tap still wakes, finds nothing due and
+        // re-arms for the second.
+        check("second release kTapHoldMs after the second tap",
+              rig.serviced.size() == 2 && rig.serviced[1] == t0 + 20000 + kHoldUs &&
+                  edges[3].second >= t0 + 20000 + kHoldUs);
+        check("stats: 2 scheduled, 1 preempted, 1 fired",
+              stats.scheduled == 2 && stats.preempted == 1 && stats.fired == 1);
+    }
+
+    // More taps at once than the queue holds: the extra ones release at once
+    // instead of blocking, and every key ends up released.
+    std::printf("\nQueue overflow:\n");
+    {
+        const size_t kTaps = idrive::TimedReleaseQueue::kCapacity + 2;
+        TapRig       rig;
+        uint64_t     t0 = rig.now_us + 3000;
+        rig.AdvanceTo(t0);
+        for (size_t i = 0; i < kTaps; ++i) {
+            rig.hid.KeyPressAndRelease(static_cast<uint8_t>(key::kA + i));
+        }
+        idrive::TimedReleaseStats queued = rig.hid.GetReleaseStats();
+        rig.AdvanceTo(t0 + 500000);
+
+        idrive::TimedReleaseStats stats = rig.hid.GetReleaseStats();
+        const HidReportRecord    *last  = nullptr;
+        for (const HidReportRecord &r : rig.port.Reports()) {
+            last = r.report_id == idrive::kReportIdKeyboard ? &r : last;
+        }
+        bool all_up = last != nullptr;
+        for (int i = 2; all_up && i < 8; ++i) {
+            all_up = last->data[i] == 0;
+        }
+        std::printf("  %zu taps: %lu queued, %lu released at once\n", kTaps,
+                    static_cast<unsigned long>(queued.scheduled),
+                    static_cast<unsigned long>(queued.overflows));
+        check("overflowing taps release at once",
+              queued.scheduled == idrive::TimedReleaseQueue::kCapacity && queued.overflows == 2 &&
+                  queued.fired == 0);
+        check("queued ones fire together after kTapHoldMs",
+              stats.fired == idrive::TimedReleaseQueue::kCapacity && rig.serviced.size() == 1 &&
+                  rig.serviced[0] == t0 + kHoldUs);
+        check("every key ends up released", all_up);
+    }
+
+    // The release timer woken 5 ms late (a busy core): the release still
+    // goes out, and the lateness is counted against kReleaseLateThreshUs.
+    std::printf("\nLate timer:\n");
+    {
+        TapRig   rig;
+        uint64_t t0   = rig.now_us + 3000;
+        rig.wake_late = 5000;
+        rig.AdvanceTo(t0);
+        rig.hid.MouseClick(idrive::hid::mouse::kButtonRight);
+        rig.AdvanceTo(t0 + 200000);
+
+        auto edges =
+            TapEdges(rig.port.Reports(), Kind::MouseButton, idrive::hid::mouse::kButtonRight);
+        idrive::TimedReleaseStats stats = rig.hid.GetReleaseStats();
+        std::printf("  fired %lu, late %lu, worst %lu us\n",
+                    static_cast<unsigned long>(stats.fired), static_cast<unsigned long>(stats.late),
+                    static_cast<unsigned long>(stats.max_late_us));
+        check("released once the timer runs",
+              edges.size() == 2 && !edges[1].first && edges[1].second >= t0 + kHoldUs + 5000);
+        check("stats: late by 5 ms, over the threshold",
+              stats.fired == 1 && stats.late == 1 && stats.max_late_us == 5000);
+    }
+
+    return check.Finish();
+}
+
+}  // namespace idrive::sim
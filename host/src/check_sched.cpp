@@ -0,0 +1,176 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+//
+// idrive_sim checks of the periodic scheduler.
+
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+#include "sched/periodic_scheduler.h"
+#include "sim/harness.h"
+
+namespace idrive::sim {
+
+// =============================================================================
+// Periodic Scheduler
+// =============================================================================
+
+int RunSched(const Args &)
+{
+    using idrive::PeriodicScheduler;
+    using idrive::PeriodicStats;
+
+    Checks check;
+
+    const uint64_t kStart = 1000;
+    const uint32_t kFast  = 10000;  // The poll job's period
+    const uint32_t kSlow  = 25000;
+
+    // On time: a wake at every deadline runs exactly the jobs due, at their
+    // deadlines, in registration order.
+    std::printf("On time:\n");
+    {
+        PeriodicScheduler     sched;
+        std::vector<uint64_t> fast_runs, slow_runs;
+        std::vector<std::pair<uint64_t, char>> order;  // (time, job) per run
+        uint64_t              now_us = kStart;
+        auto fast = sched.Add(
+            "fast", kFast,
+            [&] {
+                fast_runs.push_back(now_us);
+                order.emplace_back(now_us, 'f');
+            },
+            now_us);
+        auto slow = sched.Add(
+            "slow", kSlow,
+            [&] {
+                slow_runs.push_back(now_us);
+                order.emplace_back(now_us, 's');
+            },
+            now_us);
+        uint64_t next = sched.NextDeadline();
+        while (next <= kStart + 1000000) {
+            now_us = next;
+            next   = sched.RunDue(now_us);
+        }
+
+        bool on_deadline = fast_runs.size() == 100 && slow_runs.size() == 40;
+        for (size_t i = 0; on_deadline && i < fast_runs.size(); ++i) {
+            on_deadline = fast_runs[i] == kStart + (i + 1) * kFast;
+        }
+        for (size_t i = 0; on_deadline && i < slow_runs.size(); ++i) {
+            on_deadline = slow_runs[i] == kStart + (i + 1) * kSlow;
+        }
+        // Every 50 ms both are due: the fast job, registered first, runs first.
+        size_t both = 0;
+        for (size_t i = 0; i + 1 < order.size(); ++i) {
+            both += order[i].first == order[i + 1].first;
+        }
+
+        const PeriodicStats *f = sched.GetStats(fast);
+        const PeriodicStats *s = sched.GetStats(slow);
+        std::printf("  fast %lu runs, mean period %lu us; slow %lu runs, mean period %lu us\n",
+                    static_cast<unsigned long>(f->runs),
+                    static_cast<unsigned long>(f->MeanPeriodUs()),
+                    static_cast<unsigned long>(s->runs),
+                    static_cast<unsigned long>(s->MeanPeriodUs()));
+        check("every run at its deadline", on_deadline);
+        check("jobs due together run in registration order",
+              both == 20 && std::is_sorted(order.begin(), order.end()));
+        check("stats: runs, periods exact, no jitter or misses",
+              f->runs == 100 && f->min_period_us == kFast && f->max_period_us == kFast &&
+                  f->MeanPeriodUs() == kFast && f->max_jitter_us == 0 && f->missed == 0 &&
+                  s->runs == 40 && s->MeanPeriodUs() == kSlow && s->max_jitter_us == 0);
+    }
+
+    // Woken a little late every time: the lateness shows as jitter but does
+    // not add up, since deadlines advance by whole periods.
+    std::printf("\nLate by 300 us on every wake:\n");
+    {
+        PeriodicScheduler sched;
+        uint64_t          now_us = kStart;
+        uint64_t          last   = 0;
+        auto              id     = sched.Add("fast", kFast, [&] { last = now_us; }, now_us);
+        for (int i = 0; i < 100; ++i) {
+            now_us = sched.NextDeadline() + 300;
+            sched.RunDue(now_us);
+        }
+        const PeriodicStats *f = sched.GetStats(id);
+        std::printf("  last run %llu us, mean jitter %lu us, mean period %lu us\n",
+                    static_cast<unsigned long long>(last),
+                    static_cast<unsigned long>(f->MeanJitterUs()),
+                    static_cast<unsigned long>(f->MeanPeriodUs()));
+        check("phase-locked: run 100 is 300 us after its deadline",
+              last == kStart + 100 * kFast + 300 && sched.NextDeadline() == kStart + 101 * kFast);
+        check("stats: jitter 300 us, period exact, no misses",
+              f->runs == 100 && f->last_jitter_us == 300 && f->max_jitter_us == 300 &&
+                  f->MeanJitterUs() == 300 && f->MeanPeriodUs() == kFast && f->missed == 0);
+    }
+
+    // One wake 3.5 periods late (a stalled task): the job runs once, the
+    // periods it slept through count as missed, and it keeps its phase.
+    std::printf("\nLate wake, 3.5 periods:\n");
+    {
+        PeriodicScheduler sched;
+        uint64_t          now_us = kStart;
+        int               runs   = 0;
+        auto              id     = sched.Add("fast", kFast, [&] { runs++; }, now_us);
+        for (int i = 0; i < 10; ++i) {
+            now_us = sched.NextDeadline();
+            sched.RunDue(now_us);
+        }
+        now_us = sched.NextDeadline() + kFast * 7 / 2;
+
+        uint64_t             next = sched.RunDue(now_us);
+        const PeriodicStats *f    = sched.GetStats(id);
+        std::printf("  %d runs, %lu missed, jitter %lu us, longest period %lu us, next +%llu us\n",
+                    runs, static_cast<unsigned long>(f->missed),
+                    static_cast<unsigned long>(f->last_jitter_us),
+                    static_cast<unsigned long>(f->max_period_us),
+                    static_cast<unsigned long long>(next - now_us));
+        check("runs once, no burst of catch-up runs", runs == 11);
+        check("3 missed, jitter and longest period recorded",
+              f->missed == 3 && f->last_jitter_us == kFast * 7 / 2 &&
+                  f->max_period_us == kFast * 9 / 2);
+        check("next deadline back on the original phase", next == kStart + 15 * kFast);
+
+        // The next on-time run measures a short period, still on phase.
+        now_us = next;
+        sched.RunDue(now_us);
+        check("next run on time, short period recorded",
+              runs == 12 && f->last_jitter_us == 0 && f->min_period_us == kFast / 2);
+
+        sched.ResetStats();
+        check("ResetStats clears the stats",
+              f->runs == 0 && f->missed == 0 && f->max_jitter_us == 0);
+    }
+
+    // Period changes re-phase from the change; bad jobs are refused.
+    std::printf("\nSetPeriod and limits:\n");
+    {
+        PeriodicScheduler sched;
+        auto              id = sched.Add("job", kFast, [] {}, kStart);
+        sched.SetPeriod(id, kSlow, kStart + 4000);
+        check("SetPeriod re-phases from now",
+              sched.GetPeriod(id) == kSlow && sched.NextDeadline() == kStart + 4000 + kSlow);
+        check("period 0 and empty callbacks refused",
+              sched.Add("zero", 0, [] {}, kStart) == PeriodicScheduler::kInvalidJob &&
+                  sched.Add("empty", kFast, nullptr, kStart) == PeriodicScheduler::kInvalidJob);
+        while (sched.JobCount() < PeriodicScheduler::kMaxJobs) {
+            sched.Add("fill", kFast, [] {}, kStart);
+        }
+        check("jobs beyond kMaxJobs refused",
+              sched.Add("extra", kFast, [] {}, kStart) == PeriodicScheduler::kInvalidJob &&
+                  sched.GetStats(PeriodicScheduler::kMaxJobs) == nullptr);
+        check("no jobs: next deadline is never",
+              PeriodicScheduler().RunDue(kStart) == PeriodicScheduler::kNever);
+    }
+
+    return check.Finish();
+}
+
+}  // namespace idrive::sim
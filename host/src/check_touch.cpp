@@ -0,0 +1,1005 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+//
+// idrive_sim checks of the touchpad pipeline: pointer acceleration, the touch
+// filter, swipes, pinch/scroll/pan arbitration and tap resolution.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "hid/hid_keycodes.h"
+#include "hid/hid_mouse.h"
+#include "hid/usb_hid_device.h"
+#include "input/one_euro_filter.h"
+#include "input/pointer_accel.h"
+#include "input/swipe_recognizer.h"
+#include "input/touch_filter.h"
+#include "input/touchpad_handler.h"
+#include "sim/can_log.h"
+#include "sim/harness.h"
+#include "sim/sim_clock.h"
+#include "sim/sim_ports.h"
+#include "sim/simulator.h"
+
+namespace idrive::sim {
+
+// =============================================================================
+// Pointer Acceleration
+// =============================================================================
+
+int RunAccel(const Args &args)
+{
+    using idrive::PointerAccel;
+    using idrive::PointerAccelProfile;
+
+    uint64_t samples = args.operand ? std::strtoull(args.operand, nullptr, 10) : 10000000;
+
+    const struct {
+        PointerAccelProfile profile;
+        const char         *name;
+    } kProfiles[] = {
+        {PointerAccelProfile::Linear, "linear"},
+        {PointerAccelProfile::MacOs, "macos"},
+        {PointerAccelProfile::Windows, "windows"},
+    };
+
+    // Gain curves at a few finger speeds.
+    std::printf("%-8s", "units/ms");
+    for (const auto &p : kProfiles) {
+        std::printf(" %8s", p.name);
+    }
+    std::printf("\n");
+    for (uint32_t quarter : {0u, 1u, 2u, 4u, 6u, 8u, 12u, 16u, 24u, 32u, 40u}) {
+        std::printf("%-8.2f", quarter / 4.0);
+        for (const auto &p : kProfiles) {
+            PointerAccel accel(p.profile);
+            std::printf(" %8.2f", accel.GainAt(quarter << PointerAccel::kStepShift) / 256.0);
+        }
+        std::printf("\n");
+    }
+
+    // Per-sample cost against the 5 ms (200 Hz) touch budget. Inputs vary so
+    // the lookup cannot be hoisted out of the loop.
+    std::printf("\n");
+    for (const auto &p : kProfiles) {
+        PointerAccel accel(p.profile);
+        uint32_t     state = 12345;
+        int64_t      sink  = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < samples; ++i) {
+            state = state * 1664525u + 1013904223u;
+
+            int32_t  dx = static_cast<int32_t>(state >> 24) - 128;
+            int32_t  dy = static_cast<int32_t>((state >> 16) & 0xFF) - 128;
+            uint32_t dt = 2000 + (state & 0x3FFF);
+            sink += dx * 5 * accel.Gain(dx, dy, dt) / (10 * PointerAccel::kGainOne);
+        }
+        double ns = std::chrono::duration<double, std::nano>(
+                        std::chrono::steady_clock::now() - start)
+                        .count() /
+                    samples;
+
+        std::printf("%-8s %.1f ns/sample (%.5f%% of a 5 ms sample period)  [%lld]\n", p.name, ns,
+                    ns / 5e6 * 100.0, static_cast<long long>(sink & 0xFF));
+    }
+    return 0;
+}
+
+// =============================================================================
+// Slow Drags
+// =============================================================================
+
+int RunDrag(const Args &)
+{
+    namespace protocol = idrive::protocol;
+
+    // Steps per 5 ms frame in raw units, the slowest a finger can move, most
+    // of them below the travel threshold so they add up before they apply.
+    // Each drag ends on a multiple of what the threshold lets through, so all
+    // of its travel is applied.
+    const struct {
+        const char *name;
+        int         dx, dy;
+        int         frames;
+    } kDrags[] = {
+        {"x +1", 1, 0, 300},
+        {"x +3", 3, 0, 100},
+        {"x -2", -2, 0, 150},
+        {"y +1", 0, 1, 300},
+        {"y -4", 0, -4, 76},
+        {"diagonal +1 +1", 1, 1, 300},
+        {"diagonal +2 -1", 2, -1, 300},
+        {"diagonal -1 +2", -1, 2, 300},
+        {"x +7", 7, 0, 40},
+    };
+
+    Checks check;
+    std::printf("%-16s %9s %6s %8s %8s %8s %8s  %s\n", "drag", "threshold", "frames", "want x",
+                "got x", "want y", "got y", "result");
+    for (int min_travel : {idrive::config::kMinMouseTravel, 5}) {
+        for (const auto &drag : kDrags) {
+            SimHidPort              port;
+            idrive::UsbHidDevice    hid;
+            idrive::TouchpadHandler touchpad(hid, min_travel, idrive::config::kXMultiplier,
+                                             idrive::config::kYMultiplier);
+            hid.Attach(port);
+            port.SetMounted(true);
+            hid.OnMount();
+
+            uint64_t t_us = 1000000;
+            auto     feed = [&](uint8_t state, int x, int y) {
+                SetTimeUs(t_us);
+                idrive::InputEvent event;
+                event.type         = idrive::InputEvent::Type::Touchpad;
+                event.state        = state;
+                event.x            = static_cast<int16_t>(x);
+                event.y            = static_cast<int16_t>(y);
+                event.timestamp_us = t_us;
+                touchpad.Handle(event);
+                if (t_us % (idrive::config::kHidPollIntervalMs * 1000) == 0 && port.Poll(t_us)) {
+                    hid.OnReportComplete();
+                }
+                t_us += 5000;
+            };
+
+            int x = 256 - drag.dx * drag.frames / 2;
+            int y = 256 - drag.dy * drag.frames / 2;
+            feed(protocol::kTouchSingle, x, y);
+            for (int i = 1; i <= drag.frames; ++i) {
+                feed(protocol::kTouchSingle, x + drag.dx * i, y + drag.dy * i);
+            }
+            feed(protocol::kTouchFingerRemoved, 0, 0);
+            for (int i = 0; i < 20; ++i) {
+                feed(protocol::kTouchFingerRemoved, 0, 0);
+            }
+
+            int64_t got_x = 0;
+            int64_t got_y = 0;
+            for (const HidReportRecord &r : port.Reports()) {
+                if (r.report_id == idrive::kReportIdMouse) {
+                    got_x += MouseOf(r).x;
+                    got_y += MouseOf(r).y;
+                }
+            }
+            // Touchpad Y grows upward, screen Y downward.
+            int64_t want_x = drag.dx * drag.frames * idrive::config::kXMultiplier / 10;
+            int64_t want_y = -drag.dy * drag.frames * idrive::config::kYMultiplier / 10;
+            bool    ok     = std::abs(got_x - want_x) <= 1 && std::abs(got_y - want_y) <= 1;
+            check.Count(ok);
+            std::printf("%-16s %9d %6d %8lld %8lld %8lld %8lld  %s\n", drag.name, min_travel,
+                        drag.frames, static_cast<long long>(want_x),
+                        static_cast<long long>(got_x), static_cast<long long>(want_y),
+                        static_cast<long long>(got_y), ok ? "ok" : "FAIL");
+        }
+    }
+    return check.Finish();
+}
+
+// =============================================================================
+// Touch Filter Tuning
+// =============================================================================
+
+namespace {
+
+struct TouchSample {
+    idrive::InputEvent event;  // As fed to the filter (noise added)
+    int16_t            clean_x = 0;
+    int16_t            clean_y = 0;
+};
+
+struct FilterScore {
+    double   jitter   = 0.0;  // RMS second difference of finger 1, raw units
+    double   error    = 0.0;  // RMS distance from the reference track, raw units
+    uint32_t lag_mean = 0;    // Added latency reported by the filter, us
+    uint32_t lag_p99  = 0;
+};
+
+// Run one setting (nullptr = unfiltered) over the samples. Contacts are
+// scored separately: differences never span a lift or a finger count change.
+FilterScore ScoreFilter(const std::vector<TouchSample> &samples, idrive::TouchFilter *filter)
+{
+    FilterScore score;
+    double      jitter_sum = 0.0;
+    double      error_sum  = 0.0;
+    uint64_t    jitter_n   = 0;
+    uint64_t    error_n    = 0;
+    int         run        = 0;  // Consecutive samples of the current contact
+    int16_t     px[2]      = {};
+    int16_t     py[2]      = {};
+    uint8_t     last_state = 0;
+
+    if (filter) {
+        filter->Reset();
+        filter->ResetStats();
+    }
+
+    for (const TouchSample &sample : samples) {
+        idrive::InputEvent event = sample.event;
+        if (filter) {
+            filter->Apply(event);
+        }
+        if (event.state == idrive::protocol::kTouchFingerRemoved || event.state != last_state) {
+            run = 0;
+        }
+        last_state = event.state;
+        if (event.state == idrive::protocol::kTouchFingerRemoved) {
+            continue;
+        }
+
+        double ex = event.x - sample.clean_x;
+        double ey = event.y - sample.clean_y;
+        error_sum += ex * ex + ey * ey;
+        error_n++;
+
+        if (run >= 2) {
+            double ax = event.x - 2.0 * px[0] + px[1];
+            double ay = event.y - 2.0 * py[0] + py[1];
+            jitter_sum += ax * ax + ay * ay;
+            jitter_n++;
+        }
+        px[1] = px[0];
+        py[1] = py[0];
+        px[0] = event.x;
+        py[0] = event.y;
+        run++;
+    }
+
+    score.jitter = jitter_n ? std::sqrt(jitter_sum / jitter_n) : 0.0;
+    score.error  = error_n ? std::sqrt(error_sum / error_n) : 0.0;
+    if (filter) {
+        score.lag_mean = filter->AddedLatency().MeanUs();
+        score.lag_p99  = filter->AddedLatency().PercentileUs(99);
+    }
+    return score;
+}
+
+}  // namespace
+
+int RunFilter(const Args &args)
+{
+    FILE *in = args.operand ? std::fopen(args.operand, "r") : stdin;
+    if (!in) {
+        std::perror(args.operand);
+        return 1;
+    }
+
+    // Decode the touch frames once; every setting runs over the same samples.
+    std::vector<TouchSample>  samples;
+    idrive::sim::CanLogReader reader(in);
+    CanMessage                msg;
+    uint32_t                  state = 12345;
+    while (reader.Next(msg)) {
+        TouchSample sample;
+        if (msg.id != idrive::can_id::kTouch ||
+            !idrive::IDriveController::DecodeTouchpadFrame(msg, sample.event)) {
+            continue;
+        }
+        sample.clean_x = sample.event.x;
+        sample.clean_y = sample.event.y;
+        if (args.noise > 0 && sample.event.state != idrive::protocol::kTouchFingerRemoved) {
+            int16_t *coords[] = {&sample.event.x, &sample.event.y, &sample.event.x2,
+                                 &sample.event.y2};
+            for (int16_t *c : coords) {
+                state   = state * 1664525u + 1013904223u;
+                int v   = *c + static_cast<int>((state >> 16) % (2 * args.noise + 1)) - args.noise;
+                *c      = static_cast<int16_t>(v < 0 ? 0 : v > 511 ? 511 : v);
+            }
+        }
+        samples.push_back(sample);
+    }
+    if (in != stdin) {
+        std::fclose(in);
+    }
+    if (samples.empty()) {
+        std::fprintf(stderr, "no touch frames (0x%03lX) in input\n",
+                     static_cast<unsigned long>(idrive::can_id::kTouch));
+        return 1;
+    }
+
+    std::printf("%zu touch samples, noise +/-%d units\n\n", samples.size(), args.noise);
+    std::printf("%-22s %8s %8s %10s %10s\n", "setting", "jitter", "error", "lag mean", "lag p99");
+
+    FilterScore raw = ScoreFilter(samples, nullptr);
+    std::printf("%-22s %8.3f %8.3f %10s %10s\n", "raw", raw.jitter, raw.error, "-", "-");
+
+    // Sweep min cutoff x beta around the firmware default.
+    idrive::OneEuroParams firmware;
+    firmware.min_cutoff_mhz = idrive::config::kTouchFilterMinCutoffMhz;
+    firmware.beta_mhz       = idrive::config::kTouchFilterBetaMhz;
+    firmware.d_cutoff_mhz   = idrive::config::kTouchFilterDCutoffMhz;
+
+    std::vector<idrive::OneEuroParams> settings = {firmware};
+    for (uint32_t min_cutoff : {1000u, 2500u, 5000u, 10000u}) {
+        for (uint32_t beta : {0u, 20u, 50u, 200u}) {
+            idrive::OneEuroParams params = firmware;
+            params.min_cutoff_mhz        = min_cutoff;
+            params.beta_mhz              = beta;
+            settings.push_back(params);
+        }
+    }
+
+    idrive::OneEuroTouchFilter filter;
+    for (size_t i = 0; i < settings.size(); ++i) {
+        filter.SetParams(settings[i]);
+        FilterScore score = ScoreFilter(samples, &filter);
+
+        char name[32];
+        std::snprintf(name, sizeof(name), "%s%.1fHz b=%lu", i == 0 ? "* " : "",
+                      settings[i].min_cutoff_mhz / 1000.0,
+                      static_cast<unsigned long>(settings[i].beta_mhz));
+        std::printf("%-22s %8.3f %8.3f %10lu %10lu\n", name, score.jitter, score.error,
+                    static_cast<unsigned long>(score.lag_mean),
+                    static_cast<unsigned long>(score.lag_p99));
+    }
+    std::printf("\n* firmware default (config.h); jitter = RMS second difference, error = RMS "
+                "distance from the %s track\n",
+                args.noise > 0 ? "clean" : "raw");
+    return 0;
+}
+
+// =============================================================================
+// Swipe Recognizer
+// =============================================================================
+
+namespace {
+
+// Synthetic touch contact: fingers land as one, then two, then `fingers`,
+// move (dx, dy) raw units over move_ms with +/-noise jitter, rest for hold_ms
+// and lift. Samples every 5 ms like the pad.
+std::vector<idrive::InputEvent> MakeContact(uint8_t fingers, int x, int y, int dx, int dy,
+                                            uint32_t move_ms, uint32_t hold_ms, int noise,
+                                            uint64_t &t_us, uint32_t &rng)
+{
+    static const uint8_t kStates[] = {0, idrive::protocol::kTouchSingle,
+                                      idrive::protocol::kTouchMulti,
+                                      idrive::protocol::kTouchTriple,
+                                      idrive::protocol::kTouchQuad};
+    constexpr uint32_t   kPeriodUs = 5000;
+
+    std::vector<idrive::InputEvent> events;
+    auto                            jitter = [&]() {
+        rng = rng * 1664525u + 1013904223u;
+        return noise > 0 ? static_cast<int>((rng >> 16) % (2 * noise + 1)) - noise : 0;
+    };
+    auto add = [&](uint8_t state, int px, int py) {
+        idrive::InputEvent event;
+        event.type         = idrive::InputEvent::Type::Touchpad;
+        event.state        = state;
+        event.x            = static_cast<int16_t>(std::min(511, std::max(0, px + jitter())));
+        event.y            = static_cast<int16_t>(std::min(511, std::max(0, py + jitter())));
+        event.two_fingers  = state == idrive::protocol::kTouchMulti;
+        event.x2           = static_cast<int16_t>(std::min(511, event.x + 60));
+        event.y2           = event.y;
+        event.timestamp_us = t_us;
+        t_us += kPeriodUs;
+        events.push_back(event);
+    };
+
+    // Fingers rarely land together.
+    for (uint8_t n = 1; n < fingers; ++n) {
+        add(kStates[n], x, y);
+    }
+    uint32_t steps = move_ms * 1000 / kPeriodUs;
+    for (uint32_t i = 0; i <= steps; ++i) {
+        add(kStates[fingers], x + dx * static_cast<int>(i) / static_cast<int>(steps ? steps : 1),
+            y + dy * static_cast<int>(i) / static_cast<int>(steps ? steps : 1));
+    }
+    for (uint32_t i = 0; i < hold_ms * 1000 / kPeriodUs; ++i) {
+        add(kStates[fingers], x + dx, y + dy);
+    }
+    add(idrive::protocol::kTouchFingerRemoved, 0, 0);
+    t_us += 300000;
+    return events;
+}
+
+// Feed a contact as the firmware does (through the touch filter). Returns the
+// swipes fired; sets fired/fingers/direction of the last one.
+int FeedContact(idrive::SwipeRecognizer &recognizer, idrive::TouchFilter *filter,
+                std::vector<idrive::InputEvent> events, idrive::SwipeResult &last)
+{
+    int fired = 0;
+    for (idrive::InputEvent &event : events) {
+        if (filter) {
+            filter->Apply(event);
+        }
+        idrive::SwipeResult result = recognizer.Feed(event);
+        if (result.fired) {
+            last = result;
+            fired++;
+        }
+    }
+    return fired;
+}
+
+}  // namespace
+
+int RunSwipe(const Args &args)
+{
+    using idrive::SwipeDirection;
+
+    idrive::OneEuroParams filter_params;
+    filter_params.min_cutoff_mhz = idrive::config::kTouchFilterMinCutoffMhz;
+    filter_params.beta_mhz       = idrive::config::kTouchFilterBetaMhz;
+    filter_params.d_cutoff_mhz   = idrive::config::kTouchFilterDCutoffMhz;
+    idrive::OneEuroTouchFilter  one_euro(filter_params);
+    idrive::TouchFilter        *filter = idrive::config::kTouchFilter ? &one_euro : nullptr;
+
+    idrive::SwipeParams params;
+    params.min_distance = idrive::config::kSwipeMinDistance;
+    params.axis_ratio   = idrive::config::kSwipeAxisRatio;
+    params.max_duration = idrive::config::kSwipeMaxDurationMs;
+    idrive::SwipeRecognizer recognizer(params);
+
+    uint64_t t_us = 1000000;
+    uint32_t rng  = 12345;
+
+    // Swipes: every finger count and direction, from a grid of start points,
+    // at several lengths and speeds. Each must fire once, the right way.
+    const struct {
+        SwipeDirection direction;
+        int            dx, dy;
+    } kDirections[] = {
+        {SwipeDirection::Up, 0, 1},
+        {SwipeDirection::Down, 0, -1},
+        {SwipeDirection::Left, -1, 0},
+        {SwipeDirection::Right, 1, 0},
+    };
+    uint32_t swipes = 0, detected = 0, wrong = 0, missed = 0;
+    for (uint8_t fingers : {3, 4}) {
+        for (const auto &d : kDirections) {
+            for (int length : {100, 160, 240}) {
+                for (uint32_t move_ms : {80u, 160u, 320u}) {
+                    for (int start : {130, 256, 380}) {
+                        // Start so the swipe stays on the pad.
+                        int x = d.dx > 0 ? start - length / 2 : d.dx < 0 ? start + length / 2
+                                                                         : start;
+                        int y = d.dy > 0 ? start - length / 2 : d.dy < 0 ? start + length / 2
+                                                                         : start;
+                        // Real swipes wander off-axis a little.
+                        int drift = length / 6;
+                        int dx    = d.dx ? d.dx * length : drift;
+                        int dy    = d.dy ? d.dy * length : drift;
+
+                        idrive::SwipeResult last;
+                        int                 fired =
+                            FeedContact(recognizer, filter,
+                                        MakeContact(fingers, x, y, dx, dy, move_ms, 50, 2, t_us,
+                                                    rng),
+                                        last);
+                        swipes++;
+                        if (fired == 0) {
+                            missed++;
+                        } else if (fired > 1 || last.fingers != fingers ||
+                                   last.direction != d.direction) {
+                            wrong++;
+                        } else {
+                            detected++;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    std::printf("synthetic swipes: %lu, detected %lu (%.1f%%), missed %lu, wrong %lu\n",
+                static_cast<unsigned long>(swipes), static_cast<unsigned long>(detected),
+                100.0 * detected / swipes, static_cast<unsigned long>(missed),
+                static_cast<unsigned long>(wrong));
+
+    // Contacts that must not fire: resting and tapping with 3/4 fingers,
+    // short or slow or diagonal moves, and 1-2 finger swipes of any kind.
+    const struct {
+        const char *name;
+        uint8_t     fingers;
+        int         dx, dy;
+        uint32_t    move_ms, hold_ms;
+        int         noise;
+    } kNegatives[] = {
+        {"rest 3", 3, 0, 0, 0, 800, 4},
+        {"rest 4", 4, 0, 0, 0, 800, 4},
+        {"tap 3", 3, 0, 0, 0, 80, 3},
+        {"short 3", 3, 50, 20, 150, 50, 2},
+        {"slow 3", 3, 200, 0, 2500, 50, 2},
+        {"diagonal 3", 3, 120, 110, 200, 50, 2},
+        {"diagonal 4", 4, -120, 130, 200, 50, 2},
+        {"drag 1", 1, 250, 0, 150, 50, 2},
+        {"scroll 2", 2, 0, 250, 150, 50, 2},
+    };
+    uint32_t negatives = 0, false_positives = 0;
+    std::printf("\n%-12s %8s %8s\n", "non-swipe", "contacts", "fired");
+    for (const auto &n : kNegatives) {
+        uint32_t fired = 0, runs = 0;
+        for (int x : {100, 200, 300}) {
+            for (int y : {100, 200, 300}) {
+                idrive::SwipeResult last;
+                fired += FeedContact(recognizer, filter,
+                                     MakeContact(n.fingers, x, y, n.dx, n.dy, n.move_ms,
+                                                 n.hold_ms, n.noise, t_us, rng),
+                                     last);
+                runs++;
+            }
+        }
+        std::printf("%-12s %8lu %8lu\n", n.name, static_cast<unsigned long>(runs),
+                    static_cast<unsigned long>(fired));
+        negatives += runs;
+        false_positives += fired;
+    }
+    std::printf("false positives: %lu of %lu contacts (%.2f%%)\n",
+                static_cast<unsigned long>(false_positives), static_cast<unsigned long>(negatives),
+                100.0 * false_positives / negatives);
+
+    // A swipe whose fingers dip to two and come back down is still one
+    // contact: it must not fire again until every finger has lifted.
+    uint32_t dips = 0, refired = 0;
+    for (uint8_t fingers : {3, 4}) {
+        for (uint32_t dip_ms : {10u, 100u, 400u}) {
+            std::vector<idrive::InputEvent> events =
+                MakeContact(fingers, 130, 250, 200, 0, 120, 50, 2, t_us, rng);
+            events.pop_back();  // Fingers stay on the pad
+            idrive::InputEvent dip = events.back();
+            dip.state              = idrive::protocol::kTouchMulti;
+            dip.two_fingers        = true;
+            for (uint32_t i = 0; i < dip_ms / 5; ++i) {
+                dip.timestamp_us += 5000;
+                events.push_back(dip);
+            }
+            t_us = dip.timestamp_us + 5000;
+            std::vector<idrive::InputEvent> again =
+                MakeContact(fingers, 380, 250, -200, 0, 120, 50, 2, t_us, rng);
+            events.insert(events.end(), again.begin(), again.end());
+
+            idrive::SwipeResult last;
+            int                 fired = FeedContact(recognizer, filter, events, last);
+            dips++;
+            if (fired != 1) {
+                refired++;
+            }
+        }
+    }
+    std::printf("\nfinger dips (3/4 -> 2 -> 3/4): %lu contacts, %lu not fired exactly once\n",
+                static_cast<unsigned long>(dips), static_cast<unsigned long>(refired));
+
+    // Per-sample cost against the 5 ms sample period.
+    std::vector<idrive::InputEvent> bench;
+    for (int i = 0; i < 200; ++i) {
+        std::vector<idrive::InputEvent> contact =
+            MakeContact(3 + (i & 1), 100 + i % 200, 300 - i % 200, (i % 3 - 1) * 150,
+                        (i % 5 - 2) * 60, 200, 100, 3, t_us, rng);
+        bench.insert(bench.end(), contact.begin(), contact.end());
+    }
+    uint64_t sink  = 0;
+    auto     start = std::chrono::steady_clock::now();
+    for (int rep = 0; rep < 200; ++rep) {
+        for (const idrive::InputEvent &event : bench) {
+            sink += recognizer.Feed(event).fired;
+        }
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start)
+                    .count() /
+                (200.0 * bench.size());
+    std::printf("\nrecognizer: %.1f ns/sample (%.5f%% of a 5 ms sample period)  [%llu]\n", ns,
+                ns / 5e6 * 100.0, static_cast<unsigned long long>(sink & 0xFF));
+
+    // Recorded trace: every swipe fired is reported; in a log recorded
+    // without deliberate swipes they are all false positives.
+    if (args.operand) {
+        FILE *in = std::fopen(args.operand, "r");
+        if (!in) {
+            std::perror(args.operand);
+            return 1;
+        }
+        idrive::SwipeRecognizer   log_recognizer(params);
+        idrive::sim::CanLogReader reader(in);
+        CanMessage                msg;
+        uint64_t                  samples = 0, first_us = 0, last_us = 0;
+        one_euro.Reset();
+        while (reader.Next(msg)) {
+            idrive::InputEvent event;
+            if (msg.id != idrive::can_id::kTouch ||
+                !idrive::IDriveController::DecodeTouchpadFrame(msg, event)) {
+                continue;
+            }
+            if (samples++ == 0) {
+                first_us = msg.timestamp_us;
+            }
+            last_us = msg.timestamp_us;
+            if (filter) {
+                filter->Apply(event);
+            }
+            idrive::SwipeResult result = log_recognizer.Feed(event);
+            if (result.fired) {
+                std::printf("%llu swipe %u %s\n", static_cast<unsigned long long>(msg.timestamp_us),
+                            result.fingers, idrive::SwipeDirectionName(result.direction));
+            }
+        }
+        std::fclose(in);
+
+        const idrive::SwipeStats &stats = log_recognizer.Stats();
+        double                    hours = (last_us - first_us) / 3.6e9;
+        std::printf("\n%s: %llu touch samples over %.2f h, 3/4-finger contacts %lu, "
+                    "swipes %lu (%.2f/h), rejected %lu\n",
+                    args.operand, static_cast<unsigned long long>(samples), hours,
+                    static_cast<unsigned long>(stats.contacts),
+                    static_cast<unsigned long>(stats.fired), hours > 0 ? stats.fired / hours : 0.0,
+                    static_cast<unsigned long>(stats.rejected));
+    }
+    return missed + wrong + false_positives + refired > 0 ? 3 : 0;
+}
+
+// =============================================================================
+// Pinch / Scroll / Pan Arbitration
+// =============================================================================
+
+namespace {
+
+// What the host saw: zoom steps (Ctrl+wheel or consumer zoom usages), plain
+// wheel and pan detents, and whether every zoom detent arrived with Ctrl down.
+struct GestureOutcome {
+    int  zoom_in     = 0;
+    int  zoom_out    = 0;
+    int  scroll      = 0;
+    int  pan         = 0;
+    bool ctrl_leaked = false;  // Ctrl still down at the end
+};
+
+GestureOutcome ScoreReports(const std::vector<HidReportRecord> &reports)
+{
+    GestureOutcome outcome;
+    bool           ctrl     = false;
+    uint16_t       consumer = 0;
+    for (const HidReportRecord &r : reports) {
+        if (r.report_id == idrive::kReportIdKeyboard) {
+            ctrl = (r.data[0] & idrive::hid::key::kModLeftCtrl) != 0;
+        } else if (r.report_id == idrive::kReportIdMouse) {
+            idrive::MouseReport mouse = MouseOf(r);
+            if (ctrl) {
+                (mouse.wheel > 0 ? outcome.zoom_in : outcome.zoom_out) += std::abs(mouse.wheel);
+            } else {
+                outcome.scroll += mouse.wheel;
+            }
+            outcome.pan += mouse.pan;
+        } else if (r.report_id == idrive::kReportIdConsumer) {
+            uint16_t usage = static_cast<uint16_t>(r.data[0] | (r.data[1] << 8));
+            if (usage != consumer && usage == idrive::hid::android::kZoomIn) {
+                outcome.zoom_in++;
+            } else if (usage != consumer && usage == idrive::hid::android::kZoomOut) {
+                outcome.zoom_out++;
+            }
+            consumer = usage;
+        }
+    }
+    outcome.ctrl_leaked = ctrl;
+    return outcome;
+}
+
+}  // namespace
+
+int RunPinch(const Args &args)
+{
+    using idrive::PinchMode;
+
+    // Finger paths: linear from (x, y, x2, y2) to the end positions over
+    // move_ms, +/-noise on every coordinate. A second leg (if move2_ms) then
+    // continues to the second end positions.
+    struct Leg {
+        int      x, y, x2, y2;
+        uint32_t ms;
+    };
+    const struct {
+        const char *name;
+        int         x, y, x2, y2;
+        Leg         legs[2];
+        int         noise;
+        bool        zoom;       // Expect zoom steps (in pinch modes)
+        int         zoom_sign;  // +1 in, -1 out
+        bool        scroll;     // Expect plain scrolling
+        int         pan_sign;   // Expect panning: +1 right, -1 left, 0 none
+    } kScenarios[] = {
+        {"spread", 200, 256, 312, 256, {{100, 256, 412, 256, 300}, {}}, 1, true, 1, false, 0},
+        {"pinch", 100, 256, 412, 256, {{200, 256, 312, 256, 300}, {}}, 1, true, -1, false, 0},
+        {"spread one finger", 200, 200, 300, 200, {{200, 200, 450, 200, 300}, {}}, 1, true, 1,
+         false, 0},
+        {"spread diagonal", 220, 220, 290, 290, {{120, 120, 390, 390, 300}, {}}, 1, true, 1,
+         false, 0},
+        {"scroll up", 200, 100, 300, 100, {{200, 400, 300, 400, 400}, {}}, 3, false, 0, true, 0},
+        {"scroll down", 200, 400, 300, 400, {{200, 100, 300, 100, 400}, {}}, 3, false, 0, true,
+         0},
+        {"scroll, fingers drift", 200, 100, 300, 100, {{190, 400, 320, 400, 400}, {}}, 3, false,
+         0, true, 0},
+        {"scroll then spread", 220, 100, 300, 100, {{220, 300, 300, 300, 250},
+                                                    {60, 300, 460, 300, 250}},
+         2, true, 1, true, 0},
+        {"pan right", 100, 200, 100, 300, {{400, 200, 400, 300, 400}, {}}, 3, false, 0, false, 1},
+        {"pan left", 400, 200, 400, 300, {{100, 200, 100, 300, 400}, {}}, 3, false, 0, false,
+         -1},
+        {"pan, fingers drift", 100, 200, 100, 300, {{400, 260, 400, 340, 400}, {}}, 3, false, 0,
+         false, 1},
+        {"slow pan", 200, 200, 200, 300, {{260, 200, 260, 300, 1500}, {}}, 1, false, 0, false,
+         1},
+    };
+    const struct {
+        PinchMode   mode;
+        const char *name;
+    } kModes[] = {
+        {PinchMode::Off, "off"},
+        {PinchMode::CtrlWheel, "ctrl+wheel"},
+        {PinchMode::ConsumerZoom, "consumer"},
+    };
+
+    Checks check;
+    std::printf("%-22s %-10s %7s %8s %6s %4s  %s\n", "scenario", "mode", "zoom in", "zoom out",
+                "scroll", "pan", "result");
+    for (const auto &mode : kModes) {
+        for (const auto &sc : kScenarios) {
+            idrive::Config config = Simulator::DefaultConfig();
+            config.pinch_mode     = mode.mode;
+
+            Simulator sim(config);
+            if (!sim.BringUp(args.detection_id)) {
+                std::fprintf(stderr, "controller did not become ready\n");
+                return 1;
+            }
+            sim.HidPort().ClearReports();
+
+            uint64_t t_us = sim.NowUs() + 10000;
+            uint32_t rng  = 777;
+            auto     jit  = [&]() {
+                rng = rng * 1664525u + 1013904223u;
+                return static_cast<int>((rng >> 16) % (2 * sc.noise + 1)) - sc.noise;
+            };
+            int x = sc.x, y = sc.y, x2 = sc.x2, y2 = sc.y2;
+            for (const Leg &leg : sc.legs) {
+                uint32_t steps = leg.ms / 5;
+                for (uint32_t i = 0; i < steps; ++i) {
+                    int px  = x + (leg.x - x) * static_cast<int>(i) / static_cast<int>(steps);
+                    int py  = y + (leg.y - y) * static_cast<int>(i) / static_cast<int>(steps);
+                    int px2 = x2 + (leg.x2 - x2) * static_cast<int>(i) / static_cast<int>(steps);
+                    int py2 = y2 + (leg.y2 - y2) * static_cast<int>(i) / static_cast<int>(steps);
+                    sim.Feed(TouchFrame(t_us, idrive::protocol::kTouchMulti, px + jit(), py + jit(),
+                                        px2 + jit(), py2 + jit()));
+                    t_us += 5000;
+                }
+                if (leg.ms) {
+                    x = leg.x, y = leg.y, x2 = leg.x2, y2 = leg.y2;
+                }
+            }
+            // Rest before lifting so no fling adds to the count.
+            for (int i = 0; i < 20; ++i) {
+                sim.Feed(TouchFrame(t_us, idrive::protocol::kTouchMulti, x, y, x2, y2));
+                t_us += 5000;
+            }
+            sim.Feed(TouchFrame(t_us, idrive::protocol::kTouchFingerRemoved, 0, 0));
+            sim.AdvanceTo(t_us + 500000);
+
+            GestureOutcome out      = ScoreReports(sim.HidPort().Reports());
+            bool           pinching = mode.mode != PinchMode::Off;
+            bool           ok       = !out.ctrl_leaked;
+            if (pinching && sc.zoom) {
+                int wanted = sc.zoom_sign > 0 ? out.zoom_in : out.zoom_out;
+                int other  = sc.zoom_sign > 0 ? out.zoom_out : out.zoom_in;
+                ok         = ok && wanted >= 3 && other == 0;
+            } else {
+                ok = ok && out.zoom_in == 0 && out.zoom_out == 0;
+            }
+            // Scrolls must scroll; with pinch on, pinches must not. (With pinch
+            // off a spread scrolls by whatever its fingers' mean Y travel is.)
+            if (sc.scroll) {
+                ok = ok && out.scroll != 0;
+            } else if (pinching || sc.pan_sign != 0) {
+                ok = ok && out.scroll == 0;
+            }
+            // Likewise pans must pan, and only along their own axis.
+            if (sc.pan_sign != 0) {
+                ok = ok && out.pan * sc.pan_sign > 0;
+            } else if (pinching || sc.scroll) {
+                ok = ok && out.pan == 0;
+            }
+            check.Count(ok);
+
+            std::printf("%-22s %-10s %7d %8d %6d %4d  %s%s\n", sc.name, mode.name, out.zoom_in,
+                        out.zoom_out, out.scroll, out.pan, ok ? "ok" : "FAIL",
+                        out.ctrl_leaked ? " (ctrl left down)" : "");
+        }
+    }
+
+    // Ctrl+wheel zoom to a host that set the resolution multiplier: each
+    // zoom step is still exactly one detent, now kWheelUnitsPerDetent units.
+    {
+        GestureOutcome zoom[2];
+        for (uint8_t multiplier : {uint8_t(0), kHiResMultiplier}) {
+            idrive::Config config = Simulator::DefaultConfig();
+            config.pinch_mode     = PinchMode::CtrlWheel;
+            Simulator sim(config);
+            if (!sim.BringUp(args.detection_id)) {
+                std::fprintf(stderr, "controller did not become ready\n");
+                return 1;
+            }
+            sim.Hid().OnSetResolutionMultiplier(multiplier);
+            sim.HidPort().ClearReports();
+
+            uint64_t t_us = sim.NowUs() + 10000;
+            for (int i = 0; i < 60; ++i, t_us += 5000) {
+                sim.Feed(TouchFrame(t_us, idrive::protocol::kTouchMulti, 200 - i * 2, 256,
+                                    312 + i * 2, 256));
+            }
+            sim.Feed(TouchFrame(t_us, idrive::protocol::kTouchFingerRemoved, 0, 0));
+            sim.AdvanceTo(t_us + 500000);
+            zoom[multiplier ? 1 : 0] = ScoreReports(sim.HidPort().Reports());
+        }
+        bool ok = zoom[0].zoom_in >= 3 && zoom[0].zoom_out == 0 && !zoom[1].ctrl_leaked &&
+                  zoom[1].zoom_in == zoom[0].zoom_in * idrive::kWheelUnitsPerDetent &&
+                  zoom[1].zoom_out == 0;
+        check.Count(ok);
+        std::printf("\n%-33s %7d %8d %6d %4d  %s\n", "spread, high-res wheel (units)",
+                    zoom[1].zoom_in, zoom[1].zoom_out, zoom[1].scroll, zoom[1].pan,
+                    ok ? "ok" : "FAIL");
+    }
+
+    // Ctrl released while a zoom step waits for the endpoint, then a plain
+    // scroll step: the zoom step goes out with Ctrl down, the scroll after it.
+    {
+        idrive::sim::SimHidPort port;
+        idrive::UsbHidDevice    hid;
+        hid.Attach(port);
+        port.SetMounted(true);
+        hid.OnMount();
+        uint64_t now_us = 1000000;
+        idrive::sim::SetTimeUs(now_us);
+        hid.ModifierPress(idrive::hid::key::kModLeftCtrl);
+        hid.MouseScroll(1);
+        hid.ModifierRelease(idrive::hid::key::kModLeftCtrl);
+        hid.MouseScroll(1);
+        for (int i = 0; i < 10; ++i) {
+            now_us += idrive::config::kHidPollIntervalMs * 1000;
+            idrive::sim::SetTimeUs(now_us);
+            if (port.Poll(now_us)) {
+                hid.OnReportComplete();
+            }
+        }
+        GestureOutcome out = ScoreReports(port.Reports());
+        bool           ok  = out.zoom_in == 1 && out.scroll == 1 && !out.ctrl_leaked;
+        check.Count(ok);
+        std::printf("\n%-33s %7d %8d %6d %4d  %s\n", "ctrl up between wheel steps", out.zoom_in,
+                    out.zoom_out, out.scroll, out.pan, ok ? "ok" : "FAIL");
+    }
+    return check.Finish();
+}
+
+// =============================================================================
+// Tap Resolution
+// =============================================================================
+
+namespace {
+
+// Left button presses the host saw, whether any press was a drag (held with
+// motion, or held far longer than a click), and when the first press arrived.
+struct TapOutcome {
+    int      presses        = 0;
+    bool     drag           = false;
+    uint64_t first_press_us = 0;
+};
+
+TapOutcome ScoreTaps(const std::vector<HidReportRecord> &reports)
+{
+    TapOutcome outcome;
+    bool       down     = false;
+    uint64_t   press_us = 0;
+    for (const HidReportRecord &r : reports) {
+        if (r.report_id != idrive::kReportIdMouse) {
+            continue;
+        }
+        idrive::MouseReport mouse   = MouseOf(r);
+        bool                pressed = (mouse.buttons & idrive::hid::mouse::kButtonLeft) != 0;
+        if (pressed && !down) {
+            outcome.presses++;
+            press_us = r.time_us;
+            if (outcome.presses == 1) {
+                outcome.first_press_us = r.time_us;
+            }
+        } else if (!pressed && down && r.time_us - press_us > 100000) {
+            outcome.drag = true;
+        }
+        if (pressed && (mouse.x != 0 || mouse.y != 0)) {
+            outcome.drag = true;
+        }
+        down = pressed;
+    }
+    return outcome;
+}
+
+}  // namespace
+
+int RunTap(const Args &args)
+{
+    using idrive::TapMode;
+
+    // One-finger strokes: touch down gap_ms after the previous lift, stay
+    // hold_ms while moving dx raw units, lift.
+    struct Stroke {
+        uint32_t gap_ms, hold_ms;
+        int      dx;
+    };
+    const struct {
+        const char *name;
+        Stroke      strokes[2];
+        int         presses[2];  // Expected presses: deferred, fast
+        bool        drag;
+    } kScenarios[] = {
+        {"tap", {{0, 80, 0}, {}}, {1, 1}, false},
+        {"double tap", {{0, 80, 0}, {120, 80, 0}}, {2, 2}, false},
+        {"slow double tap", {{0, 80, 0}, {400, 80, 0}}, {2, 2}, false},
+        {"tap-tap-drag", {{0, 80, 0}, {120, 500, 200}}, {1, 2}, true},
+        {"tap-tap-hold", {{0, 80, 0}, {120, 500, 0}}, {1, 2}, true},
+        {"tap, then move", {{0, 80, 0}, {500, 400, 200}}, {1, 1}, false},
+        {"long press", {{0, 400, 0}, {}}, {0, 0}, false},
+        {"move", {{0, 300, 150}, {}}, {0, 0}, false},
+    };
+    const struct {
+        TapMode     mode;
+        const char *name;
+    } kModes[] = {
+        {TapMode::Deferred, "deferred"},
+        {TapMode::FastClick, "fast"},
+    };
+
+    Checks check;
+    std::printf("%-16s %-9s %7s %5s %9s  %s\n", "scenario", "mode", "presses", "drag",
+                "click ms", "result");
+    for (size_t m = 0; m < 2; ++m) {
+        idrive::utils::LatencyHistogram delay;
+        for (const auto &sc : kScenarios) {
+            idrive::Config config = Simulator::DefaultConfig();
+            config.tap_mode       = kModes[m].mode;
+
+            Simulator sim(config);
+            if (!sim.BringUp(args.detection_id)) {
+                std::fprintf(stderr, "controller did not become ready\n");
+                return 1;
+            }
+            sim.HidPort().ClearReports();
+
+            uint64_t t_us    = sim.NowUs() + 10000;
+            uint64_t lift_us = 0;
+            for (const Stroke &stroke : sc.strokes) {
+                if (stroke.hold_ms == 0) {
+                    continue;
+                }
+                t_us += stroke.gap_ms * 1000;
+                uint32_t steps = stroke.hold_ms / 10;
+                for (uint32_t i = 0; i < steps; ++i) {
+                    int x = 200 + stroke.dx * static_cast<int>(i) / static_cast<int>(steps);
+                    sim.Feed(TouchFrame(t_us, idrive::protocol::kTouchSingle, x, 250));
+                    t_us += 10000;
+                }
+                sim.Feed(TouchFrame(t_us, idrive::protocol::kTouchFingerRemoved, 0, 0));
+                if (lift_us == 0) {
+                    lift_us = t_us;
+                }
+            }
+            sim.AdvanceTo(t_us + 1000000);
+
+            TapOutcome out = ScoreTaps(sim.HidPort().Reports());
+            bool       ok  = out.presses == sc.presses[m] && out.drag == sc.drag;
+            check.Count(ok);
+
+            // Lift to the host seeing the press (a poll interval included).
+            double click_ms = out.presses ? (out.first_press_us - lift_us) / 1000.0 : 0;
+            if (out.presses && !sc.drag) {
+                delay.Record(static_cast<uint32_t>(out.first_press_us - lift_us));
+            }
+            std::printf("%-16s %-9s %7d %5s %9.1f  %s\n", sc.name, kModes[m].name, out.presses,
+                        out.drag ? "yes" : "no", click_ms, ok ? "ok" : "FAIL");
+        }
+        std::printf("%-16s %-9s click delay p50 %.1f ms, max %.1f ms\n\n", "", kModes[m].name,
+                    delay.PercentileUs(50) / 1000.0, delay.MaxUs() / 1000.0);
+    }
+    return check.Finish();
+}
+
+}  // namespace idrive::sim
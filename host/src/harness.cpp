@@ -0,0 +1,46 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+
+#include "sim/harness.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace idrive::sim {
+
+void Checks::operator()(const char *what, bool ok)
+{
+    std::printf("  %-58s %s\n", what, ok ? "ok" : "FAIL");
+    Count(ok);
+}
+
+int Checks::Finish() const
+{
+    std::printf("\n%d failures\n", failures_);
+    return failures_ > 0 ? 3 : 0;
+}
+
+CanMessage TouchFrame(uint64_t t_us, uint8_t state, int x, int y, int x2, int y2)
+{
+    CanMessage msg;
+    msg.id           = can_id::kTouch;
+    msg.length       = 8;
+    msg.timestamp_us = t_us;
+    msg.data[1]      = static_cast<uint8_t>(x & 0xFF);
+    msg.data[2]      = static_cast<uint8_t>(((y & 0x0F) << 4) | ((x >> 8) & 0x01));
+    msg.data[3]      = static_cast<uint8_t>(y >> 4);
+    msg.data[4]      = state;
+    msg.data[5]      = static_cast<uint8_t>(x2 & 0xFF);
+    msg.data[6]      = static_cast<uint8_t>(((y2 & 0x0F) << 4) | ((x2 >> 8) & 0x01));
+    msg.data[7]      = static_cast<uint8_t>(y2 >> 4);
+    return msg;
+}
+
+MouseReport MouseOf(const HidReportRecord &r)
+{
+    MouseReport report;
+    std::memcpy(&report, r.data, sizeof(report));
+    return report;
+}
+
+}  // namespace idrive::sim
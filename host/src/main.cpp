@@ -0,0 +1,473 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+//
+// idrive_sim: run the firmware input pipeline on the host.
+//
+//   idrive_sim [options] replay [FILE]   Feed a candump or ASC log (stdin if
+//                                        no FILE) and print the HID reports it
+//                                        produces, then throughput on stderr.
+//   idrive_sim [options] bench [FRAMES]  Feed a synthetic ZBE4 stream (touch
+//                                        drags, taps, rotary, buttons) and
+//                                        print throughput.
+//   idrive_sim [options] decode [FILE]   Convert CANTRACE dumps from a serial
+//                                        console capture to a candump log.
+//   idrive_sim accel [SAMPLES]           Print the pointer acceleration curves
+//                                        and time the per-sample gain lookup.
+//   idrive_sim drag                      Slow one-finger drags on X, Y and
+//                                        diagonals: the pointer must move the
+//                                        scaled distance to within a pixel.
+//   idrive_sim [--noise N] filter [FILE] Score touch filter settings (jitter
+//                                        vs lag) on the touch frames of a log.
+//   idrive_sim swipe [FILE]              Score the 3/4-finger swipe recognizer
+//                                        on synthetic swipes and non-swipes,
+//                                        and count swipes fired in a log.
+//   idrive_sim pinch                     Run two-finger pinch, scroll and pan
+//                                        scenarios through the full pipeline
+//                                        in every pinch mode.
+//   idrive_sim tap                       Run tap, double tap and tap-drag
+//                                        scenarios in both tap modes and
+//                                        report the click delay each adds.
+//   idrive_sim digitizer                 Check the touch screen descriptor
+//                                        against the report layout, the
+//                                        contact encoder, and touch output
+//                                        switching through the pipeline.
+//   idrive_sim mouse                     Check the mouse descriptor, that
+//                                        motion, wheel and pan add up to what
+//                                        was sent in report and boot
+//                                        protocol, and high-resolution scroll.
+//   idrive_sim rotary                    Run synthetic knob spins through
+//                                        each rotary acceleration profile,
+//                                        and CAN bursts through coalescing.
+//   idrive_sim joystick                  Hold the stick in arrow key and mouse
+//                                        mode: typematic repeats and the
+//                                        cursor glide, at several controller
+//                                        frame rates.
+//   idrive_sim buttons                   Decode every ZBE4-03 transition
+//                                        between button chords and stick
+//                                        directions and check its edges.
+//   idrive_sim sched                   Step the periodic scheduler on a
+//                                      virtual clock and check deadlines, late
+//                                      wake catch-up and the per-job stats.
+//   idrive_sim ring [FRAMES]           Stress the CAN RX ring with a producer
+//                                      and a consumer thread: order, overrun
+//                                      count and high-water mark.
+//   idrive_sim dispatch [FRAMES]       Check the CAN ID dispatch table against
+//                                      the old if-chain on every ID and time
+//                                      both on a K-CAN ID mix (ns/frame).
+//   idrive_sim taps                    Tap keys, clicks and media keys on a
+//                                      virtual clock: releases at kTapHoldMs,
+//                                      preemption, queue overflow, late timer.
+// Options:
+//   --detect ID   Detection frame used for bring-up (hex, default 277 = ZBE4;
+//                 use 25B for ZBE4-03)
+//   --log LEVEL   Firmware log level: none, error, warn (default), info, debug
+//   --speed X     replay: pace frames at X times their logged timing
+//                 (1 = original timing; default 0 = as fast as possible)
+//   --golden FILE replay: diff the reports against FILE instead of printing
+//                 them; exit status 3 on any difference
+//   --asc         decode: write Vector ASC instead of candump
+//   --rx          decode: received frames only (drop the adapter's own TX)
+//   --noise N     filter: add +/-N raw units of uniform noise to the touch
+//                 coordinates (for clean synthetic logs); error is then
+//                 measured against the clean track
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "sim/can_log.h"
+#include "sim/harness.h"
+#include "sim/replay.h"
+#include "sim/sim_ports.h"
+#include "sim/simulator.h"
+#include "sim/trace_dump.h"
+
+using idrive::CanMessage;
+using idrive::sim::Args;
+using idrive::sim::HidReportRecord;
+using idrive::sim::ReplayOptions;
+using idrive::sim::ReplayResult;
+using idrive::sim::SimOptions;
+using idrive::sim::Simulator;
+
+namespace {
+
+const char *kTag = "SIM";
+
+int Usage()
+{
+    std::fprintf(stderr,
+                 "usage: idrive_sim [--detect ID] [--log LEVEL] [--speed X] [--golden FILE] "
+                 "replay [FILE]\n"
+                 "       idrive_sim [--detect ID] [--log LEVEL] bench [FRAMES]\n"
+                 "       idrive_sim [--asc] [--rx] decode [FILE]\n"
+                 "       idrive_sim accel [SAMPLES]\n"
+                 "       idrive_sim drag\n"
+                 "       idrive_sim [--noise N] filter [FILE]\n"
+                 "       idrive_sim swipe [FILE]\n"
+                 "       idrive_sim pinch\n"
+                 "       idrive_sim tap\n"
+                 "       idrive_sim digitizer\n"
+                 "       idrive_sim mouse\n"
+                 "       idrive_sim rotary\n"
+                 "       idrive_sim joystick\n"
+                 "       idrive_sim buttons\n"
+                 "       idrive_sim sched\n"
+                 "       idrive_sim ring [FRAMES]\n"
+                 "       idrive_sim dispatch [FRAMES]\n"
+                 "       idrive_sim taps\n");
+    return 2;
+}
+
+bool ParseLogLevel(const char *name, esp_log_level_t &level)
+{
+    static const char *kNames[] = {"none", "error", "warn", "info", "debug", "verbose"};
+    for (int i = 0; i <= ESP_LOG_VERBOSE; ++i) {
+        if (std::strcmp(name, kNames[i]) == 0) {
+            level = static_cast<esp_log_level_t>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ParseArgs(int argc, char **argv, Args &args)
+{
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--detect") == 0 && i + 1 < argc) {
+            args.detection_id = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 16));
+        } else if (std::strcmp(argv[i], "--log") == 0 && i + 1 < argc) {
+            if (!ParseLogLevel(argv[++i], args.log_level)) {
+                return false;
+            }
+        } else if (std::strcmp(argv[i], "--speed") == 0 && i + 1 < argc) {
+            args.speed = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--golden") == 0 && i + 1 < argc) {
+            args.golden = argv[++i];
+        } else if (std::strcmp(argv[i], "--noise") == 0 && i + 1 < argc) {
+            args.noise = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--asc") == 0) {
+            args.asc = true;
+        } else if (std::strcmp(argv[i], "--rx") == 0) {
+            args.rx_only = true;
+        } else if (!args.mode) {
+            args.mode = argv[i];
+        } else if (!args.operand) {
+            args.operand = argv[i];
+        } else {
+            return false;
+        }
+    }
+    return args.mode != nullptr;
+}
+
+void PrintStats(Simulator &sim)
+{
+    idrive::HidReportStats stats = sim.Hid().GetReportStats();
+    std::fprintf(stderr,
+                 "reports: sent=%lu coalesced=%lu dropped=%lu rejected=%lu saturated=%lu\n",
+                 static_cast<unsigned long>(stats.sent), static_cast<unsigned long>(stats.coalesced),
+                 static_cast<unsigned long>(stats.dropped),
+                 static_cast<unsigned long>(stats.rejected),
+                 static_cast<unsigned long>(stats.saturated));
+    std::fprintf(stderr, "can tx: %llu frames\n",
+                 static_cast<unsigned long long>(sim.Can().TxCount()));
+
+    idrive::sim::SetLogLevel(ESP_LOG_INFO);
+    sim.Hid().LogLatency(kTag);
+}
+
+void PrintThroughput(FILE *out, uint64_t frames, uint64_t reports, double bus_s, double wall_s)
+{
+    std::fprintf(out, "frames:        %llu\n", static_cast<unsigned long long>(frames));
+    std::fprintf(out, "bus time:      %.1f s\n", bus_s);
+    std::fprintf(out, "wall time:     %.3f s\n", wall_s);
+    if (frames > 0 && wall_s > 0.0) {
+        std::fprintf(out, "throughput:    %.2f Mframes/s\n", frames / wall_s / 1e6);
+        std::fprintf(out, "per frame:     %.1f ns\n", wall_s * 1e9 / frames);
+        std::fprintf(out, "speedup:       %.0fx real time\n", bus_s / wall_s);
+    }
+    std::fprintf(out, "hid reports:   %llu\n", static_cast<unsigned long long>(reports));
+}
+
+// =============================================================================
+// Replay
+// =============================================================================
+
+int RunReplay(const Args &args)
+{
+    FILE *in = args.operand ? std::fopen(args.operand, "r") : stdin;
+    if (!in) {
+        std::perror(args.operand);
+        return 1;
+    }
+
+    FILE *golden = nullptr;
+    if (args.golden) {
+        golden = std::fopen(args.golden, "r");
+        if (!golden) {
+            std::perror(args.golden);
+            return 1;
+        }
+    }
+
+    Simulator sim;
+    if (!sim.BringUp(args.detection_id)) {
+        std::fprintf(stderr, "controller did not become ready\n");
+        return 1;
+    }
+
+    // Reports go to stdout, or only into the diff when checking a golden file.
+    idrive::sim::GoldenDiff diff(golden);
+    char                    line[128];
+    auto                    sink = [&](const HidReportRecord &report) {
+        idrive::sim::FormatReportLine(report, line, sizeof(line));
+        if (golden) {
+            diff.Check(line);
+        } else {
+            std::printf("%s\n", line);
+        }
+    };
+
+    ReplayOptions options;
+    options.speed = args.speed;
+
+    idrive::sim::CanLogReader reader(in);
+    ReplayResult              result = idrive::sim::Replay(sim, reader, options, sink);
+
+    if (in != stdin) {
+        std::fclose(in);
+    }
+    std::fflush(stdout);
+
+    PrintThroughput(stderr, result.frames, result.reports, result.bus_s, result.wall_s);
+    PrintStats(sim);
+
+    if (golden) {
+        bool match = diff.Finish();
+        std::fclose(golden);
+        std::fprintf(stderr, "golden: %llu lines, %llu mismatches\n",
+                     static_cast<unsigned long long>(diff.Lines()),
+                     static_cast<unsigned long long>(diff.Mismatches()));
+        return match ? 0 : 3;
+    }
+    return 0;
+}
+
+// =============================================================================
+// Benchmark
+// =============================================================================
+
+// Synthetic ZBE4 traffic. One cycle is a touch drag, a tap, a rotary spin and
+// a button press, roughly 1.7 s of bus time.
+class TrafficGenerator {
+   public:
+    explicit TrafficGenerator(uint64_t start_us) : now_us_(start_us) {}
+
+    // Next frame of the stream.
+    CanMessage Next()
+    {
+        CanMessage msg;
+        msg.length = 8;
+
+        uint32_t step = step_++ % kCycleFrames;
+        if (step < kDragFrames) {
+            // Single finger circling the pad, 5 ms apart.
+            double angle = step * 0.05;
+            Touch(msg, idrive::protocol::kTouchSingle, 256 + static_cast<int>(120 * std::cos(angle)),
+                  256 + static_cast<int>(120 * std::sin(angle)));
+            now_us_ += 5000;
+        } else if (step == kDragFrames || step == kDragFrames + 2) {
+            Touch(msg, idrive::protocol::kTouchFingerRemoved, 0, 0);
+            now_us_ += 150000;
+        } else if (step == kDragFrames + 1) {
+            Touch(msg, idrive::protocol::kTouchSingle, 300, 300);  // Tap
+            now_us_ += 60000;
+        } else if (step < kDragFrames + 3 + kRotaryFrames) {
+            msg.id      = idrive::can_id::kRotary;
+            rotary_pos_ = static_cast<uint16_t>(rotary_pos_ + 1);
+            msg.data[3] = static_cast<uint8_t>(rotary_pos_ & 0xFF);
+            msg.data[4] = static_cast<uint8_t>(rotary_pos_ >> 8);
+            now_us_ += 20000;
+        } else {
+            bool pressed = (step == kCycleFrames - 2);
+            msg.id       = idrive::can_id::kInput;
+            msg.data[3]  = pressed ? idrive::protocol::kInputPressed : idrive::protocol::kInputReleased;
+            msg.data[4]  = idrive::protocol::kInputTypeButton;
+            msg.data[5]  = idrive::protocol::kButtonMenu;
+            now_us_ += 100000;
+        }
+
+        msg.timestamp_us = now_us_;
+        return msg;
+    }
+
+   private:
+    static constexpr uint32_t kDragFrames   = 200;
+    static constexpr uint32_t kRotaryFrames = 24;
+    static constexpr uint32_t kCycleFrames  = kDragFrames + 3 + kRotaryFrames + 2;
+
+    uint64_t now_us_;
+    uint32_t step_       = 0;
+    uint16_t rotary_pos_ = 0x1000;
+
+    static void Touch(CanMessage &msg, uint8_t type, int x, int y)
+    {
+        msg.id      = idrive::can_id::kTouch;
+        msg.data[1] = static_cast<uint8_t>(x & 0xFF);
+        msg.data[2] = static_cast<uint8_t>(((y & 0x0F) << 4) | ((x >> 8) & 0x01));
+        msg.data[3] = static_cast<uint8_t>(y >> 4);
+        msg.data[4] = type;
+    }
+};
+
+int RunBench(const Args &args)
+{
+    uint64_t frames = args.operand ? std::strtoull(args.operand, nullptr, 10) : 2000000;
+
+    SimOptions options;
+    options.record_reports = false;
+
+    Simulator sim(Simulator::DefaultConfig(), options);
+    if (!sim.BringUp(args.detection_id)) {
+        std::fprintf(stderr, "controller did not become ready\n");
+        return 1;
+    }
+
+    TrafficGenerator traffic(sim.NowUs());
+    uint64_t         start_virtual = sim.NowUs();
+    uint64_t         start_reports = sim.HidPort().ReportCount();
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < frames; ++i) {
+        sim.Feed(traffic.Next());
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double wall_s    = std::chrono::duration<double>(end - start).count();
+    double virtual_s = (sim.NowUs() - start_virtual) / 1e6;
+
+    PrintThroughput(stdout, frames, sim.HidPort().ReportCount() - start_reports, virtual_s,
+                    wall_s);
+    std::fflush(stdout);
+
+    PrintStats(sim);
+    return 0;
+}
+
+// =============================================================================
+// Trace Decode
+// =============================================================================
+
+int RunDecode(const Args &args)
+{
+    FILE *in = args.operand ? std::fopen(args.operand, "r") : stdin;
+    if (!in) {
+        std::perror(args.operand);
+        return 1;
+    }
+
+    std::vector<idrive::sim::TraceFrame> frames;
+    idrive::sim::TraceDumpInfo           info = idrive::sim::ReadTraceDumps(in, frames);
+    if (in != stdin) {
+        std::fclose(in);
+    }
+
+    if (args.asc) {
+        std::printf("%s\n", idrive::sim::AscHeader());
+    }
+
+    uint64_t base_us = frames.empty() ? 0 : frames.front().msg.timestamp_us;
+    char     line[128];
+    for (const auto &frame : frames) {
+        if (args.rx_only && frame.tx) {
+            continue;
+        }
+        if (args.asc) {
+            idrive::sim::FormatAscLine(frame.msg, frame.tx, base_us, line, sizeof(line));
+        } else {
+            idrive::sim::FormatCandumpLine(frame.msg, "can0", line, sizeof(line));
+        }
+        std::printf("%s\n", line);
+    }
+
+    if (args.asc) {
+        std::printf("%s\n", idrive::sim::AscFooter());
+    }
+    std::fflush(stdout);
+
+    std::fprintf(stderr, "dumps: %zu (%zu incomplete), frames: %zu, overwritten before dump: %lu\n",
+                 info.dumps, info.truncated, info.records,
+                 static_cast<unsigned long>(info.overwritten));
+    return info.dumps > 0 ? 0 : 1;
+}
+
+}  // namespace
+
+int main(int argc, char **argv)
+{
+    Args args;
+    if (!ParseArgs(argc, argv, args)) {
+        return Usage();
+    }
+    idrive::sim::SetLogLevel(args.log_level);
+
+    if (std::strcmp(args.mode, "replay") == 0) {
+        return RunReplay(args);
+    }
+    if (std::strcmp(args.mode, "bench") == 0) {
+        return RunBench(args);
+    }
+    if (std::strcmp(args.mode, "decode") == 0) {
+        return RunDecode(args);
+    }
+    if (std::strcmp(args.mode, "accel") == 0) {
+        return idrive::sim::RunAccel(args);
+    }
+    if (std::strcmp(args.mode, "drag") == 0) {
+        return idrive::sim::RunDrag(args);
+    }
+    if (std::strcmp(args.mode, "filter") == 0) {
+        return idrive::sim::RunFilter(args);
+    }
+    if (std::strcmp(args.mode, "swipe") == 0) {
+        return idrive::sim::RunSwipe(args);
+    }
+    if (std::strcmp(args.mode, "pinch") == 0) {
+        return idrive::sim::RunPinch(args);
+    }
+    if (std::strcmp(args.mode, "tap") == 0) {
+        return idrive::sim::RunTap(args);
+    }
+    if (std::strcmp(args.mode, "digitizer") == 0) {
+        return idrive::sim::RunDigitizer(args);
+    }
+    if (std::strcmp(args.mode, "mouse") == 0) {
+        return idrive::sim::RunMouse(args);
+    }
+    if (std::strcmp(args.mode, "rotary") == 0) {
+        return idrive::sim::RunRotary(args);
+    }
+    if (std::strcmp(args.mode, "joystick") == 0) {
+        return idrive::sim::RunJoystick(args);
+    }
+    if (std::strcmp(args.mode, "buttons") == 0) {
+        return idrive::sim::RunButtons(args);
+    }
+    if (std::strcmp(args.mode, "sched") == 0) {
+        return idrive::sim::RunSched(args);
+    }
+    if (std::strcmp(args.mode, "ring") == 0) {
+        return idrive::sim::RunRing(args);
+    }
+    if (std::strcmp(args.mode, "dispatch") == 0) {
+        return idrive::sim::RunDispatch(args);
+    }
+    if (std::strcmp(args.mode, "taps") == 0) {
+        return idrive::sim::RunTaps(args);
+    }
+    return Usage();
+}
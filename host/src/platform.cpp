@@ -0,0 +1,91 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+//
+// Host implementation of the platform functions in utils.h and of the
+// logging HAL declared in the host esp_log.h.
+
+#include <cstdarg>
+#include <cstdio>
+#include <functional>
+#include <thread>
+
+#include "esp_log.h"
+#include "sim/sim_clock.h"
+#include "utils/utils.h"
+
+namespace idrive {
+
+namespace {
+uint64_t        g_now_us    = 0;
+esp_log_level_t g_log_level = ESP_LOG_WARN;
+}  // namespace
+
+// =============================================================================
+// Virtual Clock
+// =============================================================================
+
+namespace sim {
+
+void SetTimeUs(uint64_t now_us)
+{
+    g_now_us = now_us;
+}
+
+uint64_t TimeUs()
+{
+    return g_now_us;
+}
+
+}  // namespace sim
+
+namespace utils {
+
+uint32_t GetMillis()
+{
+    return static_cast<uint32_t>(g_now_us / 1000ULL);
+}
+
+uint64_t GetMicros()
+{
+    return g_now_us;
+}
+
+uintptr_t CurrentTaskId()
+{
+    return std::hash<std::thread::id>()(std::this_thread::get_id()) | 1u;
+}
+
+}  // namespace utils
+
+// =============================================================================
+// Logging
+// =============================================================================
+
+namespace sim {
+
+void SetLogLevel(esp_log_level_t level)
+{
+    g_log_level = level;
+}
+
+bool LogEnabled(esp_log_level_t level)
+{
+    return level != ESP_LOG_NONE && level <= g_log_level;
+}
+
+void Log(esp_log_level_t level, const char *tag, const char *format, ...)
+{
+    static const char kLevels[] = "NEWIDV";
+
+    std::fprintf(stderr, "%c (%llu) %s: ", kLevels[level],
+                 static_cast<unsigned long long>(g_now_us / 1000ULL), tag);
+    va_list args;
+    va_start(args, format);
+    std::vfprintf(stderr, format, args);
+    va_end(args);
+    std::fputc('\n', stderr);
+}
+
+}  // namespace sim
+
+}  // namespace idrive
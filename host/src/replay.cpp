@@ -0,0 +1,146 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+
+#include "sim/replay.h"
+
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+namespace idrive::sim {
+
+namespace {
+
+const char *ReportName(uint8_t report_id)
+{
+    switch (report_id) {
+        case kReportIdKeyboard:  return "keyboard";
+        case kReportIdMouse:     return "mouse";
+        case kReportIdConsumer:  return "consumer";
+        case kReportIdDigitizer: return "touch";
+    }
+    return "unknown";
+}
+
+// Hand over and forget the reports polled so far.
+uint64_t DrainReports(Simulator &sim, const ReportSink &sink)
+{
+    auto    &reports = sim.HidPort().Reports();
+    uint64_t count   = reports.size();
+    if (sink) {
+        for (const HidReportRecord &report : reports) {
+            sink(report);
+        }
+    }
+    sim.HidPort().ClearReports();
+    return count;
+}
+
+void StripNewline(char *line)
+{
+    line[std::strcspn(line, "\r\n")] = '\0';
+}
+
+}  // namespace
+
+ReplayResult Replay(Simulator &sim, CanLogReader &reader, const ReplayOptions &options,
+                    const ReportSink &sink)
+{
+    using Clock = std::chrono::steady_clock;
+
+    ReplayResult result;
+    DrainReports(sim, nullptr);  // Bring-up output is not part of the replay
+
+    uint64_t          start_virtual = sim.NowUs();
+    uint64_t          first_us      = 0;
+    uint64_t          offset        = 0;
+    Clock::time_point start         = Clock::now();
+
+    CanMessage msg;
+    while (reader.Next(msg)) {
+        // Log timestamps are absolute; start the trace just after bring-up.
+        if (result.frames == 0) {
+            first_us = msg.timestamp_us;
+            offset   = start_virtual + options.start_offset_us - first_us;
+        }
+        if (msg.timestamp_us < first_us) {
+            msg.timestamp_us = first_us;  // Out-of-order line; deliver it right away
+        }
+
+        if (options.speed > 0.0) {
+            std::chrono::duration<double, std::micro> due((msg.timestamp_us - first_us) /
+                                                          options.speed);
+            std::this_thread::sleep_until(start +
+                                          std::chrono::duration_cast<Clock::duration>(due));
+        }
+
+        msg.timestamp_us += offset;
+        sim.Feed(msg);
+        result.frames++;
+        result.reports += DrainReports(sim, sink);
+    }
+
+    // Let pending reports and tap releases drain.
+    sim.AdvanceTo(sim.NowUs() + options.drain_us);
+    result.reports += DrainReports(sim, sink);
+
+    result.wall_s = std::chrono::duration<double>(Clock::now() - start).count();
+    result.bus_s  = (sim.NowUs() - start_virtual) / 1e6;
+    return result;
+}
+
+int FormatReportLine(const HidReportRecord &report, char *out, size_t size)
+{
+    int n = std::snprintf(out, size, "%llu %s", static_cast<unsigned long long>(report.time_us),
+                          ReportName(report.report_id));
+    for (uint8_t i = 0; i < report.len && n >= 0 && static_cast<size_t>(n) < size; ++i) {
+        n += std::snprintf(out + n, size - n, " %02X", report.data[i]);
+    }
+    return n;
+}
+
+// =============================================================================
+// Golden Diff
+// =============================================================================
+
+void GoldenDiff::Check(const char *line)
+{
+    lines_++;
+
+    char expected[256];
+    if (!std::fgets(expected, sizeof(expected), golden_)) {
+        Report(nullptr, line);
+        return;
+    }
+    StripNewline(expected);
+    if (std::strcmp(expected, line) != 0) {
+        Report(expected, line);
+    }
+}
+
+bool GoldenDiff::Finish()
+{
+    char expected[256];
+    while (std::fgets(expected, sizeof(expected), golden_)) {
+        lines_++;
+        StripNewline(expected);
+        Report(expected, nullptr);
+    }
+    if (mismatches_ > kMaxShown) {
+        std::fprintf(stderr, "golden: ... %llu more mismatches\n",
+                     static_cast<unsigned long long>(mismatches_ - kMaxShown));
+    }
+    return mismatches_ == 0;
+}
+
+void GoldenDiff::Report(const char *expected, const char *actual)
+{
+    if (++mismatches_ > kMaxShown) {
+        return;
+    }
+    std::fprintf(stderr, "golden line %llu:\n  expected: %s\n  actual:   %s\n",
+                 static_cast<unsigned long long>(lines_), expected ? expected : "<end of file>",
+                 actual ? actual : "<end of output>");
+}
+
+}  // namespace idrive::sim
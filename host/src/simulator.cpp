@@ -0,0 +1,111 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+
+#include "sim/simulator.h"
+
+#include <algorithm>
+
+#include "sim/sim_clock.h"
+
+namespace idrive::sim {
+
+Simulator::Simulator(const Config &config, const SimOptions &options)
+    : options_(options), controller_(can_, hid_, scheduler_, config)
+{
+    SetTimeUs(0);
+    hid_port_.Record(options_.record_reports);
+    can_.RecordTx(options_.record_tx);
+    hid_.Attach(hid_port_);
+}
+
+Config Simulator::DefaultConfig()
+{
+    // Same settings as app_main.
+    return Config {
+        .joystick_as_mouse        = false,
+        .light_brightness         = 255,
+        .poll_interval_ms         = config::kPollIntervalMs,
+        .light_keepalive_ms       = config::kLightKeepaliveMs,
+        .min_mouse_travel         = config::kMinMouseTravel,
+        .joystick_move_step       = config::kJoystickMoveStep,
+        .joystick_repeat_delay_ms = config::kJoystickRepeatDelayMs,
+        .joystick_repeat_rate_hz  = config::kJoystickRepeatRateHz,
+        .pointer_accel            = PointerAccelProfile::MacOs,
+        .rotary_accel             = RotaryAccelProfile::Moderate,
+        .pinch_mode               = PinchMode::CtrlWheel,
+        .tap_mode                 = TapMode::Deferred,
+    };
+}
+
+bool Simulator::BringUp(uint32_t detection_id)
+{
+    hid_port_.SetMounted(true);
+    hid_.OnMount();
+    controller_.Init();
+
+    next_usb_poll_ = now_us_ + options_.usb_poll_interval_us;
+    next_update_   = now_us_ + options_.main_loop_interval_us;
+
+    CanMessage detect;
+    detect.id           = detection_id;
+    detect.length       = 8;
+    detect.timestamp_us = now_us_ + 1000;
+    Feed(detect);
+
+    // Protocol ready -> touchpad init -> cooldown -> ready.
+    AdvanceTo(now_us_ + (config::kControllerCooldownMs + 500) * 1000ULL);
+    return controller_.IsReady();
+}
+
+void Simulator::Feed(const CanMessage &msg)
+{
+    if (msg.timestamp_us > now_us_) {
+        AdvanceTo(msg.timestamp_us);
+    }
+
+    CanMessage stamped   = msg;
+    stamped.timestamp_us = now_us_;
+    can_.Deliver(stamped);
+    frames_fed_++;
+}
+
+void Simulator::AdvanceTo(uint64_t t_us)
+{
+    while (true) {
+        uint64_t next = std::min({t_us, scheduler_.NextDeadline(), hid_port_.WakeupUs(),
+                                  next_usb_poll_, next_update_});
+        if (next > now_us_) {
+            // Frames fed at one instant are one burst, as if the dispatch
+            // task found them all queued when it woke up.
+            can_.EndBurst();
+            now_us_ = next;
+            SetTimeUs(now_us_);
+        }
+
+        // Same work the device tasks would do at this instant.
+        if (hid_port_.WakeupUs() <= now_us_) {
+            hid_port_.ClearWakeup();
+            hid_.ServiceReleases(now_us_);
+        }
+        if (scheduler_.NextDeadline() <= now_us_) {
+            scheduler_.RunDue(now_us_);
+        }
+        if (next_usb_poll_ <= now_us_) {
+            if (hid_port_.Poll(now_us_)) {
+                hid_.OnReportComplete();
+            }
+            hid_.FlushPending();
+            next_usb_poll_ += options_.usb_poll_interval_us;
+        }
+        if (next_update_ <= now_us_) {
+            controller_.Update();
+            next_update_ += options_.main_loop_interval_us;
+        }
+
+        if (now_us_ >= t_us) {
+            break;
+        }
+    }
+}
+
+}  // namespace idrive::sim
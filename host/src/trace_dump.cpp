@@ -0,0 +1,104 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+
+#include "sim/trace_dump.h"
+
+#include <cstring>
+
+#include "can/can_trace.h"
+
+namespace idrive::sim {
+
+namespace {
+
+constexpr const char *kMarker = "CANTRACE ";
+
+int HexDigit(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Decode one dump's record stream. Returns false if it did not decode cleanly.
+bool DecodeDump(const std::vector<uint8_t> &bytes, uint64_t start_us, size_t expected_records,
+                std::vector<TraceFrame> &frames, size_t &records)
+{
+    uint64_t time_us = start_us;
+    size_t   pos     = 0;
+    size_t   decoded = 0;
+
+    while (pos < bytes.size()) {
+        TraceFrame frame;
+        uint64_t   delta_us = 0;
+        size_t     size     = can_trace::DecodeRecord(bytes.data() + pos, bytes.size() - pos,
+                                                      delta_us, frame.msg, frame.tx);
+        if (size == 0) {
+            break;
+        }
+        if (decoded > 0) {
+            time_us += delta_us;
+        }
+        frame.msg.timestamp_us = time_us;
+        frames.push_back(frame);
+        pos += size;
+        decoded++;
+    }
+
+    records += decoded;
+    return pos == bytes.size() && decoded == expected_records;
+}
+
+}  // namespace
+
+TraceDumpInfo ReadTraceDumps(std::FILE *in, std::vector<TraceFrame> &frames)
+{
+    TraceDumpInfo        info;
+    std::vector<uint8_t> bytes;
+    bool                 in_dump          = false;
+    unsigned long long   start_us         = 0;
+    unsigned long        expected_bytes   = 0;
+    unsigned long        expected_records = 0;
+    unsigned long        overwritten      = 0;
+
+    char line[512];
+    while (std::fgets(line, sizeof(line), in)) {
+        const char *p = std::strstr(line, kMarker);
+        if (!p) {
+            continue;
+        }
+        p += std::strlen(kMarker);
+
+        if (std::strncmp(p, "begin", 5) == 0) {
+            if (in_dump) {
+                info.truncated++;  // Previous dump never ended
+            }
+            in_dump = std::sscanf(p, "begin start_us=%llu bytes=%lu records=%lu overwritten=%lu",
+                                  &start_us, &expected_bytes, &expected_records,
+                                  &overwritten) == 4;
+            bytes.clear();
+        } else if (in_dump && std::strncmp(p, "data ", 5) == 0) {
+            for (p += 5; HexDigit(p[0]) >= 0 && HexDigit(p[1]) >= 0; p += 2) {
+                bytes.push_back(static_cast<uint8_t>((HexDigit(p[0]) << 4) | HexDigit(p[1])));
+            }
+        } else if (in_dump && std::strncmp(p, "end", 3) == 0) {
+            // Decode what there is even if lines were lost on the console.
+            bool clean = DecodeDump(bytes, start_us, expected_records, frames, info.records) &&
+                         bytes.size() == expected_bytes;
+            if (!clean) {
+                info.truncated++;
+            }
+            info.dumps++;
+            info.overwritten += static_cast<uint32_t>(overwritten);
+            in_dump = false;
+        }
+    }
+
+    if (in_dump) {
+        info.truncated++;
+    }
+    return info;
+}
+
+}  // namespace idrive::sim
@@ -5,59 +5,115 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 
 #include "driver/gpio.h"
 
+#include "can/can_filter.h"
+#include "can/can_message.h"
+#include "can/can_port.h"
+#include "can/can_trace.h"
+#include "utils/spsc_ring.h"
+
 namespace idrive {
 
 // =============================================================================
-// CAN Message Structure
+// CAN Bus Configuration
 // =============================================================================
 
-struct CanMessage {
-    uint32_t id       = 0;
-    uint8_t  data[8]  = {0};
-    uint8_t  length   = 0;
-    bool     extended = false;
+namespace can_bus_config {
+
+constexpr size_t kRxRingSize = 64;  // Frames buffered between RX and dispatch
+
+// CAN trace ring in internal RAM (no PSRAM on this board). At ~13 bytes per
+// 8-byte frame this holds roughly the last 1200 frames.
+constexpr size_t kTraceBytes = 16 * 1024;
+
+}  // namespace can_bus_config
+
+using CanTrace = CanTraceBuffer<can_bus_config::kTraceBytes>;
+
+// RX ring statistics.
+struct CanRxStats {
+    uint32_t received   = 0;  // Frames queued for dispatch
+    uint32_t filtered   = 0;  // Frames past the hardware filter but not wanted
+    uint32_t overruns   = 0;  // Frames dropped because the ring was full
+    uint32_t high_water = 0;  // Highest ring fill level seen
+    uint32_t capacity   = 0;  // Ring capacity
 };
 
 // =============================================================================
 // CAN Bus Class
 // =============================================================================
 
-class CanBus {
+class CanBus : public CanPort {
    public:
-    using MessageCallback = std::function<void(const CanMessage &)>;
-
     // Constructor with configurable pins.
     CanBus(gpio_num_t rx_pin = GPIO_NUM_4, gpio_num_t tx_pin = GPIO_NUM_5);
 
+    // Restrict reception to a set of standard IDs. Call before Init().
+    // Init() programs the tightest TWAI code/mask for the set; frames the
+    // mask cannot exclude are dropped in software before reaching the ring.
+    // An empty set (the default) accepts everything.
+    void SetAcceptedIds(const CanIdSet &ids) { accepted_ids_ = ids; }
+
     // Initialize the CAN bus at specified baudrate.
     bool Init(uint32_t baudrate = 500000);
 
     // Send a CAN message.
-    bool Send(uint32_t id, const uint8_t *data, uint8_t length, bool extended = false);
+    bool Send(uint32_t id, const uint8_t *data, uint8_t length, bool extended = false) override;
 
     // Send a CAN message using CanMessage struct.
     bool Send(const CanMessage &message);
 
     // Set callback for received messages.
-    void SetCallback(MessageCallback callback);
+    // The callback runs from DispatchPending(), never from the RX path.
+    void SetCallback(MessageCallback callback) override;
+    void SetBurstEndCallback(BurstEndCallback callback) override;
 
-    // Process CAN bus alerts and receive messages.
-    // Call this regularly in the main loop.
+    // Process CAN bus alerts and move received frames into the RX ring.
+    // Never blocks on message handling. Call from the RX task only.
     void ProcessAlerts();
 
+    // Pop queued frames and deliver them to the callback, then signal the end
+    // of the burst. Returns the number of frames delivered. Call from the
+    // dispatch task only.
+    size_t DispatchPending();
+
+    // Check if received frames are waiting for dispatch.
+    bool HasPendingMessages() const { return !rx_ring_.Empty(); }
+
+    // RX ring statistics.
+    CanRxStats GetRxStats() const;
+
+    // Acceptance filter programmed by Init().
+    const CanAcceptanceFilter &GetFilter() const { return filter_; }
+
     // Check if CAN bus is initialized.
     bool IsInitialized() const { return initialized_; }
 
+    // Trace of recent RX/TX frames (config::kCanTrace).
+    CanTrace       &GetTrace() { return trace_; }
+    const CanTrace &GetTrace() const { return trace_; }
+
+    // Freeze the trace after the post-trigger window. Safe from any task.
+    void TriggerTrace(const char *reason);
+
    private:
-    gpio_num_t      rx_pin_;
-    gpio_num_t      tx_pin_;
-    MessageCallback callback_;
-    bool            initialized_ = false;
+    gpio_num_t       rx_pin_;
+    gpio_num_t       tx_pin_;
+    MessageCallback  callback_;
+    BurstEndCallback burst_end_;
+    bool             initialized_ = false;
+
+    CanIdSet            accepted_ids_;
+    CanAcceptanceFilter filter_;
+    uint32_t            filtered_count_ = 0;
+
+    utils::SpscRing<CanMessage, can_bus_config::kRxRingSize> rx_ring_;
+    CanTrace                                                  trace_;
 
     void HandleAlerts(uint32_t alerts);
     void ReceiveMessages();
@@ -0,0 +1,75 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+//
+// TWAI acceptance filter computation for a set of wanted 11-bit CAN IDs.
+// The TWAI controller can match either one code/mask pair (single filter
+// mode) or two ID-only code/mask pairs (dual filter mode). A mask can only
+// describe a power-of-two "cube" of IDs, so some unwanted IDs may still pass;
+// the CanIdSet bitmap doubles as the exact software check for those.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace idrive {
+
+constexpr uint32_t kCanStdIdCount = 0x800;  // 11-bit identifier space
+constexpr uint32_t kCanStdIdMask  = 0x7FF;
+
+// =============================================================================
+// CAN ID Set (2048-bit bitmap)
+// =============================================================================
+
+class CanIdSet {
+   public:
+    void Add(uint32_t id)
+    {
+        if (id <= kCanStdIdMask) {
+            words_[id >> 5] |= 1u << (id & 31);
+        }
+    }
+
+    bool Contains(uint32_t id) const
+    {
+        return id <= kCanStdIdMask && (words_[id >> 5] & (1u << (id & 31))) != 0;
+    }
+
+    bool   Empty() const { return Count() == 0; }
+    size_t Count() const;
+
+    // Copy up to max_ids IDs in ascending order. Returns the number written.
+    size_t ToArray(uint16_t *ids, size_t max_ids) const;
+
+   private:
+    uint32_t words_[kCanStdIdCount / 32] = {0};
+};
+
+// =============================================================================
+// Acceptance Filter
+// =============================================================================
+
+struct CanAcceptanceFilter {
+    uint32_t acceptance_code = 0;           // twai_filter_config_t::acceptance_code
+    uint32_t acceptance_mask = 0xFFFFFFFF;  // twai_filter_config_t::acceptance_mask
+    bool     single_filter   = true;        // twai_filter_config_t::single_filter
+    bool     accept_all      = true;        // No ID set given: filter disabled
+
+    uint32_t wanted_ids   = 0;               // IDs in the requested set
+    uint32_t accepted_ids = kCanStdIdCount;  // Standard IDs the hardware lets through
+
+    // Fraction of hardware-accepted IDs that are not wanted (0.0 = exact fit).
+    float FalseAcceptRate() const
+    {
+        return accepted_ids ? static_cast<float>(accepted_ids - wanted_ids) / accepted_ids : 0.0f;
+    }
+
+    // Whether an ID passes the hardware code/mask (standard frames).
+    bool HardwareAccepts(uint32_t id) const;
+};
+
+// Compute the tightest single- or dual-filter configuration for the set.
+// An empty set yields an accept-all filter.
+CanAcceptanceFilter ComputeAcceptanceFilter(const CanIdSet &ids);
+
+}  // namespace idrive
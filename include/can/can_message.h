@@ -0,0 +1,20 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+//
+// CAN frame as seen by the rest of the firmware (no driver dependencies).
+
+#pragma once
+
+#include <cstdint>
+
+namespace idrive {
+
+struct CanMessage {
+    uint32_t id           = 0;
+    uint8_t  data[8]      = {0};
+    uint8_t  length       = 0;
+    bool     extended     = false;
+    uint64_t timestamp_us = 0;  // esp_timer time when the frame was read from the driver
+};
+
+}  // namespace idrive
@@ -0,0 +1,35 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+//
+// CAN port interface used by IDriveController.
+// CanBus implements it on top of the TWAI driver; the host simulator provides
+// an in-memory implementation so the input pipeline runs without hardware.
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+#include "can/can_message.h"
+
+namespace idrive {
+
+class CanPort {
+   public:
+    using MessageCallback  = std::function<void(const CanMessage &)>;
+    using BurstEndCallback = std::function<void()>;
+
+    virtual ~CanPort() = default;
+
+    // Transmit a frame. Returns false if it could not be queued.
+    virtual bool Send(uint32_t id, const uint8_t *data, uint8_t length, bool extended = false) = 0;
+
+    // Set the receiver for incoming frames.
+    virtual void SetCallback(MessageCallback callback) = 0;
+
+    // Called after the last frame of a burst (everything that was waiting
+    // when delivery started) has gone to the message callback.
+    virtual void SetBurstEndCallback(BurstEndCallback callback) = 0;
+};
+
+}  // namespace idrive
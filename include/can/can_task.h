@@ -3,6 +3,8 @@
 //
 // Event-driven CAN task with proper core affinity.
 // Uses FreeRTOS task notifications for low-latency message handling.
+// RX drains the TWAI driver into the CanBus RX ring; a separate, lower
+// priority dispatch task decodes the frames so RX never waits on handlers.
 
 #pragma once
 
@@ -21,10 +23,12 @@ namespace idrive {
 
 namespace can_task_config {
 
-constexpr BaseType_t  kCoreId    = 1;     // Run on APP_CPU (Core 1)
-constexpr UBaseType_t kPriority  = 10;    // High priority for real-time
-constexpr uint32_t    kStackSize = 4096;  // Stack size in bytes
-constexpr uint32_t    kTimeoutMs = 100;   // Timeout for periodic tasks
+constexpr BaseType_t  kCoreId            = 1;     // Run on APP_CPU (Core 1)
+constexpr UBaseType_t kPriority          = 10;    // High priority for real-time
+constexpr uint32_t    kStackSize         = 4096;  // Stack size in bytes
+constexpr uint32_t    kTimeoutMs         = 100;   // Timeout for periodic tasks
+constexpr UBaseType_t kDispatchPriority  = 8;     // Below RX and the TX scheduler
+constexpr uint32_t    kDispatchStackSize = 4096;  // Dispatch runs handlers and USB
 
 }  // namespace can_task_config
 
@@ -37,11 +41,11 @@ class CanTask {
     explicit CanTask(CanBus &can);
     ~CanTask();
 
-    // Start the CAN task on specified core.
+    // Start the CAN RX and dispatch tasks on specified core.
     bool Start(BaseType_t  core_id  = can_task_config::kCoreId,
                UBaseType_t priority = can_task_config::kPriority);
 
-    // Stop the CAN task.
+    // Stop the CAN RX and dispatch tasks.
     void Stop();
 
     // Check if task is running.
@@ -58,11 +62,14 @@ class CanTask {
 
    private:
     static void TaskFunction(void *arg);
+    static void DispatchTaskFunction(void *arg);
     void        Run();
+    void        RunDispatch();
 
     CanBus       &can_;
-    TaskHandle_t  task_handle_ = nullptr;
-    volatile bool running_     = false;
+    TaskHandle_t  task_handle_     = nullptr;
+    TaskHandle_t  dispatch_handle_ = nullptr;
+    volatile bool running_         = false;
 
     static CanTask *instance_;
 };
@@ -0,0 +1,252 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+//
+// Binary CAN trace (flight recorder) of recent RX/TX frames.
+// Frames are appended to a fixed byte ring as variable-length records. When
+// the ring is full the oldest records are dropped, so it always holds the
+// most recent traffic. A trigger freezes it (after an optional post-trigger
+// window) so it can be dumped to the console and decoded on the host.
+//
+// Record layout (little endian):
+//   [flags] [delta_us: LEB128] [id: 2 bytes, 4 if extended] [data: DLC bytes]
+//   flags: bit 7 = TX, bit 6 = extended ID, bits 0-3 = DLC
+// delta_us is the time since the previous record. The first record of a dump
+// is at the dump's start time; its own delta is ignored.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+
+#include "can/can_message.h"
+
+namespace idrive {
+
+namespace can_trace {
+
+constexpr uint8_t kFlagTx         = 0x80;
+constexpr uint8_t kFlagExtended   = 0x40;
+constexpr uint8_t kDlcMask        = 0x0F;
+constexpr size_t  kMaxRecordBytes = 1 + 10 + 4 + 8;
+
+// Bytes of record data per dump line.
+constexpr size_t kDumpLineBytes = 32;
+
+// Record data Dump() copies out per lock; printed after unlocking.
+constexpr size_t kDumpCopyBytes = 8 * kDumpLineBytes;
+
+// Encode one record into out (kMaxRecordBytes long). Returns its size.
+size_t EncodeRecord(const CanMessage &msg, bool tx, uint64_t delta_us, uint8_t *out);
+
+// Decode one record. Returns the bytes consumed, or 0 if it is truncated or
+// malformed. msg.timestamp_us is left untouched.
+size_t DecodeRecord(const uint8_t *data, size_t len, uint64_t &delta_us, CanMessage &msg,
+                    bool &tx);
+
+}  // namespace can_trace
+
+struct CanTraceStats {
+    uint32_t recorded    = 0;  // Frames written to the trace
+    uint32_t overwritten = 0;  // Oldest frames dropped to make room
+    uint32_t discarded   = 0;  // Frames not recorded because the trace was frozen
+    uint32_t records     = 0;  // Frames currently held
+    uint32_t bytes       = 0;  // Bytes currently held
+    uint32_t capacity    = 0;  // Ring size in bytes
+};
+
+template <size_t N>
+class CanTraceBuffer {
+    static_assert(N >= 64 && (N & (N - 1)) == 0, "CanTraceBuffer size must be a power of two");
+
+   public:
+    // Append a frame stamped with msg.timestamp_us. Safe from any task. A
+    // frozen trace turns frames away without taking the lock, so CAN RX never
+    // waits on a dump.
+    void Record(const CanMessage &msg, bool tx)
+    {
+        uint64_t time_us = msg.timestamp_us;
+        if (triggered_.load(std::memory_order_acquire) && time_us >= freeze_at_us_) {
+            discarded_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        // RX and TX are stamped on different tasks; keep the stream monotonic.
+        if (records_ > 0 && time_us < last_us_) {
+            time_us = last_us_;
+        }
+
+        uint8_t record[can_trace::kMaxRecordBytes];
+        size_t  size =
+            can_trace::EncodeRecord(msg, tx, records_ > 0 ? time_us - last_us_ : 0, record);
+
+        while (N - (head_ - tail_) < size) {
+            DropOldest();
+        }
+        if (records_ == 0) {
+            start_us_ = time_us;
+        }
+
+        for (size_t i = 0; i < size; ++i) {
+            buffer_[(head_ + i) & kMask] = record[i];
+        }
+        head_ += static_cast<uint32_t>(size);
+        last_us_ = time_us;
+        records_++;
+        stats_.recorded++;
+    }
+
+    // Freeze the trace post_trigger_us after now_us, so it also shows what
+    // happened just after the event. Ignored while a trigger is pending.
+    void Trigger(uint64_t now_us, uint32_t post_trigger_us)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!triggered_.load(std::memory_order_relaxed)) {
+            freeze_at_us_ = now_us + post_trigger_us;
+            triggered_.store(true, std::memory_order_release);
+        }
+    }
+
+    bool IsTriggered() const { return triggered_.load(std::memory_order_acquire); }
+
+    // True once the post-trigger window has passed; the contents are then stable.
+    bool IsFrozen(uint64_t now_us) const
+    {
+        return triggered_.load(std::memory_order_acquire) && now_us >= freeze_at_us_;
+    }
+
+    // Drop the contents and resume recording.
+    void Clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        head_ = tail_ = 0;
+        records_      = 0;
+        triggered_.store(false, std::memory_order_release);
+    }
+
+    CanTraceStats GetStats() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        CanTraceStats stats = stats_;
+        stats.discarded     = discarded_.load(std::memory_order_relaxed);
+        stats.records       = records_;
+        stats.bytes         = head_ - tail_;
+        stats.capacity      = N;
+        return stats;
+    }
+
+    // Print the held records as CANTRACE console lines, at most max_bytes of
+    // record data per call starting at byte `offset` of the stream (0 first).
+    // Returns the offset to continue from; done once it equals the held size.
+    // Only meaningful on a frozen trace. The lock is held only to copy the
+    // bytes out, never while printing to a slow console.
+    size_t Dump(size_t offset, size_t max_bytes) const
+    {
+        uint8_t  copy[can_trace::kDumpCopyBytes];
+        size_t   used        = 0;
+        uint32_t records     = 0;
+        uint32_t overwritten = 0;
+        uint64_t start_us    = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            used        = head_ - tail_;
+            records     = records_;
+            overwritten = stats_.overwritten;
+            start_us    = start_us_;
+        }
+
+        if (offset == 0) {
+            printf("CANTRACE begin start_us=%llu bytes=%lu records=%lu overwritten=%lu\n",
+                   static_cast<unsigned long long>(start_us), static_cast<unsigned long>(used),
+                   static_cast<unsigned long>(records), static_cast<unsigned long>(overwritten));
+        }
+
+        size_t end = offset + max_bytes < used ? offset + max_bytes : used;
+        while (offset < end) {
+            size_t size = end - offset < sizeof(copy) ? end - offset : sizeof(copy);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                for (size_t i = 0; i < size; ++i) {
+                    copy[i] = buffer_[(tail_ + offset + i) & kMask];
+                }
+            }
+
+            for (size_t pos = 0; pos < size; pos += can_trace::kDumpLineBytes) {
+                size_t line = size - pos < can_trace::kDumpLineBytes ? size - pos
+                                                                     : can_trace::kDumpLineBytes;
+                printf("CANTRACE data ");
+                for (size_t i = 0; i < line; ++i) {
+                    printf("%02X", copy[pos + i]);
+                }
+                printf("\n");
+            }
+            offset += size;
+        }
+
+        if (offset >= used) {
+            printf("CANTRACE end\n");
+        }
+        return offset;
+    }
+
+   private:
+    static constexpr uint32_t kMask = N - 1;
+
+    mutable std::mutex    mutex_;
+    uint8_t               buffer_[N] = {};
+    uint32_t              head_      = 0;  // Free-running write index
+    uint32_t              tail_      = 0;  // Free-running index of the oldest record
+    uint32_t              records_   = 0;
+    uint64_t              start_us_  = 0;  // Time of the oldest record
+    uint64_t              last_us_   = 0;  // Time of the newest record
+    CanTraceStats         stats_;
+    std::atomic<uint32_t> discarded_ {0};
+
+    // Read without the lock: freeze_at_us_ is set before triggered_ is
+    // published and stays put until Clear().
+    std::atomic<bool> triggered_ {false};
+    uint64_t          freeze_at_us_ = 0;
+
+    // Remove the oldest record and move the start time to the next one.
+    void DropOldest()
+    {
+        uint8_t    record[can_trace::kMaxRecordBytes];
+        uint64_t   delta_us = 0;
+        CanMessage msg;
+        bool       tx = false;
+
+        size_t size = can_trace::DecodeRecord(record, Peek(tail_, record), delta_us, msg, tx);
+        if (size == 0) {
+            // Cannot happen with records written by Record(); start over.
+            tail_    = head_;
+            records_ = 0;
+            return;
+        }
+        tail_ += static_cast<uint32_t>(size);
+        records_--;
+        stats_.overwritten++;
+
+        if (records_ > 0) {
+            can_trace::DecodeRecord(record, Peek(tail_, record), delta_us, msg, tx);
+            start_us_ += delta_us;
+        }
+    }
+
+    // Copy up to one record's worth of bytes starting at pos.
+    size_t Peek(uint32_t pos, uint8_t *out) const
+    {
+        size_t available = head_ - pos;
+        size_t size      = available < can_trace::kMaxRecordBytes ? available
+                                                                  : can_trace::kMaxRecordBytes;
+        for (size_t i = 0; i < size; ++i) {
+            out[i] = buffer_[(pos + i) & kMask];
+        }
+        return size;
+    }
+};
+
+}  // namespace idrive
@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 
 namespace idrive {
@@ -13,13 +14,54 @@ namespace idrive {
 // Runtime Configuration
 // =============================================================================
 
+// Touchpad pointer acceleration curve (see input/pointer_accel.h).
+enum class PointerAccelProfile : uint8_t {
+    Linear,   // Constant gain
+    MacOs,    // Smooth curve, slow moves slowed down
+    Windows,  // "Enhance pointer precision" style knee
+};
+
+// Rotary knob acceleration curve (see input/rotary_accel.h).
+enum class RotaryAccelProfile : uint8_t {
+    Off,       // One wheel detent per knob detent
+    Moderate,  // Unity up to 10 detents/s, 4x from 60 detents/s
+    Fast,      // Unity up to 10 detents/s, 10x from 80 detents/s (long lists)
+};
+
+// What a two-finger pinch sends (see TouchpadHandler).
+enum class PinchMode : uint8_t {
+    Off,           // Two fingers only scroll
+    CtrlWheel,     // Ctrl held + wheel detents (browsers, maps, desktop apps)
+    ConsumerZoom,  // AC Zoom In / AC Zoom Out consumer usages
+};
+
+// When a one-finger tap clicks (see input/tap_resolver.h).
+enum class TapMode : uint8_t {
+    Deferred,   // Click once no second tap can follow; tap-tap-hold drags without a click
+    FastClick,  // Click on lift; tap-tap-hold is a click followed by a drag
+};
+
+// What the touchpad sends (see IDriveController::SetTouchOutput).
+enum class TouchOutput : uint8_t {
+    Mouse,      // TouchpadHandler gestures: pointer, scroll, pinch, swipes, taps
+    Digitizer,  // Raw contacts as a HID touch screen; the host does the gestures
+};
+
 struct Config {
-    bool     joystick_as_mouse  = true;
-    uint8_t  light_brightness   = 0;
-    uint32_t poll_interval_ms   = 500;
-    uint32_t light_keepalive_ms = 10000;
-    int      min_mouse_travel   = 5;
-    int      joystick_move_step = 30;
+    bool     joystick_as_mouse        = true;
+    uint8_t  light_brightness         = 0;
+    uint32_t poll_interval_ms         = 500;
+    uint32_t light_keepalive_ms       = 10000;
+    int      min_mouse_travel         = 5;
+    int      joystick_move_step       = 30;
+    uint32_t joystick_repeat_delay_ms = 400;
+    uint32_t joystick_repeat_rate_hz  = 12;  // 0: no timed repeat or glide
+
+    PointerAccelProfile pointer_accel = PointerAccelProfile::Linear;
+    RotaryAccelProfile  rotary_accel  = RotaryAccelProfile::Off;
+    PinchMode           pinch_mode    = PinchMode::Off;
+    TapMode             tap_mode      = TapMode::Deferred;
+    TouchOutput         touch_output  = TouchOutput::Mouse;
 };
 
 // =============================================================================
@@ -35,6 +77,13 @@ constexpr const char *kUsbManufacturer = "llilakoblock";
 constexpr const char *kUsbProduct      = "BMW iDrive Touch Adapter";
 constexpr const char *kUsbSerialNumber = "123456";
 
+// HID interrupt endpoint polling interval (bInterval, full speed).
+constexpr uint8_t kHidPollIntervalMs = 10;
+
+// A submitted HID report that has not completed after this long (host stopped
+// polling without a suspend/unmount) is treated as lost so input resumes.
+constexpr uint32_t kHidReportStallMs = 100;
+
 // CAN Bus Configuration
 constexpr uint32_t kCanBaudrate = 500000;
 
@@ -58,6 +107,69 @@ constexpr int kYMultiplier = 5;  // Y delta * 5 / 10 = 0.5 pixel per step (same
 // Two-finger scroll multiplier
 constexpr int kScrollMultiplier = 2;  // Scroll sensitivity
 
+// Held joystick (see input/stick_repeat.h). Arrow keys repeat after
+// Config::joystick_repeat_delay_ms at Config::joystick_repeat_rate_hz; in
+// mouse mode the cursor glides after the same delay instead, ramping from
+// kJoystickGlideStartSpeed to kJoystickGlideMaxSpeed pixels/s over
+// kJoystickGlideRampMs. Both run from a timer, not from CAN frames. A rate of
+// 0 keeps the old behaviour: the arrow key is held (the host repeats it) and
+// the cursor steps once per controller frame.
+constexpr uint32_t kJoystickRepeatDelayMs   = 400;
+constexpr uint32_t kJoystickRepeatRateHz    = 12;
+constexpr int32_t  kJoystickGlideStartSpeed = 200;
+constexpr int32_t  kJoystickGlideMaxSpeed   = 1600;
+constexpr uint32_t kJoystickGlideRampMs     = 1000;
+
+// Rotary knob speed estimate (Config::rotary_accel): rotary events older than
+// this no longer count, so a knob turned after a pause starts at unity gain.
+constexpr uint32_t kRotaryVelocityWindowMs = 150;
+
+// Two-finger horizontal pan (AC Pan). A two-finger contact holds its output
+// until kScrollAxisLockTravel raw units of common travel have built up, then
+// locks to whichever axis moved further (vertical on a tie) until lift. With
+// pan off, two fingers only scroll vertically and lock immediately.
+constexpr bool kTwoFingerPan         = true;
+constexpr int  kScrollAxisLockTravel = 8;
+constexpr int  kPanMultiplier        = 2;  // Pan sensitivity
+
+// One-Euro filter on raw touch coordinates (see input/one_euro_filter.h).
+// Cutoffs in millihertz; beta raises the cutoff per raw unit/s of finger speed.
+// Tune with `idrive_sim filter`.
+constexpr bool     kTouchFilter             = true;
+constexpr uint32_t kTouchFilterMinCutoffMhz = 10000;
+constexpr uint32_t kTouchFilterBetaMhz      = 50;
+constexpr uint32_t kTouchFilterDCutoffMhz   = 1000;
+
+// Kinetic scrolling after a two-finger flick (see input/kinetic_scroll.h).
+// Speeds in wheel detents per second; the fling decays exponentially and is
+// emitted once per HID poll interval.
+constexpr bool     kKineticScroll        = true;
+constexpr uint32_t kKineticMinStartSpeed = 20;   // Slower lifts just stop
+constexpr uint32_t kKineticStopSpeed     = 3;    // Fling ends below this
+constexpr uint32_t kKineticMaxSpeed      = 500;
+constexpr uint32_t kKineticDecayMs       = 325;  // Speed time constant
+constexpr uint32_t kKineticLiftWindowMs  = 50;   // Fingers must still be moving at lift
+
+// Three- and four-finger swipes (see input/swipe_recognizer.h). A swipe must
+// travel kSwipeMinDistance raw units, at least kSwipeAxisRatio times further
+// along its axis than across it, within kSwipeMaxDurationMs of touching down.
+constexpr bool     kSwipeGestures      = true;
+constexpr int      kSwipeMinDistance   = 80;
+constexpr int      kSwipeAxisRatio     = 2;
+constexpr uint32_t kSwipeMaxDurationMs = 600;
+
+// Two-finger pinch (Config::pinch_mode). Distance changes are in percent of
+// the finger spacing. A contact starts undecided: kPinchScrollLock raw units of
+// common travel lock it to scrolling, a kPinchEnterPercent change in spacing
+// first locks it to pinching. Once scrolling, only a kPinchBreakoutPercent
+// change turns it into a pinch; a pinch stays a pinch until lift. Each further
+// kPinchStepPercent change is one zoom step.
+constexpr int kPinchScrollLock      = 8;
+constexpr int kPinchEnterPercent    = 15;
+constexpr int kPinchBreakoutPercent = 50;
+constexpr int kPinchStepPercent     = 10;
+constexpr int kPinchMinSpacing      = 40;  // Raw units; closer fingers count as this far apart
+
 // =============================================================================
 // Tap Gesture Configuration (laptop-style touchpad gestures)
 // =============================================================================
@@ -65,7 +177,13 @@ constexpr int kScrollMultiplier = 2;  // Scroll sensitivity
 // Tap timing (milliseconds)
 constexpr uint32_t kTapMaxDurationMs  = 200;  // Max touch duration to count as tap
 constexpr uint32_t kDoubleTapWindowMs = 300;  // Window for second tap (tap-tap-hold)
-constexpr uint32_t kTapHoldDelayMs    = 150;  // Delay before drag starts (reserved)
+constexpr uint32_t kTapHoldDelayMs    = 150;  // Second touch held this long drags (Deferred)
+constexpr uint32_t kTapTickMs         = 5;    // Tap resolver timer (window expiry, hold)
+
+// HID tap engine: press-to-release hold time for clicks and key taps, and
+// how late a queued release may fire before it is counted as late.
+constexpr uint32_t kTapHoldMs           = 50;
+constexpr uint32_t kReleaseLateThreshUs = 2000;
 
 // Tap movement threshold (raw touchpad coordinates, 0-511 range)
 constexpr int kTapMaxMovement =
@@ -75,7 +193,21 @@ constexpr int kTapMaxMovement =
 constexpr bool kSerialDebug   = true;
 constexpr bool kDebugCan      = false;  // Reduce spam
 constexpr bool kDebugKeys     = true;
-constexpr bool kDebugTouchpad = true;  // See touch data
+constexpr bool kDebugTouchpad = true;   // See touch data
+constexpr bool kDebugStats    = false;  // Periodic TX jitter, RX queue and HID report/latency stats
+
+// Interval between statistics dumps (when kDebugStats is set).
+constexpr uint32_t kStatsIntervalMs = 10000;
+
+// Also dump the raw CAN-to-USB latency histograms as CSV with each stats dump.
+constexpr bool kDebugLatencyCsv = false;
+
+// Binary trace of the most recent CAN RX/TX (see can/can_trace.h). A bus
+// error freezes it after the post-trigger window; the frozen trace is then
+// printed as CANTRACE lines, a chunk per main loop pass.
+constexpr bool     kCanTrace              = true;
+constexpr uint32_t kCanTracePostTriggerMs = 500;
+constexpr size_t   kCanTraceDumpChunk     = 1024;  // Record bytes printed per loop pass
 
 }  // namespace config
 
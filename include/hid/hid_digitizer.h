@@ -0,0 +1,95 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+//
+// HID multi-touch digitizer (touch screen) collection.
+// In TouchOutput::Digitizer mode the touchpad contacts go to the host as
+// absolute touches instead of relative mouse motion, and the host's own
+// gesture stack (Android, Windows, Linux hid-multitouch) does the rest.
+// The report descriptor is a macro of raw items, like TinyUSB's
+// TUD_HID_REPORT_DESC_* ones, so the host tools can build and parse the same
+// bytes the device enumerates with.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace idrive {
+
+// Contacts per report (the ZBE4 reports at most two finger positions).
+constexpr size_t kDigitizerContacts = 2;
+
+// Logical coordinate range; the 9-bit pad coordinates are scaled up to it.
+constexpr uint16_t kDigitizerLogicalMax = 4095;
+
+// One contact: tip switch (bit 0), contact identifier, X and Y little-endian.
+struct DigitizerContact {
+    uint8_t tip  = 0;
+    uint8_t id   = 0;
+    uint8_t x[2] = {0, 0};
+    uint8_t y[2] = {0, 0};
+};
+
+// Input report (after the report ID): the contacts, then how many of them are
+// valid. A lifting contact is reported once more with the tip switch off.
+struct DigitizerReport {
+    DigitizerContact contacts[kDigitizerContacts];
+    uint8_t          count = 0;
+};
+
+static_assert(sizeof(DigitizerContact) == 6, "contact layout must match the descriptor");
+static_assert(sizeof(DigitizerReport) == kDigitizerContacts * 6 + 1,
+              "report layout must match the descriptor");
+
+}  // namespace idrive
+
+// One finger logical collection (6 bytes of input report).
+#define IDRIVE_HID_DIGITIZER_FINGER                                                          \
+    0x05, 0x0D,                           /*   Usage Page (Digitizer)                  */   \
+    0x09, 0x22,                           /*   Usage (Finger)                          */   \
+    0xA1, 0x02,                           /*   Collection (Logical)                    */   \
+    0x09, 0x42,                           /*     Usage (Tip Switch)                    */   \
+    0x15, 0x00,                           /*     Logical Minimum (0)                   */   \
+    0x25, 0x01,                           /*     Logical Maximum (1)                   */   \
+    0x75, 0x01,                           /*     Report Size (1)                       */   \
+    0x95, 0x01,                           /*     Report Count (1)                      */   \
+    0x81, 0x02,                           /*     Input (Data, Var, Abs)                */   \
+    0x95, 0x07,                           /*     Report Count (7)                      */   \
+    0x81, 0x03,                           /*     Input (Const) - padding               */   \
+    0x09, 0x51,                           /*     Usage (Contact Identifier)            */   \
+    0x26, 0xFF, 0x00,                     /*     Logical Maximum (255)                 */   \
+    0x75, 0x08,                           /*     Report Size (8)                       */   \
+    0x95, 0x01,                           /*     Report Count (1)                      */   \
+    0x81, 0x02,                           /*     Input (Data, Var, Abs)                */   \
+    0x05, 0x01,                           /*     Usage Page (Generic Desktop)          */   \
+    0x26, 0xFF, 0x0F,                     /*     Logical Maximum (4095)                */   \
+    0x75, 0x10,                           /*     Report Size (16)                      */   \
+    0x09, 0x30,                           /*     Usage (X)                             */   \
+    0x81, 0x02,                           /*     Input (Data, Var, Abs)                */   \
+    0x09, 0x31,                           /*     Usage (Y)                             */   \
+    0x81, 0x02,                           /*     Input (Data, Var, Abs)                */   \
+    0xC0                                  /*   End Collection                          */
+
+// Touch screen application collection with kDigitizerContacts fingers, the
+// contact count, and a Contact Count Maximum feature (answered by the port's
+// GET_REPORT callback). Pass the report ID item as the argument, e.g.
+// HID_REPORT_ID(kReportIdDigitizer).
+#define IDRIVE_HID_REPORT_DESC_DIGITIZER(...)                                                \
+    0x05, 0x0D,                           /* Usage Page (Digitizer)                    */   \
+    0x09, 0x04,                           /* Usage (Touch Screen)                      */   \
+    0xA1, 0x01,                           /* Collection (Application)                  */   \
+    __VA_ARGS__                                                                              \
+    IDRIVE_HID_DIGITIZER_FINGER,                                                             \
+    IDRIVE_HID_DIGITIZER_FINGER,                                                             \
+    0x05, 0x0D,                           /*   Usage Page (Digitizer)                  */   \
+    0x09, 0x54,                           /*   Usage (Contact Count)                   */   \
+    0x25, 0x02,                           /*   Logical Maximum (2)                     */   \
+    0x75, 0x08,                           /*   Report Size (8)                         */   \
+    0x95, 0x01,                           /*   Report Count (1)                        */   \
+    0x81, 0x02,                           /*   Input (Data, Var, Abs)                  */   \
+    0x09, 0x55,                           /*   Usage (Contact Count Maximum)           */   \
+    0xB1, 0x02,                           /*   Feature (Data, Var, Abs)                */   \
+    0xC0                                  /* End Collection                            */
+
+static_assert(::idrive::kDigitizerContacts == 2 && ::idrive::kDigitizerLogicalMax == 4095,
+              "IDRIVE_HID_REPORT_DESC_DIGITIZER hardcodes the contacts and logical range");
@@ -82,6 +82,12 @@ constexpr uint8_t kLeft  = 0x50;
 constexpr uint8_t kDown  = 0x51;
 constexpr uint8_t kUp    = 0x52;
 
+// Modifier bits (keyboard report byte 0)
+constexpr uint8_t kModLeftCtrl  = 0x01;
+constexpr uint8_t kModLeftShift = 0x02;
+constexpr uint8_t kModLeftAlt   = 0x04;
+constexpr uint8_t kModLeftGui   = 0x08;
+
 }  // namespace key
 
 // =============================================================================
@@ -113,7 +119,11 @@ constexpr uint16_t kTrebleDown = 0x0155;
 namespace android {
 
 constexpr uint16_t kBack          = 0x0224;  // AC Back - native Android back
+constexpr uint16_t kForward       = 0x0225;  // AC Forward
 constexpr uint16_t kHome          = 0x0223;  // AC Home - native Android home
+constexpr uint16_t kRecents       = 0x029F;  // AC Desktop Show All Windows - app switcher
+constexpr uint16_t kZoomIn        = 0x022D;  // AC Zoom In
+constexpr uint16_t kZoomOut       = 0x022E;  // AC Zoom Out
 constexpr uint16_t kMenu          = 0x0040;  // Menu key (legacy)
 constexpr uint16_t kSearch        = 0x0221;  // AC Search
 constexpr uint16_t kAlPhone       = 0x018B;  // AL Phone - opens dialer
@@ -0,0 +1,128 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+//
+// Relative mouse reports.
+// In report protocol the mouse sends 16-bit X/Y, wheel and AC Pan, so a fast
+// swipe goes out in one report instead of being cut into +/-127 pieces. A
+// host that selected boot protocol (BIOS, UEFI, KVM switches) gets the fixed
+// 3-byte boot mouse layout plus a wheel byte, without report ID; the motion
+// accumulator then splits larger deltas over several reports.
+// Wheel and pan each sit in a logical collection with a Resolution Multiplier
+// feature. A host that sets it (Windows, Linux, Android) reads them in
+// 1/kWheelUnitsPerDetent detents and scrolls smoothly; one that does not
+// (macOS, boot protocol) gets whole detents.
+
+#pragma once
+
+#include <cstdint>
+
+namespace idrive {
+
+// Largest delta per axis in one report.
+constexpr int32_t kMouseReportMax     = 32767;
+constexpr int32_t kBootMouseReportMax = 127;
+
+// High-resolution wheel units per detent (the multiplier's physical maximum).
+constexpr int32_t kWheelUnitsPerDetent = 120;
+
+// Resolution Multiplier feature report (after the report ID): 2 bits each for
+// the wheel and pan multipliers, logical 0 (x1) or 1 (x kWheelUnitsPerDetent).
+constexpr uint8_t kMultiplierWheelMask = 0x03;
+constexpr uint8_t kMultiplierPanMask   = 0x0C;
+
+// Report protocol input report (after the report ID).
+struct MouseReport {
+    uint8_t buttons  = 0;
+    uint8_t reserved = 0;
+    int16_t x        = 0;
+    int16_t y        = 0;
+    int16_t wheel    = 0;
+    int16_t pan      = 0;  // AC Pan, positive to the right
+};
+
+// Boot protocol input report. Boot hosts read the first three bytes; the
+// wheel byte is the common extension. There is no pan.
+struct BootMouseReport {
+    uint8_t buttons = 0;
+    int8_t  x       = 0;
+    int8_t  y       = 0;
+    int8_t  wheel   = 0;
+};
+
+static_assert(sizeof(MouseReport) == 10, "mouse report layout must match the descriptor");
+static_assert(sizeof(BootMouseReport) == 4, "boot mouse report layout is fixed");
+
+}  // namespace idrive
+
+// Mouse application collection: 5 buttons, padding to the 16-bit fields, X
+// and Y, then the wheel and AC Pan, each in a logical collection with its
+// Resolution Multiplier, and padding for the feature byte. Pass the report ID
+// item as the argument, e.g. HID_REPORT_ID(kReportIdMouse).
+#define IDRIVE_HID_REPORT_DESC_MOUSE(...)                                                    \
+    0x05, 0x01,                           /* Usage Page (Generic Desktop)              */   \
+    0x09, 0x02,                           /* Usage (Mouse)                             */   \
+    0xA1, 0x01,                           /* Collection (Application)                  */   \
+    __VA_ARGS__                                                                              \
+    0x09, 0x01,                           /*   Usage (Pointer)                         */   \
+    0xA1, 0x00,                           /*   Collection (Physical)                   */   \
+    0x05, 0x09,                           /*     Usage Page (Button)                   */   \
+    0x19, 0x01,                           /*     Usage Minimum (1)                     */   \
+    0x29, 0x05,                           /*     Usage Maximum (5)                     */   \
+    0x15, 0x00,                           /*     Logical Minimum (0)                   */   \
+    0x25, 0x01,                           /*     Logical Maximum (1)                   */   \
+    0x75, 0x01,                           /*     Report Size (1)                       */   \
+    0x95, 0x05,                           /*     Report Count (5)                      */   \
+    0x81, 0x02,                           /*     Input (Data, Var, Abs)                */   \
+    0x75, 0x0B,                           /*     Report Size (11)                      */   \
+    0x95, 0x01,                           /*     Report Count (1)                      */   \
+    0x81, 0x03,                           /*     Input (Const) - padding               */   \
+    0x05, 0x01,                           /*     Usage Page (Generic Desktop)          */   \
+    0x16, 0x01, 0x80,                     /*     Logical Minimum (-32767)              */   \
+    0x26, 0xFF, 0x7F,                     /*     Logical Maximum (32767)               */   \
+    0x75, 0x10,                           /*     Report Size (16)                      */   \
+    0x95, 0x02,                           /*     Report Count (2)                      */   \
+    0x09, 0x30,                           /*     Usage (X)                             */   \
+    0x09, 0x31,                           /*     Usage (Y)                             */   \
+    0x81, 0x06,                           /*     Input (Data, Var, Rel)                */   \
+    IDRIVE_HID_MOUSE_MULTIPLIER,                                                             \
+    0x09, 0x38,                           /*       Usage (Wheel)                       */   \
+    IDRIVE_HID_MOUSE_SCROLL_AXIS,                                                            \
+    IDRIVE_HID_MOUSE_MULTIPLIER,                                                             \
+    0x05, 0x0C,                           /*       Usage Page (Consumer)               */   \
+    0x0A, 0x38, 0x02,                     /*       Usage (AC Pan)                      */   \
+    IDRIVE_HID_MOUSE_SCROLL_AXIS,                                                            \
+    0x75, 0x04,                           /*     Report Size (4)                       */   \
+    0x95, 0x01,                           /*     Report Count (1)                      */   \
+    0xB1, 0x03,                           /*     Feature (Const) - padding             */   \
+    0xC0,                                 /*   End Collection                          */   \
+    0xC0                                  /* End Collection                            */
+
+// Opens a scroll axis' logical collection with its 2-bit Resolution
+// Multiplier: logical 0..1 maps to physical 1..kWheelUnitsPerDetent. The
+// physical range is cleared again for the axis that follows.
+#define IDRIVE_HID_MOUSE_MULTIPLIER                                                          \
+    0xA1, 0x02,                           /*     Collection (Logical)                  */   \
+    0x05, 0x01,                           /*       Usage Page (Generic Desktop)        */   \
+    0x09, 0x48,                           /*       Usage (Resolution Multiplier)       */   \
+    0x15, 0x00,                           /*       Logical Minimum (0)                 */   \
+    0x25, 0x01,                           /*       Logical Maximum (1)                 */   \
+    0x35, 0x01,                           /*       Physical Minimum (1)                */   \
+    0x45, 0x78,                           /*       Physical Maximum (120)              */   \
+    0x75, 0x02,                           /*       Report Size (2)                     */   \
+    0x95, 0x01,                           /*       Report Count (1)                    */   \
+    0xB1, 0x02,                           /*       Feature (Data, Var, Abs)            */   \
+    0x35, 0x00,                           /*       Physical Minimum (0)                */   \
+    0x45, 0x00                            /*       Physical Maximum (0)                */
+
+// The 16-bit relative input of a scroll axis (its usage goes first), closing
+// the logical collection.
+#define IDRIVE_HID_MOUSE_SCROLL_AXIS                                                         \
+    0x16, 0x01, 0x80,                     /*       Logical Minimum (-32767)            */   \
+    0x26, 0xFF, 0x7F,                     /*       Logical Maximum (32767)             */   \
+    0x75, 0x10,                           /*       Report Size (16)                    */   \
+    0x95, 0x01,                           /*       Report Count (1)                    */   \
+    0x81, 0x06,                           /*       Input (Data, Var, Rel)              */   \
+    0xC0                                  /*     End Collection                        */
+
+static_assert(::idrive::kMouseReportMax == 32767 && ::idrive::kWheelUnitsPerDetent == 120,
+              "IDRIVE_HID_REPORT_DESC_MOUSE hardcodes the logical range and multiplier");
@@ -0,0 +1,48 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+//
+// HID port interface used by UsbHidDevice.
+// TinyUsbHidPort implements it on top of TinyUSB; the host simulator provides
+// an in-memory sink that records reports and models host polling.
+
+#pragma once
+
+#include <cstdint>
+
+namespace idrive {
+
+// Report IDs of the composite HID descriptor.
+enum HidReportId : uint8_t {
+    kReportIdKeyboard  = 1,
+    kReportIdMouse     = 2,
+    kReportIdConsumer  = 3,
+    kReportIdDigitizer = 4,
+};
+
+// Protocol selected by the host with SET_PROTOCOL (values as on the wire).
+// Boot protocol reports carry no report ID and only the boot mouse layout.
+enum class HidProtocol : uint8_t {
+    Boot   = 0,
+    Report = 1,
+};
+
+class HidPort {
+   public:
+    virtual ~HidPort() = default;
+
+    // Device is configured by the host.
+    virtual bool IsMounted() const = 0;
+
+    // The interrupt IN endpoint can accept a report.
+    virtual bool IsReady() const = 0;
+
+    // Queue a report for the next host poll. Completion is signalled through
+    // UsbHidDevice::OnReportComplete(), never from inside this call.
+    virtual bool SendReport(uint8_t report_id, const void *data, uint16_t len) = 0;
+
+    // Call UsbHidDevice::ServiceReleases() in about delay_us, unless a wakeup
+    // is already pending (it re-arms for the remaining releases itself).
+    virtual void ArmReleaseTimer(uint64_t delay_us) = 0;
+};
+
+}  // namespace idrive
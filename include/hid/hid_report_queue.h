@@ -0,0 +1,124 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+//
+// Pending button/key report snapshots awaiting the next free USB transfer.
+// Consecutive changes in the same direction (press after press, release after
+// release) are merged into one snapshot; a change in the opposite direction
+// starts a new one, so a quick release-press or press-release still reaches
+// the host as two edges instead of cancelling out. A mouse snapshot that
+// already carries its motion is never merged, so that motion is sent exactly
+// once and in order.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "hid/input_latency.h"
+
+namespace idrive {
+
+struct HidReportSnapshot {
+    static constexpr size_t kMaxLen = 16;
+
+    uint8_t       report_id     = 0;
+    uint8_t       len           = 0;
+    bool          press         = false;  // Direction of the change that produced it
+    bool          motion        = false;  // Mouse x/y/wheel/pan filled in, send as is
+    uint8_t       data[kMaxLen] = {0};
+    LatencySource source        = LatencySource::None;  // Oldest input merged in
+    uint64_t      origin_us     = 0;
+};
+
+class HidReportQueue {
+   public:
+    static constexpr size_t kCapacity = 8;
+
+    enum class Result : uint8_t {
+        Queued,     // New snapshot appended
+        Coalesced,  // Merged into the newest unsent snapshot
+        Overflow,   // Queue full: newest snapshot overwritten, an edge was lost
+    };
+
+    Result Push(uint8_t report_id, const void *data, uint8_t len, bool press,
+                LatencySource source = LatencySource::None, uint64_t origin_us = 0,
+                bool motion = false)
+    {
+        if (len > HidReportSnapshot::kMaxLen) {
+            len = HidReportSnapshot::kMaxLen;
+        }
+
+        if (count_ > 0) {
+            HidReportSnapshot &tail = At(count_ - 1);
+            if (tail.report_id == report_id && tail.press == press && !tail.motion && !motion) {
+                Assign(tail, report_id, data, len, press, motion);
+                Charge(tail, source, origin_us);
+                return Result::Coalesced;
+            }
+        }
+
+        if (count_ == kCapacity) {
+            // Keep the final state correct even though an edge is lost.
+            Assign(At(count_ - 1), report_id, data, len, press, motion);
+            Charge(At(count_ - 1), source, origin_us);
+            return Result::Overflow;
+        }
+
+        HidReportSnapshot &entry = At(count_);
+        Assign(entry, report_id, data, len, press, motion);
+        entry.source    = source;
+        entry.origin_us = origin_us;
+        count_++;
+        return Result::Queued;
+    }
+
+    const HidReportSnapshot &Front() const { return entries_[head_]; }
+
+    void Pop()
+    {
+        if (count_ > 0) {
+            head_ = (head_ + 1) % kCapacity;
+            count_--;
+        }
+    }
+
+    bool   Empty() const { return count_ == 0; }
+    size_t Size() const { return count_; }
+
+    void Clear()
+    {
+        head_  = 0;
+        count_ = 0;
+    }
+
+   private:
+    HidReportSnapshot &At(size_t offset) { return entries_[(head_ + offset) % kCapacity]; }
+
+    static void Assign(HidReportSnapshot &entry, uint8_t report_id, const void *data, uint8_t len,
+                       bool press, bool motion)
+    {
+        entry.report_id = report_id;
+        entry.len       = len;
+        entry.press     = press;
+        entry.motion    = motion;
+        std::memcpy(entry.data, data, len);
+    }
+
+    // A merged snapshot is charged to its oldest timed input.
+    static void Charge(HidReportSnapshot &entry, LatencySource source, uint64_t origin_us)
+    {
+        if (source != LatencySource::None &&
+            (entry.source == LatencySource::None || origin_us < entry.origin_us)) {
+            entry.source    = source;
+            entry.origin_us = origin_us;
+        }
+    }
+
+    std::array<HidReportSnapshot, kCapacity> entries_ = {};
+    size_t                                   head_    = 0;
+    size_t                                   count_   = 0;
+};
+
+}  // namespace idrive
@@ -0,0 +1,79 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+//
+// End-to-end input latency, measured from CAN RX to the USB HID report.
+// Two stages are tracked per input type:
+//   submit:   CAN RX -> report handed to tud_hid_n_report()
+//   complete: CAN RX -> TinyUSB report-complete callback (host has polled it)
+// Coalesced reports are charged to their oldest contributing input.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "utils/latency_histogram.h"
+
+namespace idrive {
+
+enum class LatencySource : uint8_t {
+    None,  // Not caused by a CAN frame (e.g. timed tap release)
+    Button,
+    Joystick,
+    Rotary,
+    Touchpad,
+};
+
+enum class LatencyStage : uint8_t { Submit, Complete };
+
+class InputLatency {
+   public:
+    static constexpr size_t kSourceCount = 4;  // Button..Touchpad
+    static constexpr size_t kStageCount  = 2;
+
+    void Record(LatencySource source, LatencyStage stage, uint32_t us)
+    {
+        size_t index = SourceIndex(source);
+        if (index < kSourceCount) {
+            histograms_[index][static_cast<size_t>(stage)].Record(us);
+        }
+    }
+
+    // Histogram for a source/stage, or nullptr for LatencySource::None.
+    const utils::LatencyHistogram *Get(LatencySource source, LatencyStage stage) const
+    {
+        size_t index = SourceIndex(source);
+        return index < kSourceCount ? &histograms_[index][static_cast<size_t>(stage)] : nullptr;
+    }
+
+    void Reset()
+    {
+        for (auto &stages : histograms_) {
+            for (auto &hist : stages) {
+                hist.Reset();
+            }
+        }
+    }
+
+    // One summary line per source and stage with samples (serial console).
+    void Log(const char *tag) const;
+
+    // Non-empty buckets as CSV on stdout, for plotting on the host:
+    //   latency,<source>,<stage>,<bucket_upper_us>,<samples>
+    void ExportCsv() const;
+
+    static const char *SourceName(LatencySource source);
+    static const char *StageName(LatencyStage stage);
+
+   private:
+    // None maps past the end (kSourceCount).
+    static size_t SourceIndex(LatencySource source)
+    {
+        return source == LatencySource::None ? kSourceCount : static_cast<size_t>(source) - 1;
+    }
+
+    std::array<std::array<utils::LatencyHistogram, kStageCount>, kSourceCount> histograms_ = {};
+};
+
+}  // namespace idrive
@@ -0,0 +1,100 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+//
+// Relative mouse motion accumulator.
+// Deltas that arrive faster than the host polls are summed here and drained
+// one report at a time. Each report carries at most the report's range per
+// axis (16-bit in report protocol, +/-127 in boot protocol); the rest stays
+// pending for the next report, so no motion is lost to clamping.
+
+#pragma once
+
+#include <cstdint>
+
+namespace idrive {
+
+class MouseAccumulator {
+   public:
+    // Upper bound on pending motion per axis. Beyond this (host stalled),
+    // further motion is clipped and counted as saturated.
+    static constexpr int32_t kMaxPending = 32767;
+
+    struct Chunk {
+        int16_t x     = 0;
+        int16_t y     = 0;
+        int16_t wheel = 0;
+        int16_t pan   = 0;
+    };
+
+    // Add motion. Returns true if any axis had to be clipped.
+    bool Add(int32_t x, int32_t y, int32_t wheel, int32_t pan)
+    {
+        bool clipped = false;
+        x_           = SaturatingAdd(x_, x, clipped);
+        y_           = SaturatingAdd(y_, y, clipped);
+        wheel_       = SaturatingAdd(wheel_, wheel, clipped);
+        pan_         = SaturatingAdd(pan_, pan, clipped);
+        return clipped;
+    }
+
+    // Remove up to one report's worth of motion, at most `limit` per axis.
+    Chunk Take(int32_t limit)
+    {
+        Chunk chunk;
+        chunk.x     = TakeAxis(x_, limit);
+        chunk.y     = TakeAxis(y_, limit);
+        chunk.wheel = TakeAxis(wheel_, limit);
+        chunk.pan   = TakeAxis(pan_, limit);
+        return chunk;
+    }
+
+    // Put a chunk back (report could not be submitted).
+    void Restore(const Chunk &chunk)
+    {
+        bool clipped = false;
+        x_           = SaturatingAdd(x_, chunk.x, clipped);
+        y_           = SaturatingAdd(y_, chunk.y, clipped);
+        wheel_       = SaturatingAdd(wheel_, chunk.wheel, clipped);
+        pan_         = SaturatingAdd(pan_, chunk.pan, clipped);
+    }
+
+    bool Pending() const { return x_ != 0 || y_ != 0 || wheel_ != 0 || pan_ != 0; }
+
+    void Clear() { x_ = y_ = wheel_ = pan_ = 0; }
+
+    // Drop pending vertical scroll (its units changed).
+    void ClearWheel() { wheel_ = 0; }
+
+    // Drop pending horizontal scroll (boot protocol has no pan field, or its
+    // units changed).
+    void ClearPan() { pan_ = 0; }
+
+   private:
+    int32_t x_     = 0;
+    int32_t y_     = 0;
+    int32_t wheel_ = 0;
+    int32_t pan_   = 0;
+
+    static int32_t SaturatingAdd(int32_t acc, int32_t delta, bool &clipped)
+    {
+        int64_t sum = static_cast<int64_t>(acc) + delta;
+        if (sum > kMaxPending) {
+            clipped = true;
+            return kMaxPending;
+        }
+        if (sum < -kMaxPending) {
+            clipped = true;
+            return -kMaxPending;
+        }
+        return static_cast<int32_t>(sum);
+    }
+
+    static int16_t TakeAxis(int32_t &acc, int32_t limit)
+    {
+        int32_t part = acc > limit ? limit : (acc < -limit ? -limit : acc);
+        acc -= part;
+        return static_cast<int16_t>(part);
+    }
+};
+
+}  // namespace idrive
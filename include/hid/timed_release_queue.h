@@ -0,0 +1,121 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+//
+// Fixed-capacity queue of deferred HID releases (click / key-tap engine).
+// A tap sends the press immediately and queues its release for later, so
+// callers never sleep between press and release. Time is passed in by the
+// caller; the queue itself has no clock.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace idrive {
+
+struct TimedRelease {
+    enum class Kind : uint8_t { MouseButton, Key, MediaKey };
+
+    Kind     kind   = Kind::MouseButton;
+    uint16_t code   = 0;  // Mouse button mask, keycode or consumer usage
+    uint64_t due_us = 0;
+};
+
+struct TimedReleaseStats {
+    uint32_t scheduled   = 0;  // Releases queued
+    uint32_t fired       = 0;  // Releases sent from the queue
+    uint32_t late        = 0;  // Fired later than the late threshold
+    uint32_t preempted   = 0;  // Sent early because the same input was tapped again
+    uint32_t overflows   = 0;  // Queue full: release had to be sent immediately
+    uint32_t max_late_us = 0;  // Worst lateness seen
+};
+
+class TimedReleaseQueue {
+   public:
+    static constexpr size_t kCapacity = 16;
+
+    explicit TimedReleaseQueue(uint32_t late_threshold_us = 2000)
+        : late_threshold_us_(late_threshold_us)
+    {}
+
+    // Queue a release. Returns false when the queue is full.
+    bool Schedule(TimedRelease::Kind kind, uint16_t code, uint64_t due_us)
+    {
+        if (count_ >= kCapacity) {
+            stats_.overflows++;
+            return false;
+        }
+        entries_[count_++] = {kind, code, due_us};
+        stats_.scheduled++;
+        return true;
+    }
+
+    // Remove a pending release for the same input. Returns true if one was
+    // pending; the caller must then send that release before pressing again.
+    bool Preempt(TimedRelease::Kind kind, uint16_t code)
+    {
+        for (size_t i = 0; i < count_; ++i) {
+            if (entries_[i].kind == kind && entries_[i].code == code) {
+                Remove(i);
+                stats_.preempted++;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Move every release due at now_us into out (up to max_out entries).
+    // Returns the number of releases taken.
+    size_t TakeDue(uint64_t now_us, TimedRelease *out, size_t max_out)
+    {
+        size_t taken = 0;
+        size_t i     = 0;
+        while (i < count_ && taken < max_out) {
+            if (entries_[i].due_us > now_us) {
+                ++i;
+                continue;
+            }
+
+            uint32_t late = static_cast<uint32_t>(now_us - entries_[i].due_us);
+            if (late > late_threshold_us_) {
+                stats_.late++;
+            }
+            if (late > stats_.max_late_us) {
+                stats_.max_late_us = late;
+            }
+            stats_.fired++;
+
+            out[taken++] = entries_[i];
+            Remove(i);
+        }
+        return taken;
+    }
+
+    // Earliest pending due time, or UINT64_MAX when empty.
+    uint64_t NextDue() const
+    {
+        uint64_t next = UINT64_MAX;
+        for (size_t i = 0; i < count_; ++i) {
+            if (entries_[i].due_us < next) {
+                next = entries_[i].due_us;
+            }
+        }
+        return next;
+    }
+
+    size_t                   Size() const { return count_; }
+    bool                     Empty() const { return count_ == 0; }
+    const TimedReleaseStats &Stats() const { return stats_; }
+
+   private:
+    // Order is not significant; keep the array dense by moving the last entry.
+    void Remove(size_t index) { entries_[index] = entries_[--count_]; }
+
+    std::array<TimedRelease, kCapacity> entries_ = {};
+    size_t                              count_   = 0;
+    uint32_t                            late_threshold_us_;
+    TimedReleaseStats                   stats_;
+};
+
+}  // namespace idrive
@@ -0,0 +1,40 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+//
+// TinyUSB implementation of HidPort: descriptors, driver install, the USB
+// task, TinyUSB callbacks and the tap release timer.
+
+#pragma once
+
+#include <cstdint>
+
+#include "esp_timer.h"
+
+#include "hid/hid_port.h"
+#include "hid/usb_hid_device.h"
+
+namespace idrive {
+
+class TinyUsbHidPort : public HidPort {
+   public:
+    TinyUsbHidPort() = default;
+
+    TinyUsbHidPort(const TinyUsbHidPort &)            = delete;
+    TinyUsbHidPort &operator=(const TinyUsbHidPort &) = delete;
+
+    // Install TinyUSB and attach `device` to this port.
+    bool Init(UsbHidDevice &device);
+
+    bool IsMounted() const override;
+    bool IsReady() const override;
+    bool SendReport(uint8_t report_id, const void *data, uint16_t len) override;
+    void ArmReleaseTimer(uint64_t delay_us) override;
+
+   private:
+    UsbHidDevice      *device_        = nullptr;
+    esp_timer_handle_t release_timer_ = nullptr;
+
+    static void ReleaseTimerCallback(void *arg);
+};
+
+}  // namespace idrive
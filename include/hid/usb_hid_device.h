@@ -2,17 +2,37 @@
 // SPDX-License-Identifier: MIT
 //
 // USB HID device class for keyboard, mouse, and media controls.
+// Report state, pacing and the tap engine live here; the USB stack itself is
+// behind HidPort (TinyUsbHidPort on the device).
 
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 #include <mutex>
 
-#include "freertos/FreeRTOS.h"
-#include "freertos/semphr.h"
+#include "config/config.h"
+#include "hid/hid_digitizer.h"
+#include "hid/hid_mouse.h"
+#include "hid/hid_port.h"
+#include "hid/hid_report_queue.h"
+#include "hid/input_latency.h"
+#include "hid/mouse_accumulator.h"
+#include "hid/timed_release_queue.h"
 
 namespace idrive {
 
+// Report pacing counters. All reports share one interrupt IN endpoint, so at
+// most one is in flight; everything else is merged into the pending state.
+struct HidReportStats {
+    uint32_t sent      = 0;  // Reports accepted by TinyUSB
+    uint32_t coalesced = 0;  // Updates merged into a report that was still pending
+    uint32_t dropped   = 0;  // Key/button edges lost to a full snapshot queue
+    uint32_t rejected  = 0;  // Submissions refused by TinyUSB (state kept for retry)
+    uint32_t saturated = 0;  // Mouse deltas clipped because the host stopped polling
+    uint32_t stalls    = 0;  // In-flight reports that never completed
+};
+
 // =============================================================================
 // USB HID Device Class
 // =============================================================================
@@ -26,49 +46,162 @@ class UsbHidDevice {
     UsbHidDevice(const UsbHidDevice &)            = delete;
     UsbHidDevice &operator=(const UsbHidDevice &) = delete;
 
-    // Initialize USB HID device.
-    bool Init();
+    // Route reports through a port. Call once before any input.
+    void Attach(HidPort &port) { port_ = &port; }
 
     // Check if USB device is connected and ready.
     bool IsConnected() const;
 
+    // Protocol the host selected (Report unless it asked for Boot).
+    HidProtocol GetProtocol() const;
+
     // =========================================================================
     // Keyboard Functions
     // =========================================================================
 
     void KeyPress(uint8_t keycode);
     void KeyRelease(uint8_t keycode);
+
+    // Press now, release config::kTapHoldMs later. Never blocks.
     void KeyPressAndRelease(uint8_t keycode);
 
+    // Hold keyboard modifiers (hid::key::kMod* bits) across other input, e.g.
+    // Ctrl for Ctrl+wheel zoom. Mouse motion queued before the release
+    // reaches the host while the modifier is still down; motion queued after
+    // it reaches the host after the release.
+    void ModifierPress(uint8_t modifiers);
+    void ModifierRelease(uint8_t modifiers);
+
     // =========================================================================
     // Media Control Functions (Consumer Page)
     // =========================================================================
 
     void MediaKeyPress(uint16_t keycode);
     void MediaKeyRelease(uint16_t keycode);
+
+    // Press now, release config::kTapHoldMs later. Never blocks.
     void MediaKeyPressAndRelease(uint16_t keycode);
 
     // =========================================================================
     // Mouse Functions
     // =========================================================================
 
-    void MouseMove(int8_t x, int8_t y);
+    // Motion beyond one report's range (16-bit, or +/-127 in boot protocol)
+    // is split over several reports; none of it is clipped.
+    void MouseMove(int16_t x, int16_t y);
     void MouseButtonPress(uint8_t button);
     void MouseButtonRelease(uint8_t button);
+
+    // Press now, release config::kTapHoldMs later. Never blocks.
     void MouseClick(uint8_t button);
-    void MouseScroll(int8_t wheel);
+
+    // Scroll by whole wheel detents.
+    void MouseScroll(int16_t wheel);
+
+    // Horizontal scroll (AC Pan) by whole detents, positive to the right. Not
+    // sent in boot protocol, which has no pan field.
+    void MousePan(int16_t pan);
+
+    // Scroll by 1/kWheelUnitsPerDetent detents. A host that set the
+    // resolution multiplier gets them as they are; otherwise they add up to
+    // whole detents, and a change of direction drops the fraction so backing
+    // off one detent moves back exactly one.
+    void MouseScrollHiRes(int32_t units);
+    void MousePanHiRes(int32_t units);
+
+    // Forget the fraction of a detent not sent yet (scroll gesture ended).
+    void DropScrollFraction();
+
+    // =========================================================================
+    // Digitizer Functions (TouchOutput::Digitizer)
+    // =========================================================================
+
+    // Queue a touch report. Moves merge into a pending report of the same
+    // kind; a report that lifts a contact is always sent on its own.
+    void TouchReport(const DigitizerReport &report, bool lifts);
+
+    // Sent, coalesced and dropped report counters.
+    HidReportStats GetReportStats() const;
 
     // =========================================================================
-    // TinyUSB Callbacks (called from C callbacks)
+    // Latency Instrumentation
+    // =========================================================================
+
+    // Reports queued by the calling task until EndInput() are attributed to
+    // an input of this type received from CAN at rx_us.
+    void BeginInput(LatencySource source, uint64_t rx_us);
+    void EndInput();
+
+    // Print p50/p99/max per input type, or dump all buckets as CSV.
+    void LogLatency(const char *tag) const;
+    void ExportLatencyCsv() const;
+
+    // =========================================================================
+    // Tap Engine
+    // =========================================================================
+
+    // Send every queued release that is due at now_us.
+    // Called from the port's release timer; exposed for driving with a
+    // virtual clock.
+    void ServiceReleases(uint64_t now_us);
+
+    // Counters for queued, late, preempted and overflowed releases.
+    TimedReleaseStats GetReleaseStats() const;
+
+    // =========================================================================
+    // Port Callbacks (TinyUSB C callbacks on the device)
     // =========================================================================
 
     void OnMount();
     void OnUnmount();
 
+    // The previous report reached the host; submit the next pending one.
+    void OnReportComplete();
+
+    // SET_PROTOCOL from the host. In boot protocol only the mouse is sent, in
+    // the boot layout; keyboard, consumer and touch reports are discarded.
+    void OnProtocolChange(HidProtocol protocol);
+
+    // Resolution Multiplier feature report of the mouse (SET_REPORT and
+    // GET_REPORT): kMultiplierWheelMask and kMultiplierPanMask bits. Reset to
+    // whole detents on mount; pending scroll is dropped when it changes.
+    void    OnSetResolutionMultiplier(uint8_t value);
+    uint8_t GetResolutionMultiplier() const;
+
+    // Retry anything left pending (refused submission, stalled transfer).
+    // Called from the USB task loop.
+    void FlushPending();
+
    private:
-    SemaphoreHandle_t mutex_       = nullptr;
-    bool              connected_   = false;
-    bool              initialized_ = false;
+    mutable std::mutex mutex_;
+    HidPort           *port_ = nullptr;
+    std::atomic<bool>  connected_ {false};  // Set from the USB task, read unlocked
+    HidProtocol        protocol_   = HidProtocol::Report;
+    uint8_t            multiplier_ = 0;  // Resolution Multiplier feature byte
+    TimedReleaseQueue  release_queue_ {config::kReleaseLateThreshUs};
+
+    // Report pacing. Input calls only update state; one report is submitted
+    // per completed transfer (i.e. per host poll). Key and button changes are
+    // queued as snapshots, mouse motion is summed in the accumulator.
+    HidReportQueue   edge_reports_;
+    MouseAccumulator mouse_motion_;
+    bool             report_in_flight_   = false;
+    uint64_t         in_flight_since_us_ = 0;
+    uint16_t         consumer_usage_     = 0;
+    int32_t          wheel_fraction_     = 0;  // Hi-res units short of a detent
+    int32_t          pan_fraction_       = 0;
+    HidReportStats   report_stats_;
+
+    // Latency attribution: current input (per calling task), pending motion
+    // and the report in flight.
+    uintptr_t     input_task_       = 0;
+    LatencySource input_source_     = LatencySource::None;
+    uint64_t      input_rx_us_      = 0;
+    LatencySource motion_source_    = LatencySource::None;
+    uint64_t      motion_origin_us_ = 0;
+    LatencySource in_flight_source_ = LatencySource::None;
+    uint64_t      in_flight_origin_ = 0;
+    InputLatency  latency_;
 
     // Current report states.
     struct {
@@ -77,16 +210,24 @@ class UsbHidDevice {
         uint8_t keycode[6] = {0};
     } keyboard_report_ = {};
 
-    struct {
-        uint8_t buttons = 0;
-        int8_t  x       = 0;
-        int8_t  y       = 0;
-        int8_t  wheel   = 0;
-        int8_t  pan     = 0;
-    } mouse_report_ = {};
-
-    void SendKeyboardReport();
-    void SendMouseReport();
+    MouseReport mouse_report_;
+
+    // Queue a report and submit if the endpoint is free (mutex_ held).
+    void QueueEdgeReport(uint8_t report_id, const void *data, uint8_t len, bool press);
+    void QueueMotion(int32_t x, int32_t y, int32_t wheel, int32_t pan);
+    bool HiResWheel() const;
+    bool HiResPan() const;
+    void SetScrollScale(HidProtocol protocol, uint8_t multiplier);
+    void SubmitPending();
+    bool SendReport(uint8_t report_id, const void *data, uint16_t len, LatencySource source,
+                    uint64_t origin_us);
+    LatencySource CurrentSource(uint64_t &origin_us) const;
+
+    // Tap engine helpers.
+    void Tap(TimedRelease::Kind kind, uint16_t code);
+    void Press(TimedRelease::Kind kind, uint16_t code);
+    void Release(TimedRelease::Kind kind, uint16_t code);
+    void ArmReleaseTimer(uint64_t now_us);
 };
 
 // Global instance for TinyUSB callbacks.
@@ -0,0 +1,107 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+//
+// O(1) CAN ID dispatch table for IDriveController.
+// One entry per 11-bit standard ID says where a frame goes. The fixed routes
+// (touchpad, status, our own TX echoes) are generated at compile time; the
+// protocol routes are filled in as ControllerProtocols are registered.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "can/can_filter.h"
+#include "config/config.h"
+
+namespace idrive {
+
+enum class CanRoute : uint8_t {
+    Unrouted,  // Nobody consumes this ID
+    Ignore,    // Echo of a frame we transmit
+    Touch,     // Touchpad data (all revisions)
+    Status,    // Status messages (all revisions)
+    Protocol,  // Detected on and/or handled by registered protocols
+};
+
+struct CanRouteEntry {
+    CanRoute route       = CanRoute::Unrouted;
+    uint8_t  detect_mask = 0;  // Bit i: protocol i is auto-detected by this ID
+    uint8_t  handle_mask = 0;  // Bit i: protocol i handles this ID once active
+};
+
+// Fixed routes, generated at compile time.
+constexpr std::array<CanRouteEntry, kCanStdIdCount> MakeBaseDispatchTable()
+{
+    std::array<CanRouteEntry, kCanStdIdCount> table = {};
+
+    table[can_id::kRotaryInitCmd].route = CanRoute::Ignore;
+    table[can_id::kLight].route         = CanRoute::Ignore;
+    table[can_id::kPoll].route          = CanRoute::Ignore;
+    table[can_id::kTouchInitCmd].route  = CanRoute::Ignore;
+    table[can_id::kTouch].route         = CanRoute::Touch;
+    table[can_id::kStatus].route        = CanRoute::Status;
+
+    return table;
+}
+
+class CanDispatchTable {
+   public:
+    static constexpr size_t   kIdCount      = kCanStdIdCount;
+    static constexpr size_t   kMaxProtocols = 8;
+    static constexpr uint32_t kIdMask       = kCanStdIdMask;
+
+    // Route for a received frame. Extended frames are never routed.
+    const CanRouteEntry &Lookup(uint32_t id, bool extended) const
+    {
+        if (extended || id > kIdMask) {
+            return kUnroutedEntry;
+        }
+        return table_[id];
+    }
+
+    // Register protocol number `index` as detected by `id`.
+    void AddDetection(uint32_t id, uint8_t index)
+    {
+        if (CanRouteEntry *entry = ClaimForProtocol(id)) {
+            entry->detect_mask |= 1u << index;
+        }
+    }
+
+    // Register protocol number `index` as a handler for `id`.
+    void AddHandler(uint32_t id, uint8_t index)
+    {
+        if (CanRouteEntry *entry = ClaimForProtocol(id)) {
+            entry->handle_mask |= 1u << index;
+        }
+    }
+
+    // Whether a received frame with this ID is consumed by anything.
+    bool IsConsumed(uint32_t id) const
+    {
+        CanRoute route = Lookup(id, false).route;
+        return route != CanRoute::Unrouted && route != CanRoute::Ignore;
+    }
+
+   private:
+    static constexpr CanRouteEntry kUnroutedEntry = {};
+
+    // Protocol entry for id, or nullptr if the ID has a fixed route. Fixed
+    // routes always win, as echoes/touch/status did in the old if-chain.
+    CanRouteEntry *ClaimForProtocol(uint32_t id)
+    {
+        if (id > kIdMask) {
+            return nullptr;
+        }
+        CanRouteEntry &entry = table_[id];
+        if (entry.route == CanRoute::Unrouted) {
+            entry.route = CanRoute::Protocol;
+        }
+        return entry.route == CanRoute::Protocol ? &entry : nullptr;
+    }
+
+    std::array<CanRouteEntry, kIdCount> table_ = MakeBaseDispatchTable();
+};
+
+}  // namespace idrive
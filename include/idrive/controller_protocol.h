@@ -6,14 +6,14 @@
 //
 // To add support for a new revision:
 //   1. Create a subclass of ControllerProtocol
-//   2. Register it in IDriveController::Init()
+//   2. Register it in the IDriveController constructor
 
 #pragma once
 
 #include <cstdint>
 #include <functional>
 
-#include "can/can_bus.h"
+#include "can/can_message.h"
 #include "input/input_handler.h"
 
 namespace idrive {
@@ -50,16 +50,28 @@ public:
     // Process an incoming CAN message. Use Emit() to produce InputEvents.
     virtual void OnMessage(const CanMessage &msg) = 0;
 
+    // Entry point used by IDriveController: remembers the frame's RX time so
+    // every event emitted while decoding it carries that timestamp.
+    void Receive(const CanMessage &msg)
+    {
+        rx_timestamp_us_ = msg.timestamp_us;
+        OnMessage(msg);
+    }
+
     void SetEventCallback(EventCallback cb) { callback_ = std::move(cb); }
 
 protected:
     void Emit(const InputEvent &event)
     {
-        if (callback_) callback_(event);
+        if (!callback_) return;
+        InputEvent stamped   = event;
+        stamped.timestamp_us = rx_timestamp_us_;
+        callback_(stamped);
     }
 
 private:
     EventCallback callback_;
+    uint64_t      rx_timestamp_us_ = 0;
 };
 
 }  // namespace idrive
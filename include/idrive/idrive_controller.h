@@ -6,18 +6,24 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <vector>
 
-#include "can/can_bus.h"
+#include "can/can_port.h"
 #include "config/config.h"
 #include "hid/usb_hid_device.h"
+#include "idrive/can_dispatch_table.h"
 #include "idrive/controller_protocol.h"
 #include "input/button_handler.h"
+#include "input/digitizer_encoder.h"
+#include "input/input_coalescer.h"
 #include "input/joystick_handler.h"
 #include "input/rotary_handler.h"
+#include "input/touch_filter.h"
 #include "input/touchpad_handler.h"
+#include "sched/periodic_scheduler.h"
 
 namespace idrive {
 
@@ -32,12 +38,21 @@ class OtaTrigger;
 
 class IDriveController {
    public:
-    IDriveController(CanBus &can, UsbHidDevice &hid, const Config &config);
+    IDriveController(CanPort &can, UsbHidDevice &hid, PeriodicScheduler &scheduler,
+                     const Config &config);
+
+    // Standard CAN IDs the controller consumes: everything a registered
+    // protocol handles or detects on, plus touchpad and status.
+    // Pass to CanBus::SetAcceptedIds() before CanBus::Init().
+    CanIdSet GetRxIds() const;
 
     // Initialize the controller. Call after CAN and USB are initialized.
+    // Registers the periodic CAN TX jobs with the scheduler; start the
+    // scheduler task afterwards.
     void Init();
 
-    // Update the controller state. Call regularly in the main loop.
+    // Update the controller state machine. Call regularly in the main loop.
+    // Periodic CAN traffic is sent by the scheduler, not from here.
     void Update();
 
     // Check if controller is fully initialized and ready.
@@ -54,13 +69,35 @@ class IDriveController {
     RotaryHandler   *GetRotaryHandler() { return rotary_handler_; }
     TouchpadHandler *GetTouchpadHandler() { return touchpad_handler_; }
 
+    // Touch coordinate filter run before the touchpad handler (nullptr = raw
+    // coordinates). Init() installs a One-Euro filter when config::kTouchFilter
+    // is set; replacing it resets the touch stream.
+    void SetTouchFilter(std::unique_ptr<TouchFilter> filter) { touch_filter_ = std::move(filter); }
+    TouchFilter *GetTouchFilter() { return touch_filter_.get(); }
+
+    // What the touchpad sends: gestures as mouse/keyboard input, or raw
+    // contacts as a HID touch screen. Safe from any task; the switch happens
+    // on the next touch frame, where gestures in progress end and touches
+    // still down are lifted.
+    void        SetTouchOutput(TouchOutput output) { touch_output_request_ = output; }
+    TouchOutput GetTouchOutput() const { return touch_output_request_; }
+
+    // Rotary events merged per CAN burst (events - dispatched = reports
+    // saved). Written by the CAN task; a torn read only skews a debug line.
+    CoalesceStats GetRotaryCoalesceStats() const { return rotary_coalescer_.GetStats(); }
+
+    // Decode a 0x0BF touchpad frame into a Touchpad event. Returns false for
+    // short frames and unknown touch states.
+    static bool DecodeTouchpadFrame(const CanMessage &msg, InputEvent &event);
+
     // Set OTA trigger for button combo detection.
     void SetOtaTrigger(ota::OtaTrigger *trigger) { ota_trigger_ = trigger; }
 
    private:
-    CanBus       &can_;
-    UsbHidDevice &hid_;
-    Config        config_;
+    CanPort           &can_;
+    UsbHidDevice      &hid_;
+    PeriodicScheduler &scheduler_;
+    Config             config_;
 
     // Input handlers.
     std::vector<std::unique_ptr<InputHandler>> handlers_;
@@ -68,40 +105,60 @@ class IDriveController {
     JoystickHandler                           *joystick_handler_ = nullptr;
     RotaryHandler                             *rotary_handler_   = nullptr;
     TouchpadHandler                           *touchpad_handler_ = nullptr;
+    std::unique_ptr<TouchFilter>               touch_filter_;
 
-    // Protocol detection and dispatch.
+    // Touch output mode (requested, and applied by the CAN task).
+    std::atomic<TouchOutput> touch_output_request_ {TouchOutput::Mouse};
+    TouchOutput              touch_output_ = TouchOutput::Mouse;
+    DigitizerEncoder         digitizer_;
+
+    // Rotary events held until the end of the CAN burst (CAN task only).
+    InputCoalescer rotary_coalescer_;
+
+    // Protocol detection and dispatch. The active protocol is set and reset
+    // by the CAN task and read by the main and scheduler tasks.
     std::vector<std::unique_ptr<ControllerProtocol>> protocols_;
-    ControllerProtocol                              *active_protocol_ = nullptr;
+    std::atomic<ControllerProtocol *>                active_protocol_ {nullptr};
+    uint8_t                                          active_index_ = 0;
+    CanDispatchTable                                 dispatch_;
 
-    bool ProtocolReady() const { return active_protocol_ && active_protocol_->IsReady(); }
+    static bool ProtocolReady(const ControllerProtocol *protocol)
+    {
+        return protocol && protocol->IsReady();
+    }
 
-    // Controller state.
-    bool ready_              = false;
-    bool touchpad_init_done_ = false;
-    bool touchpad_active_    = false;
-    bool light_init_done_    = false;
-    bool light_enabled_      = true;
+    void RegisterProtocol(std::unique_ptr<ControllerProtocol> protocol);
+
+    // Controller state. The touchpad flags are also read by the init retry
+    // job on the scheduler task.
+    bool              ready_ = false;
+    std::atomic<bool> touchpad_init_done_ {false};
+    std::atomic<bool> touchpad_active_ {false};
+    bool              light_init_done_ = false;
+    bool              light_enabled_   = true;
 
     int touchpad_init_ignore_counter_ = 0;
+    int touchpad_init_retry_count_    = 0;
 
     // OTA trigger (optional, for button combo detection).
     ota::OtaTrigger *ota_trigger_ = nullptr;
 
     // Timing.
-    uint32_t init_start_time_         = 0;
-    uint32_t cooldown_start_time_     = 0;
-    uint32_t last_poll_time_          = 0;
-    uint32_t last_light_time_         = 0;
-    uint32_t last_reinit_time_        = 0;
-    uint32_t last_touchpad_init_time_ = 0;
+    uint32_t init_start_time_     = 0;
+    uint32_t cooldown_start_time_ = 0;
 
     // CAN message handlers.
     void OnCanMessage(const CanMessage &msg);
+    void OnCanBurstEnd();
+    void HandleProtocolMessage(const CanMessage &msg, const CanRouteEntry &route);
     void HandleTouchpadMessage(const CanMessage &msg);
     void HandleStatusMessage(const CanMessage &msg);
+    void ApplyTouchOutput(uint64_t now_us);
+    void SendTouchReport(const InputEvent &event);
 
     // Protocol event callback (receives InputEvents from active protocol).
     void OnProtocolEvent(const InputEvent &event);
+    void FlushRotary();
 
     // Initialization commands.
     void SendRotaryInit();
@@ -109,6 +166,10 @@ class IDriveController {
     void SendLightCommand();
     void SendPollCommand();
 
+    // Scheduler jobs (run in the scheduler task).
+    void RetryTouchpadInit();
+    void RetryRotaryInit();
+
     // Input event dispatch.
     void DispatchEvent(const InputEvent &event);
 };
@@ -16,6 +16,10 @@
 //   [7]    Base 0xF8 + MAP (bit0)
 //
 // Idle/release frame: bytes[3..7] = 00 00 00 C0 F8
+//
+// Every frame carries the full button state, so each frame is diffed against
+// the previous one: all buttons that changed are reported, presses and
+// releases alike, and chords (MENU+BACK for OTA) come out as separate edges.
 
 #pragma once
 
@@ -37,13 +41,13 @@ private:
     bool     init_done_       = false;
     uint32_t position_        = 0;
     bool     position_set_    = false;
-    uint8_t  last_button_id_  = 0;
+    uint32_t buttons_         = 0;  // Pressed button bits of the last frame
+    uint8_t  stick_raw_       = 0;  // byte[3] of the last frame
     uint8_t  last_joystick_id_= 0;
     bool     joystick_active_ = false;
-    bool     menu_pressed_    = false;
-    bool     back_pressed_    = false;
 
-    void HandleButtonEdge(bool now, bool &previous, uint8_t button_id);
+    void EmitButton(uint8_t button_id, bool pressed);
+    void EmitStick(uint8_t joy_id, uint8_t state);
 };
 
 }  // namespace idrive
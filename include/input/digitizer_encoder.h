@@ -0,0 +1,54 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+//
+// Touchpad frames to HID digitizer reports (TouchOutput::Digitizer).
+// Each 0x0BF frame becomes one report. The pad sends finger positions without
+// identities, so each position is matched to the nearest contact of the
+// previous frame: a contact keeps its ID while it stays down, a new finger
+// gets a fresh ID, and a finger that lifted is reported once more with the
+// tip switch off. Coordinates are scaled from 0-511 to the logical range, Y
+// flipped to screen orientation (pad Y increases upward).
+
+#pragma once
+
+#include <cstdint>
+
+#include "hid/hid_digitizer.h"
+#include "input/input_handler.h"
+
+namespace idrive {
+
+class DigitizerEncoder {
+   public:
+    static constexpr int32_t kRawMax = 511;
+
+    // Build the report for one touchpad event. Returns true if the report
+    // lifts a contact (it must reach the host as its own report). The report
+    // is empty (count 0, nothing to send) for a lift with no contact down.
+    bool Encode(const InputEvent &event, DigitizerReport &report);
+
+    // Report that lifts every contact still down (output mode switched, pad
+    // lost). Returns false, with nothing to send, if none is down.
+    bool LiftAll(DigitizerReport &report);
+
+    uint8_t ActiveContacts() const;
+
+    // Pad coordinate to logical coordinate.
+    static uint16_t ScaleX(int32_t x);
+    static uint16_t ScaleY(int32_t y);
+
+   private:
+    struct Slot {
+        bool    active = false;
+        uint8_t id     = 0;
+        int16_t x      = 0;
+        int16_t y      = 0;
+    };
+
+    Slot    slots_[kDigitizerContacts];
+    uint8_t next_id_ = 0;
+
+    static void Put(DigitizerContact &contact, const Slot &slot, bool tip);
+};
+
+}  // namespace idrive
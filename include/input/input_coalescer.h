@@ -0,0 +1,74 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+//
+// Merges consecutive rotary events of one CAN burst into one.
+// When the dispatch task falls behind (console output, USB work), rotary
+// frames queue up and used to run the handler once each, every run queueing
+// wheel motion the next host poll would merge anyway. The controller holds
+// them here instead and passes on one event per burst with the summed delta,
+// so the total is exact. A direction change passes the held event on first,
+// so the acceleration curve still sees the reversal. The merged event keeps
+// the oldest frame's timestamp: latency is measured from the first detent.
+
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+
+#include "input/input_handler.h"
+
+namespace idrive {
+
+struct CoalesceStats {
+    uint32_t events     = 0;  // Rotary events received
+    uint32_t dispatched = 0;  // Merged events passed on (events - dispatched saved)
+};
+
+class InputCoalescer {
+   public:
+    // Hold a rotary event. Returns true if the event held so far could not
+    // take it (direction change, delta range) and was moved to `flushed`,
+    // which the caller must dispatch first.
+    bool Add(const InputEvent &event, InputEvent &flushed)
+    {
+        stats_.events++;
+        bool flush = false;
+        if (has_pending_) {
+            int32_t sum = pending_.delta + event.delta;
+            flush       = (pending_.delta < 0) != (event.delta < 0) || std::abs(sum) > INT16_MAX;
+            if (!flush) {
+                pending_.delta = static_cast<int16_t>(sum);
+                return false;
+            }
+            flushed = pending_;
+            stats_.dispatched++;
+        }
+        pending_     = event;
+        has_pending_ = true;
+        return flush;
+    }
+
+    // Take the held event, if any (end of burst, or other input follows).
+    bool Take(InputEvent &event)
+    {
+        if (!has_pending_) {
+            return false;
+        }
+        event        = pending_;
+        has_pending_ = false;
+        stats_.dispatched++;
+        return true;
+    }
+
+    bool Pending() const { return has_pending_; }
+
+    CoalesceStats GetStats() const { return stats_; }
+    void          ResetStats() { stats_ = CoalesceStats(); }
+
+   private:
+    InputEvent    pending_ {InputEvent::Type::Rotary};
+    bool          has_pending_ = false;
+    CoalesceStats stats_;
+};
+
+}  // namespace idrive
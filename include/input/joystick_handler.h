@@ -2,25 +2,46 @@
 // SPDX-License-Identifier: MIT
 //
 // Joystick input handler - mouse movement or arrow keys.
+// A push sends one arrow key or one move_step; holding it repeats the key or
+// glides the cursor from Tick(), on a timer (see input/stick_repeat.h).
 
 #pragma once
 
+#include <atomic>
+
 #include "input/input_handler.h"
+#include "input/stick_repeat.h"
 
 namespace idrive {
 
 class JoystickHandler : public InputHandler {
    public:
-    JoystickHandler(UsbHidDevice &hid, bool as_mouse, int move_step = 30);
+    // repeat_rate_hz 0 leaves a held arrow key to the host's own repeat and
+    // steps the cursor once per controller frame instead.
+    JoystickHandler(UsbHidDevice &hid, bool as_mouse, int move_step = 30,
+                    uint32_t repeat_delay_ms = 0, uint32_t repeat_rate_hz = 0);
 
     bool Handle(const InputEvent &event) override;
 
-    void SetAsMouse(bool as_mouse) { as_mouse_ = as_mouse; }
+    // Send due key repeats or glide motion. Call periodically.
+    void Tick(uint64_t now_us);
+
+    void SetAsMouse(bool as_mouse);
     bool IsMouse() const { return as_mouse_; }
 
+    void SetRepeat(uint32_t delay_ms, uint32_t rate_hz);
+    bool IsRepeating() const { return repeat_rate_hz_ != 0; }
+
+    StickRepeatStats GetRepeatStats() const { return repeat_.GetStats(); }
+
    private:
-    bool as_mouse_;
-    int  move_step_;
+    // Set from the CAN dispatch task, read by Tick() on the scheduler task.
+    std::atomic<bool>     as_mouse_;
+    int                   move_step_;
+    std::atomic<uint32_t> repeat_rate_hz_ {0};
+    StickRepeat           repeat_;
+
+    static uint8_t ArrowKey(uint8_t direction);
 };
 
 }  // namespace idrive
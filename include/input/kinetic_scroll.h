@@ -0,0 +1,212 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+//
+// Momentum (kinetic) scrolling after a two-finger flick.
+// ScrollVelocityEstimator fits a line through the last few timestamped scroll
+// positions; when the fingers lift while still moving, KineticScroller keeps
+// scrolling at that speed and decays it exponentially. The touch path only
+// starts and stops the fling; a periodic job calls Tick() at the HID poll
+// rate to emit the scroll, so nothing on the CAN path waits for it.
+// Positions are Q8 wheel detents, speeds Q8 detents per second; Tick() hands
+// out 1/kWheelUnitsPerDetent detents, so a host that set the resolution
+// multiplier sees the fling slow down smoothly rather than in whole detents.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+
+#include "hid/hid_mouse.h"
+#include "input/subpixel_accumulator.h"
+
+namespace idrive {
+
+// =============================================================================
+// Velocity Estimator
+// =============================================================================
+
+class ScrollVelocityEstimator {
+   public:
+    static constexpr size_t   kSamples   = 6;
+    static constexpr uint32_t kWindowUs  = 100000;  // Older samples are ignored
+    static constexpr uint32_t kMinSpanUs = 8000;    // Need this much history
+
+    void Reset() { count_ = 0; }
+
+    // Record the accumulated scroll position (Q8) at t_us.
+    void Add(int32_t position_q8, uint64_t t_us)
+    {
+        Sample &sample  = samples_[next_];
+        sample.position = position_q8;
+        sample.t_us     = t_us;
+        next_           = (next_ + 1) % kSamples;
+        if (count_ < kSamples) {
+            count_++;
+        }
+    }
+
+    uint64_t LastUs() const { return count_ ? Newest(0).t_us : 0; }
+
+    // Least-squares speed over the samples within kWindowUs of the newest, in
+    // Q8 units per second. 0 with too little history.
+    int32_t Velocity() const
+    {
+        if (count_ < 2) {
+            return 0;
+        }
+
+        // Times and positions relative to the newest sample keep the sums small.
+        const Sample &newest = Newest(0);
+        int64_t       n = 0, st = 0, sp = 0, stt = 0, stp = 0;
+        int64_t       span = 0;
+        for (size_t i = 0; i < count_; ++i) {
+            const Sample &sample = Newest(i);
+            int64_t       t      = static_cast<int64_t>(sample.t_us - newest.t_us);
+            int64_t       p      = sample.position - newest.position;
+            if (-t > kWindowUs) {
+                break;
+            }
+            n++;
+            st += t;
+            sp += p;
+            stt += t * t;
+            stp += t * p;
+            span = -t;
+        }
+
+        int64_t den = n * stt - st * st;
+        if (n < 2 || span < kMinSpanUs || den == 0) {
+            return 0;
+        }
+        return static_cast<int32_t>((n * stp - st * sp) * 1000000 / den);
+    }
+
+   private:
+    struct Sample {
+        int32_t  position = 0;
+        uint64_t t_us     = 0;
+    };
+
+    Sample samples_[kSamples] = {};
+    size_t next_              = 0;
+    size_t count_             = 0;
+
+    // age 0 = newest.
+    const Sample &Newest(size_t age) const
+    {
+        return samples_[(next_ + kSamples - 1 - age) % kSamples];
+    }
+};
+
+// =============================================================================
+// Kinetic Scroller
+// =============================================================================
+
+struct KineticScrollParams {
+    int32_t  min_start_q8 = 20 << 8;  // Slower lifts do not fling
+    int32_t  stop_q8      = 3 << 8;   // Fling ends below this speed
+    int32_t  max_q8       = 500 << 8;
+    uint32_t decay_us     = 325000;   // Speed time constant
+};
+
+struct KineticScrollStats {
+    uint32_t flings    = 0;  // Flings started
+    uint32_t cancelled = 0;  // Stopped by a new touch before decaying out
+    uint32_t units     = 0;  // Wheel units (1/kWheelUnitsPerDetent) emitted by flings
+};
+
+class KineticScroller {
+   public:
+    explicit KineticScroller(const KineticScrollParams &params = {}) : params_(params) {}
+
+    // Fling at velocity_q8 from now_us. Returns false (and does nothing) if
+    // the velocity is below the start threshold.
+    bool Start(int32_t velocity_q8, uint64_t now_us)
+    {
+        if (std::abs(velocity_q8) < params_.min_start_q8) {
+            return false;
+        }
+        if (velocity_q8 > params_.max_q8) {
+            velocity_q8 = params_.max_q8;
+        } else if (velocity_q8 < -params_.max_q8) {
+            velocity_q8 = -params_.max_q8;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        velocity_ = velocity_q8;
+        last_us_  = now_us;
+        active_   = true;
+        remainder_.Reset();
+        stats_.flings++;
+        return true;
+    }
+
+    // End a fling early (the pad was touched again).
+    void Stop()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (active_) {
+            active_ = false;
+            stats_.cancelled++;
+        }
+    }
+
+    bool IsActive() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return active_;
+    }
+
+    // Advance the fling to now_us. Returns the whole wheel units to send now
+    // (clamped to the report range); the fraction carries to the next tick.
+    int32_t Tick(uint64_t now_us)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!active_) {
+            return 0;
+        }
+
+        // A late tick integrates the whole gap, but not more than a quarter
+        // time constant, so the Euler decay step stays stable.
+        uint64_t dt = now_us > last_us_ ? now_us - last_us_ : 0;
+        if (dt > params_.decay_us / 4) {
+            dt = params_.decay_us / 4;
+        }
+        last_us_ = now_us;
+
+        int64_t velocity = velocity_;
+        remainder_.Add(static_cast<int32_t>(velocity * static_cast<int64_t>(dt) *
+                                            kWheelUnitsPerDetent / 1000000));
+        velocity_ -= static_cast<int32_t>(velocity * static_cast<int64_t>(dt) / params_.decay_us);
+
+        int32_t units = remainder_.Take(kMouseReportMax);
+        stats_.units += static_cast<uint32_t>(std::abs(units));
+
+        if (std::abs(velocity_) < params_.stop_q8) {
+            active_ = false;
+        }
+        return units;
+    }
+
+    void                       SetParams(const KineticScrollParams &params) { params_ = params; }
+    const KineticScrollParams &Params() const { return params_; }
+
+    KineticScrollStats GetStats() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+   private:
+    KineticScrollParams params_;
+    mutable std::mutex  mutex_;
+    bool                active_   = false;
+    int32_t             velocity_ = 0;  // Q8 detents per second
+    uint64_t            last_us_  = 0;
+    SubpixelAccumulator remainder_;
+    KineticScrollStats  stats_;
+};
+
+}  // namespace idrive
@@ -0,0 +1,66 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+//
+// One-Euro filter (Casiez et al., CHI 2012) in fixed point.
+// A first-order low-pass whose cutoff rises with the filtered speed: at rest
+// the cutoff is low and jitter is removed, when the finger moves fast the
+// cutoff goes up and lag stays small. Positions are Q4 raw units, cutoffs
+// millihertz, smoothing factors Q16.
+
+#pragma once
+
+#include <cstdint>
+
+#include "input/touch_filter.h"
+
+namespace idrive {
+
+struct OneEuroParams {
+    uint32_t min_cutoff_mhz = 10000;  // Cutoff at rest
+    uint32_t beta_mhz       = 50;     // Cutoff rise per raw unit/s of speed
+    uint32_t d_cutoff_mhz   = 1000;   // Cutoff of the speed estimate
+};
+
+// One coordinate axis.
+class OneEuroAxis {
+   public:
+    static constexpr int      kFracBits = 4;
+    static constexpr uint32_t kMinDtUs  = 1000;
+    static constexpr uint32_t kMaxDtUs  = 100000;
+
+    // Filter a raw sample taken at t_us. Returns the filtered coordinate and
+    // sets lag_us to the lag the current cutoff adds (0 on the first sample).
+    int16_t Step(int16_t raw, uint64_t t_us, const OneEuroParams &params, uint32_t &lag_us);
+
+    void Reset() { primed_ = false; }
+
+    // Smoothing factor (Q16) of a low-pass with this cutoff over dt_us, and
+    // its time constant.
+    static uint32_t Alpha(uint32_t cutoff_mhz, uint32_t dt_us);
+    static uint32_t TauUs(uint32_t cutoff_mhz);
+
+   private:
+    int32_t  value_   = 0;  // Q4 raw units
+    int32_t  speed_   = 0;  // Q4 raw units per second
+    uint64_t last_us_ = 0;
+    bool     primed_  = false;
+};
+
+class OneEuroTouchFilter : public TouchFilter {
+   public:
+    explicit OneEuroTouchFilter(const OneEuroParams &params = {}) : params_(params) {}
+
+    void        Apply(InputEvent &event) override;
+    void        Reset() override;
+    const char *Name() const override { return "one-euro"; }
+
+    void                 SetParams(const OneEuroParams &params) { params_ = params; }
+    const OneEuroParams &Params() const { return params_; }
+
+   private:
+    OneEuroParams params_;
+    OneEuroAxis   x_, y_, x2_, y2_;
+    uint8_t       last_state_ = 0;
+};
+
+}  // namespace idrive
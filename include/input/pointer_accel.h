@@ -0,0 +1,154 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+//
+// Velocity-based pointer acceleration for the touchpad.
+// Finger speed (raw pad units per ms, from CAN sample timestamps) indexes a
+// fixed-point gain table: slow movement gets a gain below 1 for precision,
+// fast swipes a gain above 1 to cross the screen. Tables are built at compile
+// time from a few control points per preset; lookups interpolate linearly
+// between entries. No floating point, one divide per sample.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+#include "config/config.h"
+
+namespace idrive {
+
+// One point of an acceleration curve.
+struct AccelPoint {
+    uint16_t speed;  // Finger speed, 1/4 raw unit per ms (table index)
+    uint16_t gain;   // Q8 gain (256 = 1.0)
+};
+
+class PointerAccel {
+   public:
+    static constexpr int      kGainShift  = 8;
+    static constexpr int32_t  kGainOne    = 1 << kGainShift;
+    static constexpr int      kSpeedShift = 8;      // Speeds are Q8 raw units per ms
+    static constexpr int      kStepShift  = 6;      // One table step = 1/4 unit/ms
+    static constexpr size_t   kTableSize  = 33;     // 0 .. 8 units/ms
+    static constexpr uint32_t kMinDtUs    = 2000;   // Faster than the pad can report
+    static constexpr uint32_t kMaxDtUs    = 50000;  // Finger paused; treat as slow
+
+    using Table = std::array<uint16_t, kTableSize>;
+
+    explicit PointerAccel(PointerAccelProfile profile = PointerAccelProfile::Linear)
+        : table_(&ProfileTable(profile)), profile_(profile)
+    {}
+
+    void SetProfile(PointerAccelProfile profile)
+    {
+        profile_ = profile;
+        table_   = &ProfileTable(profile);
+    }
+
+    PointerAccelProfile Profile() const { return profile_; }
+
+    // Q8 gain for a move of (dx, dy) raw units taking dt_us.
+    int32_t Gain(int32_t dx, int32_t dy, uint32_t dt_us) const
+    {
+        return GainAt(Speed(dx, dy, dt_us));
+    }
+
+    // Q8 gain at a speed in Q8 units/ms.
+    int32_t GainAt(uint32_t speed) const
+    {
+        uint32_t index = speed >> kStepShift;
+        if (index >= kTableSize - 1) {
+            return (*table_)[kTableSize - 1];
+        }
+        int32_t frac = static_cast<int32_t>(speed & ((1u << kStepShift) - 1));
+        int32_t lo   = (*table_)[index];
+        int32_t hi   = (*table_)[index + 1];
+        return lo + (((hi - lo) * frac) >> kStepShift);
+    }
+
+    // Finger speed in Q8 raw units per ms. Distance uses max + 3/8 min
+    // (within ~7% of Euclidean) instead of a square root.
+    static uint32_t Speed(int32_t dx, int32_t dy, uint32_t dt_us)
+    {
+        uint32_t ax   = static_cast<uint32_t>(std::abs(dx));
+        uint32_t ay   = static_cast<uint32_t>(std::abs(dy));
+        uint32_t hi   = ax > ay ? ax : ay;
+        uint32_t lo   = ax > ay ? ay : ax;
+        uint32_t dist = hi + ((lo * 3) >> 3);
+
+        if (dt_us < kMinDtUs) {
+            dt_us = kMinDtUs;
+        } else if (dt_us > kMaxDtUs) {
+            dt_us = kMaxDtUs;
+        }
+        return (dist << kSpeedShift) * 1000 / dt_us;
+    }
+
+    static const Table &ProfileTable(PointerAccelProfile profile);
+
+   private:
+    const Table        *table_;
+    PointerAccelProfile profile_;
+};
+
+// Expand control points (ascending speed, first at 0) into a full table.
+// Beyond the last point the gain stays flat.
+template <size_t M>
+constexpr PointerAccel::Table MakeAccelTable(const AccelPoint (&points)[M])
+{
+    PointerAccel::Table table = {};
+    size_t              seg   = 0;
+    for (size_t i = 0; i < PointerAccel::kTableSize; ++i) {
+        while (seg + 1 < M && points[seg + 1].speed <= i) {
+            ++seg;
+        }
+        if (seg + 1 >= M) {
+            table[i] = points[M - 1].gain;
+            continue;
+        }
+        const AccelPoint &a    = points[seg];
+        const AccelPoint &b    = points[seg + 1];
+        int32_t           span = b.speed - a.speed;
+        int32_t           pos  = static_cast<int32_t>(i) - a.speed;
+        int32_t           gain = a.gain + (static_cast<int32_t>(b.gain) - a.gain) * pos / span;
+        table[i]               = static_cast<uint16_t>(gain);
+    }
+    return table;
+}
+
+namespace accel_presets {
+
+// Constant gain: the old delta * multiplier / 10 behaviour.
+constexpr AccelPoint kLinear[] = {{0, 256}};
+
+// Smooth, steadily rising curve: half speed for slow, precise moves,
+// about 3.5x for fast swipes.
+constexpr AccelPoint kMacOs[] = {
+    {0, 128}, {1, 154}, {2, 205}, {4, 307}, {8, 512}, {12, 666}, {16, 768}, {24, 870}, {32, 896},
+};
+
+// "Enhance pointer precision" style: close to 1:1 at moderate speed, a steep
+// knee around 1-3 units/ms and a flat top.
+constexpr AccelPoint kWindows[] = {
+    {0, 154}, {2, 256}, {6, 461}, {12, 563}, {32, 614},
+};
+
+}  // namespace accel_presets
+
+inline const PointerAccel::Table &PointerAccel::ProfileTable(PointerAccelProfile profile)
+{
+    static constexpr Table kLinearTable  = MakeAccelTable(accel_presets::kLinear);
+    static constexpr Table kMacOsTable   = MakeAccelTable(accel_presets::kMacOs);
+    static constexpr Table kWindowsTable = MakeAccelTable(accel_presets::kWindows);
+
+    switch (profile) {
+        case PointerAccelProfile::MacOs:   return kMacOsTable;
+        case PointerAccelProfile::Windows: return kWindowsTable;
+        case PointerAccelProfile::Linear:  break;
+    }
+    return kLinearTable;
+}
+
+}  // namespace idrive
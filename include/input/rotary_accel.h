@@ -0,0 +1,71 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+//
+// Velocity-scaled scrolling for the rotary knob.
+// Knob speed is estimated from the timestamps of the rotary events in the
+// last config::kRotaryVelocityWindowMs and indexes a gain curve: detents
+// turned slowly scroll exactly one wheel detent each, a fast spin scrolls
+// proportionally further. Output is in high-resolution wheel units
+// (kWheelUnitsPerDetent per detent), kept in Q8 so fractions carry into the
+// next event; reversing direction starts again from rest, so backing off one
+// detent after a spin moves back exactly one.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "config/config.h"
+#include "input/subpixel_accumulator.h"
+
+namespace idrive {
+
+// One point of a rotary gain curve.
+struct RotaryGainPoint {
+    uint16_t speed;  // Knob speed, detents per second
+    uint16_t gain;   // Q8 gain (256 = 1.0)
+};
+
+class RotaryAccel {
+   public:
+    static constexpr int32_t kGainOne = SubpixelAccumulator::kOne;
+    static constexpr size_t  kHistory = 16;  // Events kept for the speed estimate
+
+    explicit RotaryAccel(RotaryAccelProfile profile = RotaryAccelProfile::Off)
+        : profile_(profile)
+    {}
+
+    void               SetProfile(RotaryAccelProfile profile);
+    RotaryAccelProfile Profile() const { return profile_; }
+
+    // Wheel units (1/kWheelUnitsPerDetent detents) for a knob delta received
+    // at t_us.
+    int32_t Apply(int32_t detents, uint64_t t_us);
+
+    // Knob speed over the window ending at the last event, detents/s.
+    uint32_t Speed() const { return speed_; }
+
+    // Q8 gain at a knob speed under the current profile.
+    int32_t GainAt(uint32_t speed) const;
+
+    // Forget the spin (rest, direction change).
+    void Reset();
+
+   private:
+    struct Sample {
+        uint64_t t_us    = 0;
+        uint16_t detents = 0;  // Magnitude; the history holds one direction
+    };
+
+    RotaryAccelProfile  profile_;
+    Sample              history_[kHistory];
+    size_t              head_      = 0;  // Next slot to write
+    size_t              count_     = 0;
+    int8_t              direction_ = 0;
+    uint32_t            speed_     = 0;
+    SubpixelAccumulator remainder_;
+
+    uint32_t EstimateSpeed(uint64_t now_us) const;
+};
+
+}  // namespace idrive
@@ -1,25 +1,32 @@
 // Copyright 2024 BMW iDrive ESP32-S3 Project
 // SPDX-License-Identifier: MIT
 //
-// Rotary encoder input handler - volume control.
+// Rotary encoder input handler - mouse wheel, accelerated on fast spins.
 
 #pragma once
 
 #include "input/input_handler.h"
+#include "input/rotary_accel.h"
 
 namespace idrive {
 
 class RotaryHandler : public InputHandler {
    public:
-    using InputHandler::InputHandler;
+    explicit RotaryHandler(UsbHidDevice &hid, RotaryAccelProfile accel = RotaryAccelProfile::Off)
+        : InputHandler(hid), accel_(accel)
+    {}
 
     bool Handle(const InputEvent &event) override;
 
     void SetEnabled(bool enabled) { enabled_ = enabled; }
     bool IsEnabled() const { return enabled_; }
 
+    void               SetAccelProfile(RotaryAccelProfile profile) { accel_.SetProfile(profile); }
+    RotaryAccelProfile GetAccelProfile() const { return accel_.Profile(); }
+
    private:
-    bool enabled_ = true;
+    bool        enabled_ = true;
+    RotaryAccel accel_;
 };
 
 }  // namespace idrive
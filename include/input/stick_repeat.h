@@ -0,0 +1,86 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+//
+// Timed repeat for a held joystick direction.
+// The controller sends a press, maybe held frames, and a release, at a cadence
+// of its own. This turns a hold into output on its own clock instead: Tick()
+// runs from a periodic job and returns the arrow key repeats that are due,
+// typematic style (first after delay_us, then every interval_us), or the
+// cursor glide of mouse mode, whose speed ramps from start_speed to max_speed
+// over ramp_us once the delay has passed. The press itself is the caller's
+// single key press or step, so a short push still moves exactly one.
+// Hardware-free: the caller maps repeats and glide to HID reports.
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+
+#include "input/subpixel_accumulator.h"
+
+namespace idrive {
+
+struct StickRepeatParams {
+    uint32_t delay_us    = 400000;   // Press to first repeat, and to the glide
+    uint32_t interval_us = 80000;    // Between key repeats
+    int32_t  start_speed = 200;      // Glide speed after the delay, pixels/s
+    int32_t  max_speed   = 1600;     // Glide speed after the ramp, pixels/s
+    uint32_t ramp_us     = 1000000;  // Start to max speed
+};
+
+struct StickRepeatStats {
+    uint32_t holds   = 0;  // Presses held past the delay
+    uint32_t repeats = 0;  // Key repeats emitted
+    uint32_t skipped = 0;  // Repeats dropped because a tick came late
+};
+
+class StickRepeat {
+   public:
+    // A late tick glides at most this long, so a stalled task does not jump
+    // the cursor.
+    static constexpr uint32_t kMaxStepUs = 50000;
+
+    explicit StickRepeat(const StickRepeatParams &params = {}) : params_(params) {}
+
+    // Press or held frame for a direction (kStick* bits) at t_us. Returns
+    // true if it starts a hold (first press, or the direction changed): the
+    // caller sends the first key press or step itself.
+    bool Press(uint8_t direction, uint64_t t_us);
+
+    // Released: repeats and glide stop.
+    void Release();
+
+    // Whether a key repeat is due at now_us. Repeats a late tick missed are
+    // skipped rather than sent in a burst.
+    bool TakeRepeat(uint64_t now_us);
+
+    // Glide since the last call, in pixels along each axis of the held
+    // direction (0 before the delay). Fractions carry to the next call.
+    void TakeGlide(uint64_t now_us, int32_t &dx, int32_t &dy);
+
+    // Held direction, 0 when released.
+    uint8_t Direction() const;
+
+    void              SetParams(const StickRepeatParams &params);
+    StickRepeatParams Params() const;
+
+    StickRepeatStats GetStats() const;
+    void             ResetStats();
+
+   private:
+    mutable std::mutex  mutex_;
+    StickRepeatParams   params_;
+    uint8_t             direction_ = 0;
+    uint64_t            press_us_  = 0;
+    uint64_t            next_us_   = 0;      // Next key repeat
+    uint64_t            glide_us_  = 0;      // Glide integrated up to here
+    bool                held_      = false;  // Past the delay
+    SubpixelAccumulator distance_;
+    StickRepeatStats    stats_;
+
+    // Caller holds mutex_.
+    int32_t SpeedAt(uint64_t t_us) const;
+    void    MarkHeld();
+};
+
+}  // namespace idrive
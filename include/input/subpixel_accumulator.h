@@ -0,0 +1,47 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+//
+// Q8 fixed-point remainder accumulator for one output axis.
+// Scaled deltas are added with 8 fractional bits; only whole units are taken
+// out, so the fraction that integer division used to discard is carried into
+// the next sample. Slow finger motion adds up instead of rounding to zero.
+
+#pragma once
+
+#include <cstdint>
+
+namespace idrive {
+
+class SubpixelAccumulator {
+   public:
+    static constexpr int     kFracBits = 8;
+    static constexpr int32_t kOne      = 1 << kFracBits;
+
+    // Add a Q8 delta (256 = one output unit).
+    void Add(int32_t delta_q8) { acc_ += delta_q8; }
+
+    // Remove the whole units accumulated, at most +/-limit per call. What is
+    // left (the fraction, plus anything beyond limit) stays for later.
+    int32_t Take(int32_t limit)
+    {
+        int32_t whole = acc_ / kOne;  // Truncates toward zero
+        if (whole > limit) {
+            whole = limit;
+        } else if (whole < -limit) {
+            whole = -limit;
+        }
+        acc_ -= whole * kOne;
+        return whole;
+    }
+
+    // Pending motion in Q8.
+    int32_t Pending() const { return acc_; }
+
+    // Forget the remainder (finger lifted, gesture changed).
+    void Reset() { acc_ = 0; }
+
+   private:
+    int32_t acc_ = 0;
+};
+
+}  // namespace idrive
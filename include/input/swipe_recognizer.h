@@ -0,0 +1,83 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+//
+// Three- and four-finger swipe recognizer.
+// A small table-driven state machine over timestamped touch samples. Each
+// sample is classified into one event (lift, release to fewer than three
+// fingers, finger count change, timeout, swipe, off-axis drift or plain move)
+// and the transition table gives the next state and whether a swipe fires. A
+// swipe fires on the sample that crosses the distance threshold, not on lift,
+// so recognition costs one table lookup per sample and never waits for a
+// later one. At most one swipe fires per contact, and a contact lasts until
+// every finger has lifted. Hardware-free: the caller maps results to HID
+// actions.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "input/input_handler.h"
+
+namespace idrive {
+
+enum class SwipeDirection : uint8_t { Up, Down, Left, Right };
+
+constexpr size_t kSwipeDirections = 4;
+
+const char *SwipeDirectionName(SwipeDirection direction);
+
+struct SwipeParams {
+    int32_t  min_distance = 80;   // Raw units along the swipe axis
+    int32_t  axis_ratio   = 2;    // Main axis must be this many times the other
+    uint32_t max_duration = 600;  // ms from the first 3/4-finger sample
+};
+
+struct SwipeResult {
+    bool           fired     = false;
+    uint8_t        fingers   = 0;  // 3 or 4
+    SwipeDirection direction = SwipeDirection::Up;
+};
+
+struct SwipeStats {
+    uint32_t contacts = 0;  // 3/4-finger contacts seen
+    uint32_t fired    = 0;  // Swipes recognized
+    uint32_t rejected = 0;  // Contacts that timed out or drifted off-axis
+};
+
+class SwipeRecognizer {
+   public:
+    enum class State : uint8_t { Idle, Tracking, Fired, Rejected, kCount };
+    enum class Event : uint8_t { Lift, Release, Count, Expired, Swipe, Drift, Move, kCount };
+
+    explicit SwipeRecognizer(const SwipeParams &params = {}) : params_(params) {}
+
+    // Feed one touchpad sample. Returns the swipe, if this sample completed one.
+    SwipeResult Feed(const InputEvent &event);
+
+    // True while a 3/4-finger contact is in progress (until all fingers lift).
+    bool  InGesture() const { return state_ != State::Idle; }
+    State GetState() const { return state_; }
+
+    void               Reset() { state_ = State::Idle; }
+    void               SetParams(const SwipeParams &params) { params_ = params; }
+    const SwipeParams &Params() const { return params_; }
+    const SwipeStats  &Stats() const { return stats_; }
+
+    // Finger count of a touch state, 0 for anything but 3 or 4 fingers.
+    static uint8_t Fingers(uint8_t touch_state);
+
+   private:
+    SwipeParams    params_;
+    SwipeStats     stats_;
+    State          state_     = State::Idle;
+    uint8_t        fingers_   = 0;
+    int16_t        anchor_x_  = 0;
+    int16_t        anchor_y_  = 0;
+    uint64_t       anchor_us_ = 0;
+    SwipeDirection direction_ = SwipeDirection::Up;  // Valid for Event::Swipe
+
+    Event Classify(const InputEvent &event, uint8_t fingers);
+};
+
+}  // namespace idrive
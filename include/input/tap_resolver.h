@@ -0,0 +1,101 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+//
+// One-finger tap classification: click, double click, tap-tap-hold drag.
+// In Deferred mode a tap is held until it is known not to start a double tap
+// or a drag: the click goes out when the double-tap window expires (from
+// Tick(), driven by a timer) or as a double click on the second lift, and a
+// tap-tap-hold presses the button without a click in front of it. FastClick
+// clicks on lift, as laptops without gesture delay do, at the cost of that
+// extra click. Hardware-free: the caller maps actions to HID reports.
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+
+#include "config/config.h"
+#include "utils/latency_histogram.h"
+
+namespace idrive {
+
+enum class TapAction : uint8_t {
+    None,
+    Click,        // Press and release
+    DoubleClick,  // Two clicks
+    DragStart,    // Press and hold
+    DragEnd,      // Release
+};
+
+struct TapParams {
+    uint32_t tap_max_us   = 200000;  // Longer touches are not taps
+    uint32_t window_us    = 300000;  // Lift to second touch-down
+    uint32_t hold_us      = 150000;  // Second touch held this long drags (Deferred)
+    int16_t  max_movement = 20;      // Raw units from touch-down
+};
+
+struct TapStats {
+    uint32_t clicks        = 0;
+    uint32_t double_clicks = 0;
+    uint32_t drags         = 0;
+};
+
+class TapResolver {
+   public:
+    explicit TapResolver(TapMode mode = TapMode::Deferred, const TapParams &params = {})
+        : mode_(mode), params_(params)
+    {
+    }
+
+    // One finger touched down, moved, or lifted (all fingers off the pad).
+    TapAction TouchDown(int16_t x, int16_t y, uint64_t t_us);
+    TapAction Move(int16_t x, int16_t y, uint64_t t_us);
+    TapAction TouchUp(uint64_t t_us);
+
+    // The contact turned into another gesture (two fingers, swipe). A tap
+    // already made still clicks; a drag ends.
+    TapAction Cancel(uint64_t t_us);
+
+    // Expire the double-tap window and start hold drags. Call periodically.
+    TapAction Tick(uint64_t now_us);
+
+    void      SetMode(TapMode mode);
+    TapMode   Mode() const { return mode_; }
+    void      SetParams(const TapParams &params) { params_ = params; }
+    TapParams Params() const { return params_; }
+
+    TapStats GetStats() const;
+
+    // Delay from the lift that completed a tap to its click being sent, i.e.
+    // what deferral adds to a click.
+    utils::LatencyHistogram ClickLatency() const;
+    void                    ResetStats();
+
+   private:
+    enum class State : uint8_t {
+        Idle,
+        Touching,     // First touch down
+        TapPending,   // Deferred: tapped, click held until the window expires
+        WaitSecond,   // FastClick: clicked, a second touch-down drags
+        SecondTouch,  // Deferred: second touch down, double tap or drag?
+        Dragging,
+    };
+
+    mutable std::mutex      mutex_;
+    TapMode                 mode_;
+    TapParams               params_;
+    State                   state_    = State::Idle;
+    uint64_t                down_us_  = 0;
+    uint64_t                lift_us_  = 0;  // Lift that ended the first tap
+    int16_t                 down_x_   = 0;
+    int16_t                 down_y_   = 0;
+    bool                    moved_    = false;
+    TapStats                stats_;
+    utils::LatencyHistogram click_latency_;
+
+    // Caller holds mutex_.
+    void      Begin(State state, int16_t x, int16_t y, uint64_t t_us);
+    TapAction Emit(TapAction action, uint64_t t_us);
+};
+
+}  // namespace idrive
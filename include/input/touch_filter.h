@@ -0,0 +1,37 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+//
+// Touch coordinate filter stage.
+// IDriveController runs touchpad events through a TouchFilter after decoding
+// the 0x0BF frame and before TouchpadHandler sees them. Filters smooth the
+// raw 9-bit coordinates in place and record how much lag they add.
+
+#pragma once
+
+#include "input/input_handler.h"
+#include "utils/latency_histogram.h"
+
+namespace idrive {
+
+class TouchFilter {
+   public:
+    virtual ~TouchFilter() = default;
+
+    // Filter event.x/y (and x2/y2 for two fingers) in place. Finger-removed
+    // events end the contact and clear the filter state.
+    virtual void Apply(InputEvent &event) = 0;
+
+    // Forget all per-finger state.
+    virtual void Reset() = 0;
+
+    virtual const char *Name() const = 0;
+
+    // Estimated lag added to each filtered sample.
+    const utils::LatencyHistogram &AddedLatency() const { return added_latency_; }
+    void                           ResetStats() { added_latency_.Reset(); }
+
+   protected:
+    utils::LatencyHistogram added_latency_;
+};
+
+}  // namespace idrive
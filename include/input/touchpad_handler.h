@@ -2,63 +2,156 @@
 // SPDX-License-Identifier: MIT
 //
 // Touchpad input handler - mouse cursor movement with tap gestures.
-// Supports: single tap (click), tap-tap-hold (drag), two-finger tap (right-click)
+// Supports: single tap (click), tap-tap-hold (drag), two-finger tap (right-click),
+// two-finger scroll with kinetic fling, two-finger pan, pinch zoom,
+// three/four-finger swipes
 
 #pragma once
 
 #include <cstdint>
 
 #include "input/input_handler.h"
+#include "input/kinetic_scroll.h"
+#include "input/pointer_accel.h"
+#include "input/subpixel_accumulator.h"
+#include "input/swipe_recognizer.h"
+#include "input/tap_resolver.h"
 
 namespace idrive {
 
+// HID action bound to a swipe: a keyboard key or a consumer usage, tapped.
+struct SwipeAction {
+    enum class Kind : uint8_t { None, Key, Consumer };
+
+    Kind     kind = Kind::None;
+    uint16_t code = 0;
+};
+
 class TouchpadHandler : public InputHandler {
    public:
     TouchpadHandler(UsbHidDevice &hid, int min_travel = 5, int x_multiplier = 10,
-                    int y_multiplier = 10);
+                    int y_multiplier = 10,
+                    PointerAccelProfile accel = PointerAccelProfile::Linear,
+                    PinchMode           pinch = PinchMode::Off,
+                    TapMode             tap   = TapMode::Deferred);
 
     bool Handle(const InputEvent &event) override;
 
+    // Pointer acceleration curve, switchable at runtime.
+    void                SetAccelProfile(PointerAccelProfile profile) { accel_.SetProfile(profile); }
+    PointerAccelProfile GetAccelProfile() const { return accel_.Profile(); }
+
+    // Emit the detents of a running fling. Called periodically (at the HID
+    // poll rate) from the scheduler task, not from the CAN path.
+    void TickKinetic(uint64_t now_us);
+
+    // Momentum scrolling after a two-finger flick.
+    void                   SetKineticEnabled(bool enabled);
+    bool                   IsKineticEnabled() const { return kinetic_enabled_; }
+    const KineticScroller &GetKinetic() const { return kinetic_; }
+
+    // Send the click of a tap once no second tap can follow, and start
+    // tap-tap-hold drags. Called periodically from the scheduler task.
+    void TickTaps(uint64_t now_us);
+
+    // When a tap clicks: after the double-tap window (Deferred) or on lift.
+    void               SetTapMode(TapMode mode) { tap_.SetMode(mode); }
+    TapMode            GetTapMode() const { return tap_.Mode(); }
+    const TapResolver &GetTapResolver() const { return tap_; }
+
+    // Horizontal two-finger scrolling (AC Pan). When disabled, two fingers
+    // only scroll vertically.
+    void SetPanEnabled(bool enabled);
+    bool IsPanEnabled() const { return pan_enabled_; }
+
+    // What a two-finger pinch sends (Off = two fingers only scroll).
+    void      SetPinchMode(PinchMode mode);
+    PinchMode GetPinchMode() const { return pinch_mode_; }
+
+    struct PinchStats {
+        uint32_t pinches = 0;  // Two-finger contacts that turned into a pinch
+        uint32_t steps   = 0;  // Zoom steps sent
+    };
+    const PinchStats &GetPinchStats() const { return pinch_stats_; }
+
+    // Three/four-finger swipes and the action each one sends. When disabled,
+    // 3/4-finger contacts move the pointer like a single finger.
+    void                   SetSwipesEnabled(bool enabled);
+    bool                   AreSwipesEnabled() const { return swipes_enabled_; }
+    void                   SetSwipeAction(uint8_t fingers, SwipeDirection direction,
+                                          SwipeAction action);
+    SwipeAction            GetSwipeAction(uint8_t fingers, SwipeDirection direction) const;
+    const SwipeRecognizer &GetSwipeRecognizer() const { return swipe_; }
+
    private:
-    int min_travel_;
-    int x_multiplier_;
-    int y_multiplier_;
+    int          min_travel_;
+    int          x_multiplier_;
+    int          y_multiplier_;
+    PointerAccel accel_;
 
     // Single finger tracking
-    int16_t prev_x_   = 0;
-    int16_t prev_y_   = 0;
-    bool    tracking_ = false;
+    int16_t  prev_x_       = 0;
+    int16_t  prev_y_       = 0;
+    uint64_t prev_move_us_ = 0;  // Sample time of prev_x_/prev_y_ (for finger speed)
+    bool     tracking_     = false;
 
     // Two-finger tracking for gestures
     int16_t prev_x2_              = 0;
     int16_t prev_y2_              = 0;
     bool    tracking_two_fingers_ = false;
 
-    // =========================================================================
-    // Tap gesture detection (laptop-style)
-    // Timing constants are in config/config.h for easy tuning
-    // =========================================================================
+    // Sub-pixel remainders of the scaled output (scroll and pan in
+    // high-resolution wheel units), cleared when a gesture ends.
+    SubpixelAccumulator pointer_x_;
+    SubpixelAccumulator pointer_y_;
+    SubpixelAccumulator scroll_;
+    SubpixelAccumulator pan_;
 
-    // Tap state machine
-    enum class TapState {
-        Idle,                 // No tap activity
-        WaitingForSecondTap,  // Single tap detected, waiting for possible second tap
-        Dragging              // Tap-tap-hold: dragging in progress
-    };
+    // Axis lock: common two-finger travel (raw units) since the contact
+    // started, and the axis it locked to once that was far enough.
+    enum class ScrollAxis : uint8_t { Free, Vertical, Horizontal };
+
+    ScrollAxis scroll_axis_ = ScrollAxis::Free;
+    int32_t    travel_x_    = 0;
+    int32_t    travel_y_    = 0;
+    bool       pan_enabled_ = true;
+
+    // Kinetic scrolling: scroll position history of the current two-finger
+    // gesture, and the fling started from it on lift.
+    ScrollVelocityEstimator scroll_velocity_;
+    int32_t                 scroll_position_ = 0;  // Q8 detents since the gesture started
+    KineticScroller         kinetic_;
+    bool                    kinetic_enabled_ = true;
+    bool                    same_contact_    = false;  // Lone finger left over from two
+
+    // Pinch: a two-finger contact is undecided until it has scrolled or
+    // pinched far enough; pinch_ref_d2_ is the squared finger spacing at the
+    // start, then at the last zoom step.
+    enum class TwoFingerMode : uint8_t { Undecided, Scroll, Pinch };
+
+    PinchMode     pinch_mode_;
+    TwoFingerMode two_finger_mode_ = TwoFingerMode::Undecided;
+    int64_t       pinch_ref_d2_    = 0;
+    PinchStats    pinch_stats_;
 
-    TapState tap_state_ = TapState::Idle;
+    // Swipes: recognizer, bindings ([fingers - 3][direction]), and whether the
+    // current contact has been a 3/4-finger one (ignored until full lift).
+    SwipeRecognizer swipe_;
+    SwipeAction     swipe_actions_[2][kSwipeDirections];
+    bool            swipes_enabled_ = true;
+    bool            swipe_contact_  = false;
 
-    // Tap detection variables
-    uint32_t touch_start_time_ = 0;  // When finger touched
-    int16_t  touch_start_x_    = 0;  // Where finger touched (for movement check)
-    int16_t  touch_start_y_    = 0;
-    uint32_t last_tap_time_    = 0;      // When last tap occurred
-    bool     touch_moved_      = false;  // Did finger move significantly?
+    // Tap, double tap and tap-tap-hold drag (timing in config/config.h).
+    TapResolver tap_;
 
     // Helper methods
-    void     HandleFingerDown(const InputEvent &event);
-    void     HandleFingerUp(const InputEvent &event);
-    uint32_t GetMillis() const;
+    void ApplyTap(TapAction action);
+    void ResetRemainders();
+    void StartFling(uint64_t lift_us);
+    bool HandleSwipe(const InputEvent &event);
+    bool HandlePinch(const InputEvent &event);
+    void EndPinch();
+    void LockScrollAxis();
 };
 
 }  // namespace idrive
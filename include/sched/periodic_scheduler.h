@@ -0,0 +1,92 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+//
+// Deadline-driven periodic scheduler.
+// Owns a small fixed set of periodic jobs and tracks how accurately each one
+// hits its period. The scheduler has no notion of real time: the caller passes
+// the current time in, which keeps it usable with a virtual clock on the host.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace idrive {
+
+// =============================================================================
+// Per-Job Timing Statistics
+// =============================================================================
+
+struct PeriodicStats {
+    uint32_t runs            = 0;           // Completed runs
+    uint32_t missed          = 0;           // Whole periods skipped after a late run
+    uint32_t last_period_us  = 0;           // Start-to-start time of the last two runs
+    uint32_t min_period_us   = UINT32_MAX;  // Shortest observed period
+    uint32_t max_period_us   = 0;           // Longest observed period
+    uint64_t total_period_us = 0;           // Sum of observed periods (for the mean)
+    uint32_t last_jitter_us  = 0;           // Lateness of the last run vs its deadline
+    uint32_t max_jitter_us   = 0;           // Worst lateness seen
+    uint64_t total_jitter_us = 0;           // Sum of lateness (for the mean)
+
+    uint32_t MeanPeriodUs() const
+    {
+        return runs > 1 ? static_cast<uint32_t>(total_period_us / (runs - 1)) : 0;
+    }
+    uint32_t MeanJitterUs() const
+    {
+        return runs > 0 ? static_cast<uint32_t>(total_jitter_us / runs) : 0;
+    }
+};
+
+// =============================================================================
+// Periodic Scheduler
+// =============================================================================
+
+class PeriodicScheduler {
+   public:
+    using JobId    = uint8_t;
+    using Callback = std::function<void()>;
+
+    static constexpr size_t   kMaxJobs    = 8;
+    static constexpr JobId    kInvalidJob = 0xFF;
+    static constexpr uint64_t kNever      = UINT64_MAX;
+
+    // Register a job that runs every period_us, first at now_us + period_us.
+    // Not thread-safe: register all jobs before the scheduler is started.
+    JobId Add(const char *name, uint32_t period_us, Callback callback, uint64_t now_us);
+
+    // Change a job's period. The next deadline is re-phased from now_us.
+    void SetPeriod(JobId id, uint32_t period_us, uint64_t now_us);
+
+    // Run every job whose deadline is <= now_us.
+    // Returns the earliest pending deadline, or kNever if there are no jobs.
+    uint64_t RunDue(uint64_t now_us);
+
+    // Earliest pending deadline, or kNever if there are no jobs.
+    uint64_t NextDeadline() const;
+
+    size_t               JobCount() const { return job_count_; }
+    const char          *GetName(JobId id) const;
+    uint32_t             GetPeriod(JobId id) const;
+    const PeriodicStats *GetStats(JobId id) const;
+    void                 ResetStats();
+
+   private:
+    struct Job {
+        const char   *name      = nullptr;
+        uint32_t      period_us = 0;
+        uint64_t      deadline  = 0;
+        uint64_t      last_run  = 0;
+        Callback      callback;
+        PeriodicStats stats;
+    };
+
+    std::array<Job, kMaxJobs> jobs_      = {};
+    size_t                    job_count_ = 0;
+
+    void RecordRun(Job &job, uint64_t now_us);
+};
+
+}  // namespace idrive
@@ -0,0 +1,67 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+//
+// Dedicated task that drives a PeriodicScheduler from esp_timer deadlines.
+// The FreeRTOS tick is too coarse for a 5 ms cadence, so the task arms a
+// one-shot esp_timer for the next deadline and sleeps until it fires.
+
+#pragma once
+
+#include <cstdint>
+
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "sched/periodic_scheduler.h"
+
+namespace idrive {
+
+// =============================================================================
+// Scheduler Task Configuration
+// =============================================================================
+
+namespace scheduler_task_config {
+
+constexpr BaseType_t  kCoreId        = 1;     // Same core as CAN RX
+constexpr UBaseType_t kPriority      = 9;     // Just below CAN RX
+constexpr uint32_t    kStackSize     = 4096;  // Stack size in bytes
+constexpr uint32_t    kMinArmUs      = 50;    // Shortest one-shot the task will arm
+constexpr uint32_t    kIdleTimeoutMs = 1000;  // Wake-up when no job is registered
+
+}  // namespace scheduler_task_config
+
+// =============================================================================
+// Scheduler Task Class
+// =============================================================================
+
+class SchedulerTask {
+   public:
+    explicit SchedulerTask(PeriodicScheduler &scheduler);
+    ~SchedulerTask();
+
+    // Start the scheduler task on specified core.
+    bool Start(BaseType_t  core_id  = scheduler_task_config::kCoreId,
+               UBaseType_t priority = scheduler_task_config::kPriority);
+
+    // Stop the scheduler task.
+    void Stop();
+
+    // Check if task is running.
+    bool IsRunning() const { return running_; }
+
+    // Log measured period and jitter of every registered job.
+    void LogStats() const;
+
+   private:
+    static void TaskFunction(void *arg);
+    static void TimerCallback(void *arg);
+    void        Run();
+
+    PeriodicScheduler &scheduler_;
+    esp_timer_handle_t timer_       = nullptr;
+    TaskHandle_t       task_handle_ = nullptr;
+    volatile bool      running_     = false;
+};
+
+}  // namespace idrive
@@ -0,0 +1,106 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+//
+// Fixed-bucket, log-scale latency histogram (microseconds).
+// Values below 8 us get a bucket each; above that every power-of-two octave
+// is split into 4 sub-buckets, so a bucket is at most 25% wide. Recording is
+// O(1) with no allocation. Percentiles report the upper bound of the bucket
+// they fall in (clamped to the exact max).
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace idrive::utils {
+
+class LatencyHistogram {
+   public:
+    static constexpr uint32_t kSubBucketBits  = 2;
+    static constexpr uint32_t kSubBuckets     = 1u << kSubBucketBits;
+    static constexpr uint32_t kMaxOctave      = 20;  // Tracked up to ~2 s
+    static constexpr size_t   kOverflowBucket = kMaxOctave * kSubBuckets;
+    static constexpr size_t   kBucketCount    = kOverflowBucket + 1;
+
+    void Record(uint32_t us)
+    {
+        counts_[BucketIndex(us)]++;
+        count_++;
+        total_us_ += us;
+        if (us > max_us_) {
+            max_us_ = us;
+        }
+        if (us < min_us_) {
+            min_us_ = us;
+        }
+    }
+
+    void Reset() { *this = LatencyHistogram(); }
+
+    uint32_t Count() const { return count_; }
+    uint32_t MaxUs() const { return max_us_; }
+    uint32_t MinUs() const { return count_ ? min_us_ : 0; }
+    uint32_t MeanUs() const { return count_ ? static_cast<uint32_t>(total_us_ / count_) : 0; }
+
+    // Latency at or below which `percent` of samples fall (0-100).
+    uint32_t PercentileUs(uint32_t percent) const
+    {
+        if (count_ == 0) {
+            return 0;
+        }
+        uint64_t target = (static_cast<uint64_t>(count_) * percent + 99) / 100;
+        if (target == 0) {
+            target = 1;
+        }
+
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBucketCount; ++i) {
+            seen += counts_[i];
+            if (seen >= target) {
+                uint32_t bound = BucketUpperBound(i);
+                return bound < max_us_ ? bound : max_us_;
+            }
+        }
+        return max_us_;
+    }
+
+    uint32_t BucketSamples(size_t index) const { return counts_[index]; }
+
+    static size_t BucketIndex(uint32_t us)
+    {
+        if (us < 2 * kSubBuckets) {
+            return us;
+        }
+        uint32_t msb = 31 - __builtin_clz(us);
+        if (msb > kMaxOctave) {
+            return kOverflowBucket;
+        }
+        uint32_t sub = (us >> (msb - kSubBucketBits)) & (kSubBuckets - 1);
+        return (msb - 1) * kSubBuckets + sub;
+    }
+
+    // Largest value that lands in bucket `index` (UINT32_MAX for overflow).
+    static uint32_t BucketUpperBound(size_t index)
+    {
+        if (index >= kOverflowBucket) {
+            return UINT32_MAX;
+        }
+        if (index < 2 * kSubBuckets) {
+            return static_cast<uint32_t>(index);
+        }
+        uint32_t msb   = static_cast<uint32_t>(index / kSubBuckets) + 1;
+        uint32_t sub   = static_cast<uint32_t>(index % kSubBuckets);
+        uint32_t width = 1u << (msb - kSubBucketBits);
+        return ((kSubBuckets + sub) << (msb - kSubBucketBits)) + width - 1;
+    }
+
+   private:
+    std::array<uint32_t, kBucketCount> counts_   = {};
+    uint32_t                           count_    = 0;
+    uint32_t                           max_us_   = 0;
+    uint32_t                           min_us_   = UINT32_MAX;
+    uint64_t                           total_us_ = 0;
+};
+
+}  // namespace idrive::utils
@@ -0,0 +1,92 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+//
+// Lock-free single-producer/single-consumer ring buffer.
+// Exactly one task may call Push() and exactly one other task may call Pop().
+// A full ring rejects the new item (the producer never waits) and counts an
+// overrun. Producer and consumer indices live on separate cache lines.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace idrive::utils {
+
+template <typename T, size_t N>
+class SpscRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing capacity must be a power of two");
+
+   public:
+    static constexpr size_t kCacheLine = 64;
+
+    // Producer side. Returns false (and counts an overrun) when full.
+    bool Push(const T &item)
+    {
+        uint32_t head = head_.load(std::memory_order_relaxed);
+        uint32_t tail = tail_.load(std::memory_order_acquire);
+        uint32_t used = head - tail;
+
+        if (used >= N) {
+            overruns_.store(overruns_.load(std::memory_order_relaxed) + 1,
+                            std::memory_order_relaxed);
+            return false;
+        }
+
+        slots_[head & kMask] = item;
+        head_.store(head + 1, std::memory_order_release);
+
+        pushed_.store(pushed_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (used + 1 > high_water_.load(std::memory_order_relaxed)) {
+            high_water_.store(used + 1, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    // Consumer side. Returns false when empty.
+    bool Pop(T &item)
+    {
+        uint32_t tail = tail_.load(std::memory_order_relaxed);
+        uint32_t head = head_.load(std::memory_order_acquire);
+
+        if (head == tail) {
+            return false;
+        }
+
+        item = slots_[tail & kMask];
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate fill level (exact when called from either end).
+    size_t Size() const
+    {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+
+    bool Empty() const { return Size() == 0; }
+
+    static constexpr size_t Capacity() { return N; }
+
+    // Statistics (written by the producer, readable from any task).
+    uint32_t Pushed() const { return pushed_.load(std::memory_order_relaxed); }
+    uint32_t Overruns() const { return overruns_.load(std::memory_order_relaxed); }
+    uint32_t HighWater() const { return high_water_.load(std::memory_order_relaxed); }
+
+   private:
+    static constexpr uint32_t kMask = N - 1;
+
+    // Producer-owned line.
+    alignas(kCacheLine) std::atomic<uint32_t> head_ {0};
+    std::atomic<uint32_t> pushed_ {0};
+    std::atomic<uint32_t> overruns_ {0};
+    std::atomic<uint32_t> high_water_ {0};
+
+    // Consumer-owned line.
+    alignas(kCacheLine) std::atomic<uint32_t> tail_ {0};
+
+    alignas(kCacheLine) T slots_[N] = {};
+};
+
+}  // namespace idrive::utils
@@ -13,6 +13,12 @@ namespace idrive::utils {
 // Returns current time in milliseconds since boot.
 uint32_t GetMillis();
 
+// Returns current time in microseconds since boot.
+uint64_t GetMicros();
+
+// Opaque identifier of the calling task (never 0).
+uintptr_t CurrentTaskId();
+
 // Constrains a value to a specified range [min_val, max_val].
 template <typename T>
 constexpr T Constrain(T value, T min_val, T max_val)
@@ -8,6 +8,9 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
+#include "config/config.h"
+#include "utils/utils.h"
+
 namespace idrive {
 
 namespace {
@@ -55,6 +58,22 @@ bool CanBus::Init(uint32_t baudrate)
 
     twai_filter_config_t filter_config = TWAI_FILTER_CONFIG_ACCEPT_ALL();
 
+    filter_ = ComputeAcceptanceFilter(accepted_ids_);
+    if (!filter_.accept_all) {
+        filter_config.acceptance_code = filter_.acceptance_code;
+        filter_config.acceptance_mask = filter_.acceptance_mask;
+        filter_config.single_filter   = filter_.single_filter;
+
+        ESP_LOGI(kTag,
+                 "Acceptance filter (%s): code=0x%08lX mask=0x%08lX, %lu wanted IDs, "
+                 "%lu accepted, false-accept rate %.1f%%",
+                 filter_.single_filter ? "single" : "dual", filter_.acceptance_code,
+                 filter_.acceptance_mask, filter_.wanted_ids, filter_.accepted_ids,
+                 filter_.FalseAcceptRate() * 100.0f);
+    } else {
+        ESP_LOGI(kTag, "Acceptance filter: accept all");
+    }
+
     esp_err_t err = twai_driver_install(&general_config, &timing_config, &filter_config);
     if (err != ESP_OK) {
         ESP_LOGE(kTag, "TWAI driver installation failed: %s", esp_err_to_name(err));
@@ -97,6 +116,18 @@ bool CanBus::Send(uint32_t id, const uint8_t *data, uint8_t length, bool extende
         return false;
     }
 
+    if (config::kCanTrace) {
+        CanMessage sent;
+        sent.id           = id;
+        sent.length       = message.data_length_code;
+        sent.extended     = extended;
+        sent.timestamp_us = utils::GetMicros();
+        for (int i = 0; i < sent.length && i < 8; ++i) {
+            sent.data[i] = message.data[i];
+        }
+        trace_.Record(sent, true);
+    }
+
     return true;
 }
 
@@ -110,6 +141,50 @@ void CanBus::SetCallback(MessageCallback callback)
     callback_ = std::move(callback);
 }
 
+void CanBus::SetBurstEndCallback(BurstEndCallback callback)
+{
+    burst_end_ = std::move(callback);
+}
+
+size_t CanBus::DispatchPending()
+{
+    size_t     count = 0;
+    CanMessage msg;
+
+    while (rx_ring_.Pop(msg)) {
+        if (callback_) {
+            callback_(msg);
+        }
+        ++count;
+    }
+
+    if (count > 0 && burst_end_) {
+        burst_end_();
+    }
+    return count;
+}
+
+void CanBus::TriggerTrace(const char *reason)
+{
+    if (!config::kCanTrace || trace_.IsTriggered()) {
+        return;
+    }
+    ESP_LOGW(kTag, "CAN trace triggered (%s), freezing in %lu ms", reason,
+             static_cast<unsigned long>(config::kCanTracePostTriggerMs));
+    trace_.Trigger(utils::GetMicros(), config::kCanTracePostTriggerMs * 1000);
+}
+
+CanRxStats CanBus::GetRxStats() const
+{
+    CanRxStats stats;
+    stats.received   = rx_ring_.Pushed();
+    stats.filtered   = filtered_count_;
+    stats.overruns   = rx_ring_.Overruns();
+    stats.high_water = rx_ring_.HighWater();
+    stats.capacity   = rx_ring_.Capacity();
+    return stats;
+}
+
 void CanBus::ProcessAlerts()
 {
     if (!initialized_)
@@ -127,10 +202,12 @@ void CanBus::HandleAlerts(uint32_t alerts)
 {
     if (alerts & TWAI_ALERT_ERR_PASS) {
         ESP_LOGW(kTag, "CAN: Error passive state");
+        TriggerTrace("error passive");
     }
 
     if (alerts & TWAI_ALERT_BUS_OFF) {
         ESP_LOGE(kTag, "CAN: Bus off state - attempting recovery");
+        TriggerTrace("bus off");
         twai_initiate_recovery();
         vTaskDelay(pdMS_TO_TICKS(1000));
     }
@@ -141,6 +218,7 @@ void CanBus::HandleAlerts(uint32_t alerts)
 
     if (alerts & TWAI_ALERT_RX_QUEUE_FULL) {
         ESP_LOGW(kTag, "CAN: RX queue full");
+        TriggerTrace("RX queue full");
     }
 }
 
@@ -149,18 +227,32 @@ void CanBus::ReceiveMessages()
     twai_message_t twai_msg;
 
     while (twai_receive(&twai_msg, 0) == ESP_OK) {
-        if (callback_) {
-            CanMessage msg;
-            msg.id       = twai_msg.identifier;
-            msg.length   = twai_msg.data_length_code;
-            msg.extended = twai_msg.extd;
+        uint64_t rx_time = utils::GetMicros();
 
-            for (int i = 0; i < msg.length && i < 8; ++i) {
-                msg.data[i] = twai_msg.data[i];
-            }
+        // Software check for IDs the hardware mask could not exclude.
+        if (!filter_.accept_all &&
+            (twai_msg.extd || !accepted_ids_.Contains(twai_msg.identifier))) {
+            ++filtered_count_;
+            continue;
+        }
 
-            callback_(msg);
+        CanMessage msg;
+        msg.id           = twai_msg.identifier;
+        msg.length       = twai_msg.data_length_code;
+        msg.extended     = twai_msg.extd;
+        msg.timestamp_us = rx_time;
+
+        for (int i = 0; i < msg.length && i < 8; ++i) {
+            msg.data[i] = twai_msg.data[i];
+        }
+
+        if (config::kCanTrace) {
+            trace_.Record(msg, false);
         }
+
+        // Hand off to the dispatch task. A full ring drops the frame and
+        // counts an overrun rather than stalling RX.
+        rx_ring_.Push(msg);
     }
 }
 
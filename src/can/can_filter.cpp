@@ -0,0 +1,182 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+
+#include "can/can_filter.h"
+
+namespace idrive {
+
+namespace {
+
+// Largest ID set for which every two-way split is tried. Above this, only
+// splits along a single ID bit are considered.
+constexpr size_t kExhaustiveLimit = 16;
+constexpr size_t kMaxIds          = 64;
+
+// Register layout for standard frames (see ESP-IDF TWAI acceptance filter docs).
+// Single filter: ID in bits 31..21, RTR and both data bytes don't-care.
+// Dual filter:   filter 1 ID in bits 31..21, filter 2 ID in bits 15..5;
+//                RTR bits and the filter 1 data nibbles don't-care.
+constexpr uint32_t kSingleIdShift     = 21;
+constexpr uint32_t kSingleDontCare    = 0x001FFFFF;
+constexpr uint32_t kDualId1Shift      = 21;
+constexpr uint32_t kDualId2Shift      = 5;
+constexpr uint32_t kDualDontCare      = 0x001F001F;
+constexpr uint32_t kDualFilter1IdBits = 0xFFE00000;
+constexpr uint32_t kDualFilter2IdBits = 0x0000FFE0;
+
+// A code/mask pair over the 11-bit ID space. dont_care bits are ignored.
+struct IdCube {
+    uint32_t code      = 0;
+    uint32_t dont_care = 0;
+
+    uint32_t Size() const { return 1u << __builtin_popcount(dont_care); }
+};
+
+IdCube Cover(const uint16_t *ids, const bool *in_group, bool group, size_t count)
+{
+    IdCube cube;
+    bool   first = true;
+
+    for (size_t i = 0; i < count; ++i) {
+        if (in_group && in_group[i] != group) {
+            continue;
+        }
+        if (first) {
+            cube.code = ids[i];
+            first     = false;
+        } else {
+            cube.dont_care |= (ids[i] ^ cube.code);
+        }
+    }
+
+    cube.code &= ~cube.dont_care & kCanStdIdMask;
+    return cube;
+}
+
+uint32_t UnionSize(const IdCube &a, const IdCube &b)
+{
+    uint32_t overlap = 0;
+    if (((a.code ^ b.code) & ~(a.dont_care | b.dont_care) & kCanStdIdMask) == 0) {
+        overlap = 1u << __builtin_popcount(a.dont_care & b.dont_care);
+    }
+    return a.Size() + b.Size() - overlap;
+}
+
+}  // namespace
+
+// =============================================================================
+// CanIdSet
+// =============================================================================
+
+size_t CanIdSet::Count() const
+{
+    size_t count = 0;
+    for (uint32_t word : words_) {
+        count += __builtin_popcount(word);
+    }
+    return count;
+}
+
+size_t CanIdSet::ToArray(uint16_t *ids, size_t max_ids) const
+{
+    size_t count = 0;
+    for (uint32_t id = 0; id < kCanStdIdCount && count < max_ids; ++id) {
+        if (Contains(id)) {
+            ids[count++] = static_cast<uint16_t>(id);
+        }
+    }
+    return count;
+}
+
+// =============================================================================
+// Acceptance Filter
+// =============================================================================
+
+bool CanAcceptanceFilter::HardwareAccepts(uint32_t id) const
+{
+    if (accept_all) {
+        return true;
+    }
+
+    if (single_filter) {
+        uint32_t bits = id << kSingleIdShift;
+        return ((bits ^ acceptance_code) & ~acceptance_mask) == 0;
+    }
+
+    uint32_t bits1 = id << kDualId1Shift;
+    uint32_t bits2 = id << kDualId2Shift;
+    return ((bits1 ^ acceptance_code) & ~acceptance_mask & kDualFilter1IdBits) == 0 ||
+           ((bits2 ^ acceptance_code) & ~acceptance_mask & kDualFilter2IdBits) == 0;
+}
+
+CanAcceptanceFilter ComputeAcceptanceFilter(const CanIdSet &ids)
+{
+    CanAcceptanceFilter filter;
+
+    uint16_t list[kMaxIds];
+    size_t   count = ids.ToArray(list, kMaxIds);
+    if (count == 0 || ids.Count() > kMaxIds) {
+        return filter;
+    }
+
+    // Single filter: one cube over every ID.
+    IdCube   best_a    = Cover(list, nullptr, false, count);
+    IdCube   best_b    = {};
+    uint32_t best_size = best_a.Size();
+    bool     dual      = false;
+
+    // Dual filter: split the set in two and cover each half.
+    bool in_group[kMaxIds] = {};
+    auto try_split         = [&]() {
+        IdCube   a    = Cover(list, in_group, false, count);
+        IdCube   b    = Cover(list, in_group, true, count);
+        uint32_t size = UnionSize(a, b);
+        if (size < best_size) {
+            best_a    = a;
+            best_b    = b;
+            best_size = size;
+            dual      = true;
+        }
+    };
+
+    if (count >= 2 && count <= kExhaustiveLimit) {
+        // The last ID always stays in group "false" so mirrored splits are skipped.
+        uint32_t splits = 1u << (count - 1);
+        for (uint32_t split = 1; split < splits; ++split) {
+            for (size_t i = 0; i < count; ++i) {
+                in_group[i] = (split >> i) & 1u;
+            }
+            try_split();
+        }
+    } else if (count > kExhaustiveLimit) {
+        for (uint32_t bit = 0; bit < 11; ++bit) {
+            size_t ones = 0;
+            for (size_t i = 0; i < count; ++i) {
+                in_group[i] = (list[i] >> bit) & 1u;
+                ones += in_group[i];
+            }
+            if (ones != 0 && ones != count) {
+                try_split();
+            }
+        }
+    }
+
+    filter.accept_all   = false;
+    filter.wanted_ids   = static_cast<uint32_t>(count);
+    filter.accepted_ids = best_size;
+
+    if (!dual) {
+        filter.single_filter   = true;
+        filter.acceptance_code = best_a.code << kSingleIdShift;
+        filter.acceptance_mask = (best_a.dont_care << kSingleIdShift) | kSingleDontCare;
+    } else {
+        filter.single_filter   = false;
+        filter.acceptance_code = (best_a.code << kDualId1Shift) | (best_b.code << kDualId2Shift);
+        filter.acceptance_mask = (best_a.dont_care << kDualId1Shift) |
+                                 (best_b.dont_care << kDualId2Shift) | kDualDontCare;
+    }
+
+    return filter;
+}
+
+}  // namespace idrive
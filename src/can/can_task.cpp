@@ -39,41 +39,62 @@ bool CanTask::Start(BaseType_t core_id, UBaseType_t priority)
 
     running_ = true;
 
+    // Dispatch task first so RX can notify it from its first frame.
+    BaseType_t ret = xTaskCreatePinnedToCore(
+        DispatchTaskFunction, "CAN_DISPATCH", can_task_config::kDispatchStackSize, this,
+        can_task_config::kDispatchPriority, &dispatch_handle_, core_id);
+
+    if (ret != pdPASS) {
+        ESP_LOGE(kTag, "Failed to create CAN dispatch task");
+        running_ = false;
+        return false;
+    }
+
     // Create task pinned to specific core for predictable performance.
-    BaseType_t ret = xTaskCreatePinnedToCore(TaskFunction, "CAN_RX", can_task_config::kStackSize,
-                                             this, priority, &task_handle_, core_id);
+    ret = xTaskCreatePinnedToCore(TaskFunction, "CAN_RX", can_task_config::kStackSize, this,
+                                  priority, &task_handle_, core_id);
 
     if (ret != pdPASS) {
         ESP_LOGE(kTag, "Failed to create CAN task");
-        running_ = false;
+        Stop();
         return false;
     }
 
-    ESP_LOGI(kTag, "CAN task started on core %d, priority %lu", static_cast<int>(core_id),
-             static_cast<unsigned long>(priority));
+    ESP_LOGI(kTag, "CAN task started on core %d, priority %lu (dispatch %lu)",
+             static_cast<int>(core_id), static_cast<unsigned long>(priority),
+             static_cast<unsigned long>(can_task_config::kDispatchPriority));
     return true;
 }
 
 void CanTask::Stop()
 {
-    if (!task_handle_) {
+    if (!task_handle_ && !dispatch_handle_) {
         return;
     }
 
     ESP_LOGI(kTag, "Stopping CAN task");
     running_ = false;
 
-    // Wake up the task so it can exit.
-    xTaskNotifyGive(task_handle_);
+    // Wake up the tasks so they can exit.
+    if (task_handle_) {
+        xTaskNotifyGive(task_handle_);
+    }
+    if (dispatch_handle_) {
+        xTaskNotifyGive(dispatch_handle_);
+    }
 
-    // Wait for task to finish.
+    // Wait for tasks to finish.
     vTaskDelay(pdMS_TO_TICKS(200));
 
-    // Delete task if still running.
+    // Delete tasks if still running.
     if (task_handle_) {
         vTaskDelete(task_handle_);
         task_handle_ = nullptr;
     }
+    if (dispatch_handle_) {
+        vTaskDelete(dispatch_handle_);
+        dispatch_handle_ = nullptr;
+    }
 }
 
 void IRAM_ATTR CanTask::NotifyFromISR(BaseType_t *higher_priority_woken)
@@ -89,6 +110,12 @@ void CanTask::TaskFunction(void *arg)
     self->Run();
 }
 
+void CanTask::DispatchTaskFunction(void *arg)
+{
+    auto *self = static_cast<CanTask *>(arg);
+    self->RunDispatch();
+}
+
 void CanTask::Run()
 {
     ESP_LOGI(kTag, "CAN task running on core %d", xPortGetCoreID());
@@ -112,6 +139,11 @@ void CanTask::Run()
             // and to maintain keepalive if needed.
             can_.ProcessAlerts();
         }
+
+        // Wake the dispatch task; decoding happens there, not here.
+        if (can_.HasPendingMessages() && dispatch_handle_) {
+            xTaskNotifyGive(dispatch_handle_);
+        }
     }
 
     ESP_LOGI(kTag, "CAN task exiting");
@@ -119,4 +151,24 @@ void CanTask::Run()
     vTaskDelete(nullptr);
 }
 
+void CanTask::RunDispatch()
+{
+    ESP_LOGI(kTag, "CAN dispatch task running on core %d", xPortGetCoreID());
+
+    while (running_) {
+        // Block until RX queues frames (timeout only guards against a lost wake-up).
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(can_task_config::kTimeoutMs));
+
+        if (!running_) {
+            break;
+        }
+
+        can_.DispatchPending();
+    }
+
+    ESP_LOGI(kTag, "CAN dispatch task exiting");
+    dispatch_handle_ = nullptr;
+    vTaskDelete(nullptr);
+}
+
 }  // namespace idrive
@@ -0,0 +1,83 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+
+#include "can/can_trace.h"
+
+namespace idrive::can_trace {
+
+size_t EncodeRecord(const CanMessage &msg, bool tx, uint64_t delta_us, uint8_t *out)
+{
+    uint8_t length = msg.length > 8 ? 8 : msg.length;
+    size_t  pos    = 0;
+
+    out[pos++] = static_cast<uint8_t>((tx ? kFlagTx : 0) | (msg.extended ? kFlagExtended : 0) |
+                                      length);
+
+    // Delta time, 7 bits per byte. Frames a few ms apart take one or two bytes.
+    do {
+        uint8_t byte = delta_us & 0x7F;
+        delta_us >>= 7;
+        out[pos++] = delta_us ? (byte | 0x80) : byte;
+    } while (delta_us);
+
+    size_t id_bytes = msg.extended ? 4 : 2;
+    for (size_t i = 0; i < id_bytes; ++i) {
+        out[pos++] = static_cast<uint8_t>(msg.id >> (8 * i));
+    }
+
+    for (uint8_t i = 0; i < length; ++i) {
+        out[pos++] = msg.data[i];
+    }
+    return pos;
+}
+
+size_t DecodeRecord(const uint8_t *data, size_t len, uint64_t &delta_us, CanMessage &msg, bool &tx)
+{
+    if (len == 0) {
+        return 0;
+    }
+
+    uint8_t flags  = data[0];
+    uint8_t length = flags & kDlcMask;
+    if (length > 8 || (flags & ~(kFlagTx | kFlagExtended | kDlcMask))) {
+        return 0;
+    }
+
+    size_t   pos   = 1;
+    uint64_t delta = 0;
+    for (int shift = 0;; shift += 7) {
+        if (pos >= len || shift > 63) {
+            return 0;
+        }
+        uint8_t byte = data[pos++];
+        delta |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            break;
+        }
+    }
+
+    bool   extended = (flags & kFlagExtended) != 0;
+    size_t id_bytes = extended ? 4 : 2;
+    if (pos + id_bytes + length > len) {
+        return 0;
+    }
+
+    uint32_t id = 0;
+    for (size_t i = 0; i < id_bytes; ++i) {
+        id |= static_cast<uint32_t>(data[pos++]) << (8 * i);
+    }
+
+    msg.id       = id;
+    msg.extended = extended;
+    msg.length   = length;
+    for (uint8_t i = 0; i < 8; ++i) {
+        msg.data[i] = i < length ? data[pos + i] : 0;
+    }
+    pos += length;
+
+    delta_us = delta;
+    tx       = (flags & kFlagTx) != 0;
+    return pos;
+}
+
+}  // namespace idrive::can_trace
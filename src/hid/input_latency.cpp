@@ -0,0 +1,81 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+
+#include "hid/input_latency.h"
+
+#include <cstdio>
+
+#include "esp_log.h"
+
+namespace idrive {
+
+namespace {
+
+constexpr LatencySource kSources[] = {
+    LatencySource::Button,
+    LatencySource::Joystick,
+    LatencySource::Rotary,
+    LatencySource::Touchpad,
+};
+
+constexpr LatencyStage kStages[] = {LatencyStage::Submit, LatencyStage::Complete};
+
+}  // namespace
+
+const char *InputLatency::SourceName(LatencySource source)
+{
+    switch (source) {
+        case LatencySource::None:     return "none";
+        case LatencySource::Button:   return "button";
+        case LatencySource::Joystick: return "joystick";
+        case LatencySource::Rotary:   return "rotary";
+        case LatencySource::Touchpad: return "touchpad";
+    }
+    return "?";
+}
+
+const char *InputLatency::StageName(LatencyStage stage)
+{
+    return stage == LatencyStage::Submit ? "submit" : "complete";
+}
+
+void InputLatency::Log(const char *tag) const
+{
+    for (LatencySource source : kSources) {
+        for (LatencyStage stage : kStages) {
+            const utils::LatencyHistogram *hist = Get(source, stage);
+            if (!hist || hist->Count() == 0) {
+                continue;
+            }
+            ESP_LOGI(tag, "Latency %-8s %-8s n=%lu p50=%lu p99=%lu max=%lu us", SourceName(source),
+                     StageName(stage), static_cast<unsigned long>(hist->Count()),
+                     static_cast<unsigned long>(hist->PercentileUs(50)),
+                     static_cast<unsigned long>(hist->PercentileUs(99)),
+                     static_cast<unsigned long>(hist->MaxUs()));
+        }
+    }
+}
+
+void InputLatency::ExportCsv() const
+{
+    printf("latency,source,stage,bucket_upper_us,samples\n");
+    for (LatencySource source : kSources) {
+        for (LatencyStage stage : kStages) {
+            const utils::LatencyHistogram *hist = Get(source, stage);
+            if (!hist) {
+                continue;
+            }
+            for (size_t i = 0; i < utils::LatencyHistogram::kBucketCount; ++i) {
+                uint32_t samples = hist->BucketSamples(i);
+                if (samples == 0) {
+                    continue;
+                }
+                printf("latency,%s,%s,%lu,%lu\n", SourceName(source), StageName(stage),
+                       static_cast<unsigned long>(utils::LatencyHistogram::BucketUpperBound(i)),
+                       static_cast<unsigned long>(samples));
+            }
+        }
+    }
+}
+
+}  // namespace idrive
@@ -0,0 +1,274 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+
+#include "hid/tinyusb_hid_port.h"
+
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "class/hid/hid_device.h"
+#include "config/config.h"
+#include "hid/hid_digitizer.h"
+#include "hid/hid_mouse.h"
+#include "tinyusb.h"
+#include "utils/utils.h"
+
+namespace idrive {
+
+namespace {
+
+const char *kTag = "USB_HID";
+
+// Combined HID report descriptor for keyboard, mouse, consumer controls and
+// the touch screen. The mouse has 16-bit X/Y, wheel and AC Pan (horizontal
+// scroll), the last two with a Resolution Multiplier. The touch screen is
+// always declared and only sends in TouchOutput::Digitizer mode, so switching
+// modes needs no re-enumeration.
+const uint8_t kHidReportDescriptor[] = {
+    TUD_HID_REPORT_DESC_KEYBOARD(HID_REPORT_ID(kReportIdKeyboard)),
+    IDRIVE_HID_REPORT_DESC_MOUSE(HID_REPORT_ID(kReportIdMouse)),
+    TUD_HID_REPORT_DESC_CONSUMER(HID_REPORT_ID(kReportIdConsumer)),
+    IDRIVE_HID_REPORT_DESC_DIGITIZER(HID_REPORT_ID(kReportIdDigitizer)),
+};
+
+// Interrupt IN endpoint size: the largest report plus its report ID.
+constexpr uint16_t kHidEndpointSize = 16;
+static_assert(sizeof(DigitizerReport) + 1 <= kHidEndpointSize, "report exceeds the endpoint");
+static_assert(sizeof(MouseReport) + 1 <= kHidEndpointSize, "report exceeds the endpoint");
+
+// USB configuration descriptor. The interface is a boot mouse, so BIOS and
+// KVM hosts that never parse the report descriptor can still select boot
+// protocol and get a pointer.
+const uint8_t kHidConfigurationDescriptor[] = {
+    TUD_CONFIG_DESCRIPTOR(1, 1, 0, TUD_CONFIG_DESC_LEN + TUD_HID_DESC_LEN, 0, 100),
+    TUD_HID_DESCRIPTOR(0, 0, HID_ITF_PROTOCOL_MOUSE, sizeof(kHidReportDescriptor), 0x81,
+                       kHidEndpointSize, config::kHidPollIntervalMs),
+};
+
+// Global instance for TinyUSB callbacks.
+UsbHidDevice *g_usb_hid_instance = nullptr;
+
+// USB device task.
+void UsbDeviceTask(void *arg)
+{
+    (void) arg;
+    while (true) {
+        tud_task();
+        if (g_usb_hid_instance) {
+            g_usb_hid_instance->FlushPending();
+        }
+        vTaskDelay(pdMS_TO_TICKS(1));
+    }
+}
+
+}  // namespace
+
+// =============================================================================
+// TinyUSB Callbacks
+// =============================================================================
+
+extern "C" {
+
+void tud_mount_cb(void)
+{
+    ESP_LOGI(kTag, "USB mounted");
+    if (g_usb_hid_instance) {
+        g_usb_hid_instance->OnMount();
+    }
+}
+
+void tud_umount_cb(void)
+{
+    ESP_LOGI(kTag, "USB unmounted");
+    if (g_usb_hid_instance) {
+        g_usb_hid_instance->OnUnmount();
+    }
+}
+
+void tud_suspend_cb(bool remote_wakeup_en)
+{
+    (void) remote_wakeup_en;
+    ESP_LOGI(kTag, "USB suspended");
+}
+
+void tud_resume_cb(void)
+{
+    ESP_LOGI(kTag, "USB resumed");
+}
+
+uint8_t const *tud_hid_descriptor_report_cb(uint8_t itf)
+{
+    (void) itf;
+    return kHidReportDescriptor;
+}
+
+uint16_t tud_hid_get_report_cb(uint8_t itf, uint8_t report_id, hid_report_type_t report_type,
+                               uint8_t *buffer, uint16_t reqlen)
+{
+    (void) itf;
+    if (report_type != HID_REPORT_TYPE_FEATURE || reqlen < 1) {
+        return 0;
+    }
+
+    // Contact Count Maximum feature of the touch screen collection.
+    if (report_id == kReportIdDigitizer) {
+        buffer[0] = static_cast<uint8_t>(kDigitizerContacts);
+        return 1;
+    }
+
+    // Wheel and pan Resolution Multipliers.
+    if (report_id == kReportIdMouse && g_usb_hid_instance) {
+        buffer[0] = g_usb_hid_instance->GetResolutionMultiplier();
+        return 1;
+    }
+    return 0;
+}
+
+void tud_hid_report_complete_cb(uint8_t instance, uint8_t const *report, uint16_t len)
+{
+    (void) instance;
+    (void) report;
+    (void) len;
+    if (g_usb_hid_instance) {
+        g_usb_hid_instance->OnReportComplete();
+    }
+}
+
+void tud_hid_set_protocol_cb(uint8_t instance, uint8_t protocol)
+{
+    (void) instance;
+    ESP_LOGI(kTag, "Host selected %s protocol", protocol == HID_PROTOCOL_BOOT ? "boot" : "report");
+    if (g_usb_hid_instance) {
+        g_usb_hid_instance->OnProtocolChange(protocol == HID_PROTOCOL_BOOT ? HidProtocol::Boot
+                                                                           : HidProtocol::Report);
+    }
+}
+
+void tud_hid_set_report_cb(uint8_t itf, uint8_t report_id, hid_report_type_t report_type,
+                           uint8_t const *buffer, uint16_t bufsize)
+{
+    (void) itf;
+
+    // Wheel and pan Resolution Multipliers (TinyUSB strips the report ID).
+    // Windows and Linux set them at enumeration; macOS never does.
+    if (report_id == kReportIdMouse && report_type == HID_REPORT_TYPE_FEATURE && bufsize >= 1) {
+        ESP_LOGI(kTag, "Host set wheel resolution %s, pan %s",
+                 (buffer[0] & kMultiplierWheelMask) ? "high" : "detents",
+                 (buffer[0] & kMultiplierPanMask) ? "high" : "detents");
+        if (g_usb_hid_instance) {
+            g_usb_hid_instance->OnSetResolutionMultiplier(buffer[0]);
+        }
+    }
+}
+
+}  // extern "C"
+
+// =============================================================================
+// TinyUsbHidPort Implementation
+// =============================================================================
+
+bool TinyUsbHidPort::Init(UsbHidDevice &device)
+{
+    ESP_LOGI(kTag, "Initializing USB HID device");
+
+    esp_timer_create_args_t timer_args = {};
+    timer_args.callback                = ReleaseTimerCallback;
+    timer_args.arg                     = this;
+    timer_args.dispatch_method         = ESP_TIMER_TASK;
+    timer_args.name                    = "hid_release";
+    if (esp_timer_create(&timer_args, &release_timer_) != ESP_OK) {
+        ESP_LOGE(kTag, "Failed to create release timer");
+        return false;
+    }
+
+    device_            = &device;
+    g_usb_hid_instance = &device;
+    device.Attach(*this);
+
+    // USB device descriptor.
+    static tusb_desc_device_t descriptor = {
+        .bLength            = sizeof(descriptor),
+        .bDescriptorType    = TUSB_DESC_DEVICE,
+        .bcdUSB             = 0x0200,
+        .bDeviceClass       = 0,
+        .bDeviceSubClass    = 0,
+        .bDeviceProtocol    = 0,
+        .bMaxPacketSize0    = CFG_TUD_ENDPOINT0_SIZE,
+        .idVendor           = config::kUsbVendorId,
+        .idProduct          = config::kUsbProductId,
+        .bcdDevice          = 0x0100,
+        .iManufacturer      = 0x01,
+        .iProduct           = 0x02,
+        .iSerialNumber      = 0x03,
+        .bNumConfigurations = 0x01,
+    };
+
+    static const char  kLanguageDescriptor[] = {0x09, 0x04};
+    static const char *kStringDescriptor[]   = {
+        kLanguageDescriptor,      config::kUsbManufacturer, config::kUsbProduct,
+        config::kUsbSerialNumber, "HID Interface",
+    };
+
+    tinyusb_config_t tusb_cfg = {
+        .device_descriptor        = &descriptor,
+        .string_descriptor        = kStringDescriptor,
+        .string_descriptor_count  = sizeof(kStringDescriptor) / sizeof(kStringDescriptor[0]),
+        .external_phy             = false,
+        .configuration_descriptor = kHidConfigurationDescriptor,
+        .self_powered             = false,
+        .vbus_monitor_io          = -1,
+    };
+
+    esp_err_t err = tinyusb_driver_install(&tusb_cfg);
+    if (err != ESP_OK) {
+        ESP_LOGE(kTag, "TinyUSB driver install failed: %s", esp_err_to_name(err));
+        return false;
+    }
+
+    // Pin TinyUSB task to Core 0 (system core) to avoid contention with
+    // real-time CAN processing on Core 1.
+    xTaskCreatePinnedToCore(UsbDeviceTask, "TinyUSB", 4096, nullptr,
+                            5,  // Priority
+                            nullptr,
+                            0  // Core 0 (PRO_CPU)
+    );
+
+    ESP_LOGI(kTag, "USB HID initialized on core 0");
+    return true;
+}
+
+bool TinyUsbHidPort::IsMounted() const
+{
+    return tud_ready();
+}
+
+bool TinyUsbHidPort::IsReady() const
+{
+    return tud_hid_ready();
+}
+
+bool TinyUsbHidPort::SendReport(uint8_t report_id, const void *data, uint16_t len)
+{
+    return tud_hid_n_report(0, report_id, data, len);
+}
+
+void TinyUsbHidPort::ArmReleaseTimer(uint64_t delay_us)
+{
+    // An armed timer fires for an earlier (or equal) release; the device
+    // re-arms for the rest when it services that one.
+    if (!release_timer_ || esp_timer_is_active(release_timer_)) {
+        return;
+    }
+    esp_timer_start_once(release_timer_, delay_us);
+}
+
+void TinyUsbHidPort::ReleaseTimerCallback(void *arg)
+{
+    auto *self = static_cast<TinyUsbHidPort *>(arg);
+    if (self->device_) {
+        self->device_->ServiceReleases(utils::GetMicros());
+    }
+}
+
+}  // namespace idrive
@@ -5,51 +5,29 @@
 
 #include <cstring>
 
-#include "esp_log.h"
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
-
-#include "class/hid/hid_device.h"
 #include "config/config.h"
-#include "tinyusb.h"
+#include "utils/utils.h"
 
 namespace idrive {
 
-namespace {
-
-const char *kTag = "USB_HID";
-
-// Report IDs for different HID functions.
-enum ReportId {
-    kReportIdKeyboard = 1,
-    kReportIdMouse    = 2,
-    kReportIdConsumer = 3,
-};
+static_assert(sizeof(DigitizerReport) <= HidReportSnapshot::kMaxLen,
+              "digitizer report must fit a queued snapshot");
+static_assert(sizeof(MouseReport) <= HidReportSnapshot::kMaxLen,
+              "mouse report must fit a queued snapshot");
 
-// Combined HID report descriptor for keyboard, mouse, and consumer controls.
-const uint8_t kHidReportDescriptor[] = {
-    TUD_HID_REPORT_DESC_KEYBOARD(HID_REPORT_ID(kReportIdKeyboard)),
-    TUD_HID_REPORT_DESC_MOUSE(HID_REPORT_ID(kReportIdMouse)),
-    TUD_HID_REPORT_DESC_CONSUMER(HID_REPORT_ID(kReportIdConsumer)),
-};
-
-// USB configuration descriptor.
-const uint8_t kHidConfigurationDescriptor[] = {
-    TUD_CONFIG_DESCRIPTOR(1, 1, 0, TUD_CONFIG_DESC_LEN + TUD_HID_DESC_LEN, 0, 100),
-    TUD_HID_DESCRIPTOR(0, 0, false, sizeof(kHidReportDescriptor), 0x81, 16, 10),
-};
-
-// Global instance for TinyUSB callbacks.
-UsbHidDevice *g_usb_hid_instance = nullptr;
+namespace {
 
-// USB device task.
-void UsbDeviceTask(void *arg)
+// Whole detents out of high-resolution units, for a host that reads detents.
+// The fraction carries to the next call in the same direction only.
+int32_t TakeDetents(int32_t units, int32_t &fraction)
 {
-    (void) arg;
-    while (true) {
-        tud_task();
-        vTaskDelay(pdMS_TO_TICKS(1));
+    if ((fraction < 0 && units > 0) || (fraction > 0 && units < 0)) {
+        fraction = 0;
     }
+    fraction += units;
+    int32_t detents = fraction / kWheelUnitsPerDetent;
+    fraction -= detents * kWheelUnitsPerDetent;
+    return detents;
 }
 
 }  // namespace
@@ -65,297 +43,617 @@ UsbHidDevice &GetUsbHidDevice()
 }
 
 // =============================================================================
-// TinyUSB Callbacks
+// UsbHidDevice Implementation
 // =============================================================================
 
-extern "C" {
-
-void tud_mount_cb(void)
+bool UsbHidDevice::IsConnected() const
 {
-    ESP_LOGI(kTag, "USB mounted");
-    if (g_usb_hid_instance) {
-        g_usb_hid_instance->OnMount();
-    }
+    return connected_ && port_ && port_->IsMounted();
 }
 
-void tud_umount_cb(void)
+HidProtocol UsbHidDevice::GetProtocol() const
 {
-    ESP_LOGI(kTag, "USB unmounted");
-    if (g_usb_hid_instance) {
-        g_usb_hid_instance->OnUnmount();
-    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    return protocol_;
 }
 
-void tud_suspend_cb(bool remote_wakeup_en)
+void UsbHidDevice::OnMount()
 {
-    (void) remote_wakeup_en;
-    ESP_LOGI(kTag, "USB suspended");
+    // Input is let in only once the state below is reset.
+    std::lock_guard<std::mutex> lock(mutex_);
+    report_in_flight_ = false;
+    // A bus reset puts the interface back in report protocol and the wheel
+    // back to whole detents.
+    SetScrollScale(HidProtocol::Report, 0);
+    connected_ = true;
 }
 
-void tud_resume_cb(void)
+void UsbHidDevice::OnUnmount()
 {
-    ESP_LOGI(kTag, "USB resumed");
+    std::lock_guard<std::mutex> lock(mutex_);
+    connected_ = false;
+    // Nothing in flight will complete; stale motion must not replay on
+    // the next mount.
+    report_in_flight_ = false;
+    edge_reports_.Clear();
+    mouse_motion_.Clear();
+    wheel_fraction_ = 0;
+    pan_fraction_   = 0;
 }
 
-uint8_t const *tud_hid_descriptor_report_cb(uint8_t itf)
+// =============================================================================
+// Keyboard Functions
+// =============================================================================
+
+void UsbHidDevice::KeyPress(uint8_t keycode)
 {
-    (void) itf;
-    return kHidReportDescriptor;
+    if (!IsConnected())
+        return;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (int i = 0; i < 6; ++i) {
+        if (keyboard_report_.keycode[i] == 0) {
+            keyboard_report_.keycode[i] = keycode;
+            break;
+        }
+    }
+    QueueEdgeReport(kReportIdKeyboard, &keyboard_report_, sizeof(keyboard_report_), true);
 }
 
-uint16_t tud_hid_get_report_cb(uint8_t itf, uint8_t report_id, hid_report_type_t report_type,
-                               uint8_t *buffer, uint16_t reqlen)
+void UsbHidDevice::KeyRelease(uint8_t keycode)
 {
-    (void) itf;
-    (void) report_type;
-    (void) reqlen;
-    (void) report_id;
-    (void) buffer;
-    return 0;
+    if (!IsConnected())
+        return;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (int i = 0; i < 6; ++i) {
+        if (keyboard_report_.keycode[i] == keycode) {
+            keyboard_report_.keycode[i] = 0;
+            break;
+        }
+    }
+    QueueEdgeReport(kReportIdKeyboard, &keyboard_report_, sizeof(keyboard_report_), false);
 }
 
-void tud_hid_set_report_cb(uint8_t itf, uint8_t report_id, hid_report_type_t report_type,
-                           uint8_t const *buffer, uint16_t bufsize)
+void UsbHidDevice::KeyPressAndRelease(uint8_t keycode)
 {
-    (void) itf;
-    (void) report_id;
-    (void) report_type;
-    (void) buffer;
-    (void) bufsize;
+    Tap(TimedRelease::Kind::Key, keycode);
 }
 
-}  // extern "C"
+void UsbHidDevice::ModifierPress(uint8_t modifiers)
+{
+    if (!IsConnected())
+        return;
 
-// =============================================================================
-// UsbHidDevice Implementation
-// =============================================================================
+    std::lock_guard<std::mutex> lock(mutex_);
+    keyboard_report_.modifier |= modifiers;
+    QueueEdgeReport(kReportIdKeyboard, &keyboard_report_, sizeof(keyboard_report_), true);
+}
 
-bool UsbHidDevice::Init()
+void UsbHidDevice::ModifierRelease(uint8_t modifiers)
 {
-    ESP_LOGI(kTag, "Initializing USB HID device");
+    if (!IsConnected())
+        return;
 
-    mutex_ = xSemaphoreCreateMutex();
-    if (!mutex_) {
-        ESP_LOGE(kTag, "Failed to create mutex");
-        return false;
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Edges go out ahead of accumulated motion, so move the motion pending now
+    // into mouse snapshots queued before the release. Motion queued after this
+    // stays in the accumulator and follows the release. One slot is kept for
+    // the release itself; whatever does not fit trails it.
+    int32_t limit = protocol_ == HidProtocol::Boot ? kBootMouseReportMax : kMouseReportMax;
+    while (mouse_motion_.Pending() && edge_reports_.Size() + 1 < HidReportQueue::kCapacity) {
+        MouseAccumulator::Chunk chunk  = mouse_motion_.Take(limit);
+        MouseReport             report = mouse_report_;
+        report.x                       = chunk.x;
+        report.y                       = chunk.y;
+        report.wheel                   = chunk.wheel;
+        report.pan                     = chunk.pan;
+        edge_reports_.Push(kReportIdMouse, &report, sizeof(report), false, motion_source_,
+                           motion_origin_us_, true);
     }
+    keyboard_report_.modifier &= static_cast<uint8_t>(~modifiers);
+    QueueEdgeReport(kReportIdKeyboard, &keyboard_report_, sizeof(keyboard_report_), false);
+}
 
-    g_usb_hid_instance = this;
-
-    // USB device descriptor.
-    static tusb_desc_device_t descriptor = {
-        .bLength            = sizeof(descriptor),
-        .bDescriptorType    = TUSB_DESC_DEVICE,
-        .bcdUSB             = 0x0200,
-        .bDeviceClass       = 0,
-        .bDeviceSubClass    = 0,
-        .bDeviceProtocol    = 0,
-        .bMaxPacketSize0    = CFG_TUD_ENDPOINT0_SIZE,
-        .idVendor           = config::kUsbVendorId,
-        .idProduct          = config::kUsbProductId,
-        .bcdDevice          = 0x0100,
-        .iManufacturer      = 0x01,
-        .iProduct           = 0x02,
-        .iSerialNumber      = 0x03,
-        .bNumConfigurations = 0x01,
-    };
-
-    static const char  kLanguageDescriptor[] = {0x09, 0x04};
-    static const char *kStringDescriptor[]   = {
-        kLanguageDescriptor,      config::kUsbManufacturer, config::kUsbProduct,
-        config::kUsbSerialNumber, "HID Interface",
-    };
-
-    tinyusb_config_t tusb_cfg = {
-        .device_descriptor        = &descriptor,
-        .string_descriptor        = kStringDescriptor,
-        .string_descriptor_count  = sizeof(kStringDescriptor) / sizeof(kStringDescriptor[0]),
-        .external_phy             = false,
-        .configuration_descriptor = kHidConfigurationDescriptor,
-        .self_powered             = false,
-        .vbus_monitor_io          = -1,
-    };
-
-    esp_err_t err = tinyusb_driver_install(&tusb_cfg);
-    if (err != ESP_OK) {
-        ESP_LOGE(kTag, "TinyUSB driver install failed: %s", esp_err_to_name(err));
-        return false;
-    }
+// =============================================================================
+// Media Control Functions
+// =============================================================================
 
-    // Pin TinyUSB task to Core 0 (system core) to avoid contention with
-    // real-time CAN processing on Core 1.
-    xTaskCreatePinnedToCore(UsbDeviceTask, "TinyUSB", 4096, nullptr,
-                            5,  // Priority
-                            nullptr,
-                            0  // Core 0 (PRO_CPU)
-    );
+void UsbHidDevice::MediaKeyPress(uint16_t keycode)
+{
+    if (!IsConnected())
+        return;
 
-    initialized_ = true;
-    ESP_LOGI(kTag, "USB HID initialized on core 0");
-    return true;
+    std::lock_guard<std::mutex> lock(mutex_);
+    consumer_usage_ = keycode;
+    QueueEdgeReport(kReportIdConsumer, &consumer_usage_, sizeof(consumer_usage_), true);
 }
 
-bool UsbHidDevice::IsConnected() const
+void UsbHidDevice::MediaKeyRelease(uint16_t keycode)
 {
-    return connected_ && tud_ready();
-}
+    (void) keycode;
+    if (!IsConnected())
+        return;
 
-void UsbHidDevice::OnMount()
-{
-    connected_ = true;
+    std::lock_guard<std::mutex> lock(mutex_);
+    consumer_usage_ = 0;
+    QueueEdgeReport(kReportIdConsumer, &consumer_usage_, sizeof(consumer_usage_), false);
 }
 
-void UsbHidDevice::OnUnmount()
+void UsbHidDevice::MediaKeyPressAndRelease(uint16_t keycode)
 {
-    connected_ = false;
+    Tap(TimedRelease::Kind::MediaKey, keycode);
 }
 
 // =============================================================================
-// Keyboard Functions
+// Mouse Functions
 // =============================================================================
 
-void UsbHidDevice::KeyPress(uint8_t keycode)
+void UsbHidDevice::MouseMove(int16_t x, int16_t y)
 {
     if (!IsConnected())
         return;
 
-    if (xSemaphoreTake(mutex_, portMAX_DELAY) == pdTRUE) {
-        for (int i = 0; i < 6; ++i) {
-            if (keyboard_report_.keycode[i] == 0) {
-                keyboard_report_.keycode[i] = keycode;
-                break;
-            }
-        }
-        SendKeyboardReport();
-        xSemaphoreGive(mutex_);
-    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    QueueMotion(x, y, 0, 0);
 }
 
-void UsbHidDevice::KeyRelease(uint8_t keycode)
+void UsbHidDevice::MouseButtonPress(uint8_t button)
 {
     if (!IsConnected())
         return;
 
-    if (xSemaphoreTake(mutex_, portMAX_DELAY) == pdTRUE) {
-        for (int i = 0; i < 6; ++i) {
-            if (keyboard_report_.keycode[i] == keycode) {
-                keyboard_report_.keycode[i] = 0;
-                break;
-            }
-        }
-        SendKeyboardReport();
-        xSemaphoreGive(mutex_);
-    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    mouse_report_.buttons |= button;
+    QueueEdgeReport(kReportIdMouse, &mouse_report_, sizeof(mouse_report_), true);
 }
 
-void UsbHidDevice::KeyPressAndRelease(uint8_t keycode)
+void UsbHidDevice::MouseButtonRelease(uint8_t button)
 {
-    KeyPress(keycode);
-    vTaskDelay(pdMS_TO_TICKS(50));
-    KeyRelease(keycode);
+    if (!IsConnected())
+        return;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    mouse_report_.buttons &= ~button;
+    QueueEdgeReport(kReportIdMouse, &mouse_report_, sizeof(mouse_report_), false);
 }
 
-void UsbHidDevice::SendKeyboardReport()
+void UsbHidDevice::MouseClick(uint8_t button)
 {
-    tud_hid_n_report(0, kReportIdKeyboard, &keyboard_report_, sizeof(keyboard_report_));
+    Tap(TimedRelease::Kind::MouseButton, button);
 }
 
-// =============================================================================
-// Media Control Functions
-// =============================================================================
+void UsbHidDevice::MouseScroll(int16_t wheel)
+{
+    if (!IsConnected())
+        return;
 
-void UsbHidDevice::MediaKeyPress(uint16_t keycode)
+    std::lock_guard<std::mutex> lock(mutex_);
+    QueueMotion(0, 0, HiResWheel() ? wheel * kWheelUnitsPerDetent : wheel, 0);
+}
+
+void UsbHidDevice::MousePan(int16_t pan)
 {
     if (!IsConnected())
         return;
 
-    uint16_t usage = keycode;
-    tud_hid_n_report(0, kReportIdConsumer, &usage, sizeof(usage));
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (protocol_ == HidProtocol::Boot) {
+        return;  // No pan field; it would only send empty reports
+    }
+    QueueMotion(0, 0, 0, HiResPan() ? pan * kWheelUnitsPerDetent : pan);
 }
 
-void UsbHidDevice::MediaKeyRelease(uint16_t keycode)
+void UsbHidDevice::MouseScrollHiRes(int32_t units)
 {
-    (void) keycode;
     if (!IsConnected())
         return;
 
-    uint16_t usage = 0;
-    tud_hid_n_report(0, kReportIdConsumer, &usage, sizeof(usage));
+    std::lock_guard<std::mutex> lock(mutex_);
+    int32_t wheel = HiResWheel() ? units : TakeDetents(units, wheel_fraction_);
+    if (wheel != 0) {
+        QueueMotion(0, 0, wheel, 0);
+    }
 }
 
-void UsbHidDevice::MediaKeyPressAndRelease(uint16_t keycode)
+void UsbHidDevice::MousePanHiRes(int32_t units)
+{
+    if (!IsConnected())
+        return;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (protocol_ == HidProtocol::Boot) {
+        return;
+    }
+    int32_t pan = HiResPan() ? units : TakeDetents(units, pan_fraction_);
+    if (pan != 0) {
+        QueueMotion(0, 0, 0, pan);
+    }
+}
+
+void UsbHidDevice::DropScrollFraction()
 {
-    MediaKeyPress(keycode);
-    vTaskDelay(pdMS_TO_TICKS(50));
-    MediaKeyRelease(keycode);
+    std::lock_guard<std::mutex> lock(mutex_);
+    wheel_fraction_ = 0;
+    pan_fraction_   = 0;
 }
 
 // =============================================================================
-// Mouse Functions
+// Digitizer Functions
 // =============================================================================
 
-void UsbHidDevice::MouseMove(int8_t x, int8_t y)
+void UsbHidDevice::TouchReport(const DigitizerReport &report, bool lifts)
 {
     if (!IsConnected())
         return;
 
-    if (xSemaphoreTake(mutex_, portMAX_DELAY) == pdTRUE) {
-        mouse_report_.x = x;
-        mouse_report_.y = y;
-        SendMouseReport();
-        mouse_report_.x = 0;
-        mouse_report_.y = 0;
-        xSemaphoreGive(mutex_);
+    // Touch reports are full state. Queued as edges they merge like button
+    // presses do: moves into the latest pending move, while a lift stays a
+    // report of its own so the host always sees the contact go up.
+    std::lock_guard<std::mutex> lock(mutex_);
+    QueueEdgeReport(kReportIdDigitizer, &report, sizeof(report), !lifts);
+}
+
+HidReportStats UsbHidDevice::GetReportStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return report_stats_;
+}
+
+// =============================================================================
+// Report Pacing
+// =============================================================================
+
+void UsbHidDevice::OnReportComplete()
+{
+    uint64_t now = utils::GetMicros();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (report_in_flight_ && in_flight_source_ != LatencySource::None) {
+        latency_.Record(in_flight_source_, LatencyStage::Complete,
+                        static_cast<uint32_t>(now - in_flight_origin_));
     }
+    report_in_flight_ = false;
+    SubmitPending();
 }
 
-void UsbHidDevice::MouseButtonPress(uint8_t button)
+void UsbHidDevice::FlushPending()
 {
-    if (!IsConnected())
-        return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    SubmitPending();
+}
 
-    if (xSemaphoreTake(mutex_, portMAX_DELAY) == pdTRUE) {
-        mouse_report_.buttons |= button;
-        SendMouseReport();
-        xSemaphoreGive(mutex_);
+void UsbHidDevice::OnProtocolChange(HidProtocol protocol)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    SetScrollScale(protocol, multiplier_);
+    if (protocol == HidProtocol::Boot) {
+        mouse_motion_.ClearPan();
     }
+    SubmitPending();
 }
 
-void UsbHidDevice::MouseButtonRelease(uint8_t button)
+void UsbHidDevice::OnSetResolutionMultiplier(uint8_t value)
 {
-    if (!IsConnected())
+    std::lock_guard<std::mutex> lock(mutex_);
+    SetScrollScale(protocol_, value & (kMultiplierWheelMask | kMultiplierPanMask));
+}
+
+uint8_t UsbHidDevice::GetResolutionMultiplier() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return multiplier_;
+}
+
+bool UsbHidDevice::HiResWheel() const
+{
+    // Caller holds mutex_. Boot protocol has no multiplier.
+    return protocol_ == HidProtocol::Report && (multiplier_ & kMultiplierWheelMask) != 0;
+}
+
+bool UsbHidDevice::HiResPan() const
+{
+    // Caller holds mutex_.
+    return protocol_ == HidProtocol::Report && (multiplier_ & kMultiplierPanMask) != 0;
+}
+
+void UsbHidDevice::SetScrollScale(HidProtocol protocol, uint8_t multiplier)
+{
+    // Caller holds mutex_. Scroll still pending is in the old units; it is
+    // dropped rather than sent 120 times too large or too small.
+    bool wheel  = HiResWheel();
+    bool pan    = HiResPan();
+    protocol_   = protocol;
+    multiplier_ = multiplier;
+    if (wheel != HiResWheel()) {
+        mouse_motion_.ClearWheel();
+        wheel_fraction_ = 0;
+    }
+    if (pan != HiResPan()) {
+        mouse_motion_.ClearPan();
+        pan_fraction_ = 0;
+    }
+}
+
+void UsbHidDevice::QueueEdgeReport(uint8_t report_id, const void *data, uint8_t len, bool press)
+{
+    // Caller holds mutex_.
+    uint64_t      origin_us = 0;
+    LatencySource source    = CurrentSource(origin_us);
+    switch (edge_reports_.Push(report_id, data, len, press, source, origin_us)) {
+        case HidReportQueue::Result::Queued:
+            break;
+        case HidReportQueue::Result::Coalesced:
+            report_stats_.coalesced++;
+            break;
+        case HidReportQueue::Result::Overflow:
+            report_stats_.dropped++;
+            break;
+    }
+    SubmitPending();
+}
+
+void UsbHidDevice::QueueMotion(int32_t x, int32_t y, int32_t wheel, int32_t pan)
+{
+    // Caller holds mutex_.
+    if (mouse_motion_.Pending()) {
+        report_stats_.coalesced++;
+    } else {
+        motion_source_ = LatencySource::None;
+    }
+
+    uint64_t      origin_us = 0;
+    LatencySource source    = CurrentSource(origin_us);
+    if (source != LatencySource::None && motion_source_ == LatencySource::None) {
+        motion_source_    = source;
+        motion_origin_us_ = origin_us;
+    }
+
+    if (mouse_motion_.Add(x, y, wheel, pan)) {
+        report_stats_.saturated++;
+    }
+    SubmitPending();
+}
+
+void UsbHidDevice::SubmitPending()
+{
+    // Caller holds mutex_. Runs from input callers, from the TinyUSB task on
+    // transfer completion and from its loop; whoever finds the endpoint free
+    // submits.
+    bool boot = protocol_ == HidProtocol::Boot;
+    while (boot && !edge_reports_.Empty() && edge_reports_.Front().report_id != kReportIdMouse) {
+        edge_reports_.Pop();  // Boot hosts only understand the mouse
+    }
+    if (edge_reports_.Empty() && !mouse_motion_.Pending()) {
+        return;
+    }
+
+    if (report_in_flight_) {
+        uint64_t now = utils::GetMicros();
+        if (now - in_flight_since_us_ < config::kHidReportStallMs * 1000ULL) {
+            return;
+        }
+        report_in_flight_ = false;
+        report_stats_.stalls++;
+    }
+
+    if (!port_ || !port_->IsReady()) {
+        return;
+    }
+
+    // Key and button edges go first, in order. Motion accumulated so far rides
+    // along with a button snapshot, otherwise it gets a report of its own.
+    const HidReportSnapshot *edge = edge_reports_.Empty() ? nullptr : &edge_reports_.Front();
+    if (edge && edge->report_id != kReportIdMouse) {
+        if (SendReport(edge->report_id, edge->data, edge->len, edge->source, edge->origin_us)) {
+            edge_reports_.Pop();
+        }
+        return;
+    }
+
+    MouseReport   report    = mouse_report_;
+    LatencySource source    = motion_source_;
+    uint64_t      origin_us = motion_origin_us_;
+    if (edge) {
+        std::memcpy(&report, edge->data, sizeof(report));
+        source    = edge->source;
+        origin_us = edge->origin_us;
+    }
+
+    // Motion beyond the report's range stays pending for the next poll. A
+    // snapshot that carries its own motion leaves the accumulator alone.
+    MouseAccumulator::Chunk chunk;
+    if (!edge || !edge->motion) {
+        int32_t limit = boot ? kBootMouseReportMax : kMouseReportMax;
+        chunk         = mouse_motion_.Take(limit);
+        report.x      = chunk.x;
+        report.y      = chunk.y;
+        report.wheel  = chunk.wheel;
+        report.pan    = chunk.pan;
+    }
+
+    bool sent = false;
+    if (boot) {
+        // No report ID and no pan field.
+        BootMouseReport boot_report;
+        boot_report.buttons = report.buttons;
+        boot_report.x       = static_cast<int8_t>(report.x);
+        boot_report.y       = static_cast<int8_t>(report.y);
+        boot_report.wheel   = static_cast<int8_t>(report.wheel);
+        sent                = SendReport(0, &boot_report, sizeof(boot_report), source, origin_us);
+    } else {
+        sent = SendReport(kReportIdMouse, &report, sizeof(report), source, origin_us);
+    }
+    if (!sent) {
+        mouse_motion_.Restore(chunk);
         return;
+    }
+    if (edge) {
+        edge_reports_.Pop();
+    }
+}
+
+bool UsbHidDevice::SendReport(uint8_t report_id, const void *data, uint16_t len,
+                              LatencySource source, uint64_t origin_us)
+{
+    if (!port_->SendReport(report_id, data, len)) {
+        report_stats_.rejected++;
+        return false;
+    }
+
+    uint64_t now        = utils::GetMicros();
+    report_in_flight_   = true;
+    in_flight_since_us_ = now;
+    in_flight_source_   = source;
+    in_flight_origin_   = origin_us;
+    report_stats_.sent++;
 
-    if (xSemaphoreTake(mutex_, portMAX_DELAY) == pdTRUE) {
-        mouse_report_.buttons &= ~button;
-        SendMouseReport();
-        xSemaphoreGive(mutex_);
+    if (source != LatencySource::None) {
+        latency_.Record(source, LatencyStage::Submit, static_cast<uint32_t>(now - origin_us));
     }
+    return true;
 }
 
-void UsbHidDevice::MouseClick(uint8_t button)
+LatencySource UsbHidDevice::CurrentSource(uint64_t &origin_us) const
+{
+    // Caller holds mutex_. Only the task inside BeginInput()/EndInput() is
+    // attributed; timer-driven releases and other callers are not.
+    if (input_source_ == LatencySource::None || input_task_ != utils::CurrentTaskId()) {
+        return LatencySource::None;
+    }
+    origin_us = input_rx_us_;
+    return input_source_;
+}
+
+// =============================================================================
+// Latency Instrumentation
+// =============================================================================
+
+void UsbHidDevice::BeginInput(LatencySource source, uint64_t rx_us)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    input_task_   = utils::CurrentTaskId();
+    input_source_ = rx_us ? source : LatencySource::None;
+    input_rx_us_  = rx_us;
+}
+
+void UsbHidDevice::EndInput()
 {
-    MouseButtonPress(button);
-    vTaskDelay(pdMS_TO_TICKS(50));
-    MouseButtonRelease(button);
+    std::lock_guard<std::mutex> lock(mutex_);
+    input_task_   = 0;
+    input_source_ = LatencySource::None;
 }
 
-void UsbHidDevice::MouseScroll(int8_t wheel)
+void UsbHidDevice::LogLatency(const char *tag) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    latency_.Log(tag);
+}
+
+void UsbHidDevice::ExportLatencyCsv() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    latency_.ExportCsv();
+}
+
+// =============================================================================
+// Tap Engine
+// =============================================================================
+
+void UsbHidDevice::Tap(TimedRelease::Kind kind, uint16_t code)
 {
     if (!IsConnected())
         return;
 
-    if (xSemaphoreTake(mutex_, portMAX_DELAY) == pdTRUE) {
-        mouse_report_.wheel = wheel;
-        SendMouseReport();
-        mouse_report_.wheel = 0;
-        xSemaphoreGive(mutex_);
+    uint64_t now       = utils::GetMicros();
+    bool     preempted = false;
+    bool     queued    = false;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // A second tap on an input whose release is still pending must not
+        // merge into one long press: release it now, then press again.
+        preempted = release_queue_.Preempt(kind, code);
+        queued    = release_queue_.Schedule(kind, code, now + config::kTapHoldMs * 1000ULL);
+        if (queued) {
+            ArmReleaseTimer(now);
+        }
+    }
+
+    if (preempted) {
+        Release(kind, code);
+    }
+    Press(kind, code);
+
+    // Queue full: fall back to an immediate release rather than blocking.
+    if (!queued) {
+        Release(kind, code);
+    }
+}
+
+void UsbHidDevice::Press(TimedRelease::Kind kind, uint16_t code)
+{
+    switch (kind) {
+        case TimedRelease::Kind::MouseButton:
+            MouseButtonPress(static_cast<uint8_t>(code));
+            break;
+        case TimedRelease::Kind::Key:
+            KeyPress(static_cast<uint8_t>(code));
+            break;
+        case TimedRelease::Kind::MediaKey:
+            MediaKeyPress(code);
+            break;
+    }
+}
+
+void UsbHidDevice::Release(TimedRelease::Kind kind, uint16_t code)
+{
+    switch (kind) {
+        case TimedRelease::Kind::MouseButton:
+            MouseButtonRelease(static_cast<uint8_t>(code));
+            break;
+        case TimedRelease::Kind::Key:
+            KeyRelease(static_cast<uint8_t>(code));
+            break;
+        case TimedRelease::Kind::MediaKey:
+            MediaKeyRelease(code);
+            break;
+    }
+}
+
+void UsbHidDevice::ServiceReleases(uint64_t now_us)
+{
+    TimedRelease due[TimedReleaseQueue::kCapacity];
+    size_t       count = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        count = release_queue_.TakeDue(now_us, due, TimedReleaseQueue::kCapacity);
+        ArmReleaseTimer(now_us);
+    }
+
+    // Send outside the lock; the release functions take it themselves.
+    for (size_t i = 0; i < count; ++i) {
+        Release(due[i].kind, due[i].code);
     }
 }
 
-void UsbHidDevice::SendMouseReport()
+TimedReleaseStats UsbHidDevice::GetReleaseStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return release_queue_.Stats();
+}
+
+void UsbHidDevice::ArmReleaseTimer(uint64_t now_us)
 {
-    tud_hid_n_report(0, kReportIdMouse, &mouse_report_, sizeof(mouse_report_));
+    // Caller holds mutex_. The port ignores this while a wakeup is pending;
+    // that wakeup is for an earlier (or equal) release and re-arms from there.
+    if (!port_ || release_queue_.Empty()) {
+        return;
+    }
+
+    uint64_t next = release_queue_.NextDue();
+    port_->ArmReleaseTimer(next > now_us ? next - now_us : 1);
 }
 
 }  // namespace idrive
@@ -7,6 +7,7 @@
 
 #include "idrive/zbe4_protocol.h"
 #include "idrive/zbe4_rev03_protocol.h"
+#include "input/one_euro_filter.h"
 #include "ota/ota_trigger.h"
 #include "utils/utils.h"
 
@@ -15,11 +16,58 @@ namespace idrive {
 namespace {
 const char        *kTag                 = "IDRIVE";
 constexpr uint32_t kInitRetryIntervalMs = 5000;
+constexpr uint32_t kTouchpadInitRetryMs = 50;
 }  // namespace
 
-IDriveController::IDriveController(CanBus &can, UsbHidDevice &hid, const Config &config)
-    : can_(can), hid_(hid), config_(config)
-{}
+IDriveController::IDriveController(CanPort &can, UsbHidDevice &hid, PeriodicScheduler &scheduler,
+                                   const Config &config)
+    : can_(can),
+      hid_(hid),
+      scheduler_(scheduler),
+      config_(config),
+      touch_output_request_(config.touch_output),
+      touch_output_(config.touch_output)
+{
+    // Register known controller protocols.
+    // Detection is first-come-first-served: whichever protocol's DetectionId()
+    // appears first on the CAN bus wins.
+    RegisterProtocol(std::make_unique<ZBE4Protocol>());
+    RegisterProtocol(std::make_unique<ZBE4Rev03Protocol>());
+}
+
+void IDriveController::RegisterProtocol(std::unique_ptr<ControllerProtocol> protocol)
+{
+    if (protocols_.size() >= CanDispatchTable::kMaxProtocols) {
+        ESP_LOGE(kTag, "Too many protocols, ignoring %s", protocol->Name());
+        return;
+    }
+
+    // Populate the dispatch table once here so the RX path never has to
+    // ask the protocol which IDs it wants.
+    auto index = static_cast<uint8_t>(protocols_.size());
+    if (protocol->DetectionId() != 0) {
+        dispatch_.AddDetection(protocol->DetectionId(), index);
+    }
+    for (uint32_t id = 0; id < CanDispatchTable::kIdCount; ++id) {
+        if (protocol->HandlesId(id)) {
+            dispatch_.AddHandler(id, index);
+        }
+    }
+
+    protocol->SetEventCallback([this](const InputEvent &e) { OnProtocolEvent(e); });
+    protocols_.push_back(std::move(protocol));
+}
+
+CanIdSet IDriveController::GetRxIds() const
+{
+    CanIdSet ids;
+    for (uint32_t id = 0; id < CanDispatchTable::kIdCount; ++id) {
+        if (dispatch_.IsConsumed(id)) {
+            ids.Add(id);
+        }
+    }
+    return ids;
+}
 
 void IDriveController::Init()
 {
@@ -30,76 +78,95 @@ void IDriveController::Init()
     button_handler_ = button.get();
     handlers_.push_back(std::move(button));
 
-    auto joystick     = std::make_unique<JoystickHandler>(hid_, config_.joystick_as_mouse,
-                                                      config_.joystick_move_step);
+    auto joystick = std::make_unique<JoystickHandler>(
+        hid_, config_.joystick_as_mouse, config_.joystick_move_step,
+        config_.joystick_repeat_delay_ms, config_.joystick_repeat_rate_hz);
     joystick_handler_ = joystick.get();
     handlers_.push_back(std::move(joystick));
 
-    auto rotary     = std::make_unique<RotaryHandler>(hid_);
+    auto rotary     = std::make_unique<RotaryHandler>(hid_, config_.rotary_accel);
     rotary_handler_ = rotary.get();
     handlers_.push_back(std::move(rotary));
 
-    auto touchpad     = std::make_unique<TouchpadHandler>(hid_, config_.min_mouse_travel,
-                                                      config::kXMultiplier, config::kYMultiplier);
+    auto touchpad = std::make_unique<TouchpadHandler>(hid_, config_.min_mouse_travel,
+                                                      config::kXMultiplier, config::kYMultiplier,
+                                                      config_.pointer_accel, config_.pinch_mode,
+                                                      config_.tap_mode);
     touchpad_handler_ = touchpad.get();
     handlers_.push_back(std::move(touchpad));
 
-    // Register known controller protocols.
-    // Detection is first-come-first-served: whichever protocol's DetectionId()
-    // appears first on the CAN bus wins.
-    auto zbe4 = std::make_unique<ZBE4Protocol>();
-    zbe4->SetEventCallback([this](const InputEvent &e) { OnProtocolEvent(e); });
-    protocols_.push_back(std::move(zbe4));
-
-    auto zbe4r03 = std::make_unique<ZBE4Rev03Protocol>();
-    zbe4r03->SetEventCallback([this](const InputEvent &e) { OnProtocolEvent(e); });
-    protocols_.push_back(std::move(zbe4r03));
+    if (config::kTouchFilter && !touch_filter_) {
+        OneEuroParams params;
+        params.min_cutoff_mhz = config::kTouchFilterMinCutoffMhz;
+        params.beta_mhz       = config::kTouchFilterBetaMhz;
+        params.d_cutoff_mhz   = config::kTouchFilterDCutoffMhz;
+        touch_filter_         = std::make_unique<OneEuroTouchFilter>(params);
+    }
 
     // Set up CAN message callback.
     can_.SetCallback([this](const CanMessage &msg) { OnCanMessage(msg); });
+    can_.SetBurstEndCallback([this]() { OnCanBurstEnd(); });
 
     // Record start time and send initial commands.
     init_start_time_ = utils::GetMillis();
     SendRotaryInit();
     SendLightCommand();
 
+    // Periodic CAN traffic. These cadences are deadline-driven by the
+    // scheduler task so they do not depend on how often Update() runs.
+    uint64_t now_us = utils::GetMicros();
+    scheduler_.Add(
+        "poll", config_.poll_interval_ms * 1000,
+        [this]() {
+            SendPollCommand();
+            SendTouchpadInit();
+        },
+        now_us);
+    scheduler_.Add("light", config_.light_keepalive_ms * 1000, [this]() { SendLightCommand(); },
+                   now_us);
+    scheduler_.Add("tp_init", kTouchpadInitRetryMs * 1000, [this]() { RetryTouchpadInit(); },
+                   now_us);
+    scheduler_.Add("rot_init", kInitRetryIntervalMs * 1000, [this]() { RetryRotaryInit(); },
+                   now_us);
+
+    // Kinetic scroll emitter: one wheel report per host poll while a fling
+    // runs, nothing otherwise.
+    scheduler_.Add("kinetic", config::kHidPollIntervalMs * 1000,
+                   [this]() { touchpad_handler_->TickKinetic(utils::GetMicros()); }, now_us);
+
+    // Tap resolver: sends a held tap's click when the double-tap window
+    // closes, and starts tap-tap-hold drags, without waiting for a CAN frame.
+    scheduler_.Add("tap", config::kTapTickMs * 1000,
+                   [this]() { touchpad_handler_->TickTaps(utils::GetMicros()); }, now_us);
+
+    // Held joystick: arrow key repeats and cursor glide at the HID poll rate,
+    // whatever cadence the controller reports the hold at.
+    scheduler_.Add("joystick", config::kHidPollIntervalMs * 1000,
+                   [this]() { joystick_handler_->Tick(utils::GetMicros()); }, now_us);
+
     ESP_LOGI(kTag, "Waiting for controller detection...");
 }
 
 void IDriveController::Update()
 {
-    uint32_t now = utils::GetMillis();
+    uint32_t            now      = utils::GetMillis();
+    ControllerProtocol *protocol = active_protocol_;
 
     // Initialize touchpad after protocol is ready.
-    if (ProtocolReady() && !touchpad_init_done_) {
-        ESP_LOGI(kTag, "Protocol ready (%s), initializing touchpad",
-                 active_protocol_->Name());
+    if (ProtocolReady(protocol) && !touchpad_init_done_) {
+        ESP_LOGI(kTag, "Protocol ready (%s), initializing touchpad", protocol->Name());
         SendTouchpadInit();
-        last_touchpad_init_time_ = now;
-        touchpad_init_done_      = true;
-    }
-
-    // Keep sending touchpad init until we get a response on 0xBF.
-    if (touchpad_init_done_ && !touchpad_active_) {
-        constexpr uint32_t kTouchpadInitRetryMs = 50;
-        if (now - last_touchpad_init_time_ >= kTouchpadInitRetryMs) {
-            last_touchpad_init_time_ = now;
-            SendTouchpadInit();
-            static int retry_count = 0;
-            if (++retry_count % 20 == 0) {
-                ESP_LOGI(kTag, "Touchpad init retry #%d...", retry_count);
-            }
-        }
+        touchpad_init_done_ = true;
     }
 
     // Mark controller as ready after cooldown.
-    if (!ready_ && ProtocolReady() && touchpad_init_done_) {
+    if (!ready_ && ProtocolReady(protocol) && touchpad_init_done_) {
         if (cooldown_start_time_ == 0) {
             cooldown_start_time_ = now;
         }
         if (now - cooldown_start_time_ > config::kControllerCooldownMs) {
             ready_ = true;
-            ESP_LOGI(kTag, "iDrive controller ready! (%s)", active_protocol_->Name());
+            ESP_LOGI(kTag, "iDrive controller ready! (%s)", protocol->Name());
         }
     }
 
@@ -110,26 +177,6 @@ void IDriveController::Update()
             ESP_LOGI(kTag, "Light init done");
         }
     }
-
-    // Periodic polling.
-    if (now - last_poll_time_ >= config_.poll_interval_ms) {
-        last_poll_time_ = now;
-        SendPollCommand();
-        SendTouchpadInit();
-    }
-
-    // Periodic light keepalive.
-    if (now - last_light_time_ >= config_.light_keepalive_ms) {
-        last_light_time_ = now;
-        SendLightCommand();
-    }
-
-    // Retry rotary init while no protocol has been detected yet.
-    if (!active_protocol_ && (now - last_reinit_time_ >= kInitRetryIntervalMs)) {
-        last_reinit_time_ = now;
-        ESP_LOGW(kTag, "No init response - retrying...");
-        SendRotaryInit();
-    }
 }
 
 void IDriveController::SetLightBrightness(uint8_t brightness)
@@ -156,37 +203,48 @@ void IDriveController::OnCanMessage(const CanMessage &msg)
                  msg.data[4], msg.data[5], msg.data[6], msg.data[7]);
     }
 
-    // Ignore echo of our own transmitted messages.
-    if (msg.id == can_id::kRotaryInitCmd || msg.id == can_id::kLight ||
-        msg.id == can_id::kPoll || msg.id == can_id::kTouchInitCmd) {
-        return;
-    }
+    const CanRouteEntry &route = dispatch_.Lookup(msg.id, msg.extended);
 
-    // Touchpad and status are shared across all revisions.
-    if (msg.id == can_id::kTouch) {
-        HandleTouchpadMessage(msg);
-        return;
-    }
-    if (msg.id == can_id::kStatus) {
-        HandleStatusMessage(msg);
-        return;
+    switch (route.route) {
+        case CanRoute::Touch:
+            // Touchpad and status are shared across all revisions.
+            HandleTouchpadMessage(msg);
+            break;
+        case CanRoute::Status:
+            HandleStatusMessage(msg);
+            break;
+        case CanRoute::Protocol:
+            HandleProtocolMessage(msg, route);
+            break;
+        case CanRoute::Ignore:    // Echo of our own transmitted messages.
+        case CanRoute::Unrouted:
+            break;
     }
+}
+
+void IDriveController::OnCanBurstEnd()
+{
+    // The dispatch task is about to sleep: whatever rotary motion the burst
+    // carried goes out now, as one event.
+    FlushRotary();
+}
 
+void IDriveController::HandleProtocolMessage(const CanMessage &msg, const CanRouteEntry &route)
+{
     // Auto-detect protocol: first frame matching a DetectionId() wins.
-    if (!active_protocol_) {
-        for (auto &p : protocols_) {
-            if (p->DetectionId() == msg.id) {
-                active_protocol_ = p.get();
-                active_protocol_->OnDetected();
-                ESP_LOGI(kTag, "Detected: %s", active_protocol_->Name());
-                break;
-            }
-        }
+    // Ties on the same ID go to the protocol registered first.
+    ControllerProtocol *protocol = active_protocol_;
+    if (!protocol && route.detect_mask != 0) {
+        active_index_ = static_cast<uint8_t>(__builtin_ctz(route.detect_mask));
+        protocol      = protocols_[active_index_].get();
+        protocol->OnDetected();
+        active_protocol_ = protocol;
+        ESP_LOGI(kTag, "Detected: %s", protocol->Name());
     }
 
     // Delegate to active protocol.
-    if (active_protocol_ && active_protocol_->HandlesId(msg.id)) {
-        active_protocol_->OnMessage(msg);
+    if (protocol && (route.handle_mask & (1u << active_index_))) {
+        protocol->Receive(msg);
     }
 }
 
@@ -220,7 +278,7 @@ void IDriveController::HandleTouchpadMessage(const CanMessage &msg)
 
     // Ignore initial touchpad messages during initialization.
     if (touchpad_init_ignore_counter_ < config::kTouchpadInitIgnoreCount &&
-        ProtocolReady()) {
+        ProtocolReady(active_protocol_)) {
         touchpad_init_ignore_counter_++;
         ESP_LOGI(kTag, "Touchpad ignoring message %d/%d", touchpad_init_ignore_counter_,
                  config::kTouchpadInitIgnoreCount);
@@ -228,37 +286,110 @@ void IDriveController::HandleTouchpadMessage(const CanMessage &msg)
     }
 
     InputEvent event;
-    event.type  = InputEvent::Type::Touchpad;
-    event.state = touch_type;
-
-    if (touch_type == protocol::kTouchFingerRemoved) {
-        DispatchEvent(event);
+    if (!DecodeTouchpadFrame(msg, event)) {
         return;
     }
 
-    if (touch_type == protocol::kTouchSingle || touch_type == protocol::kTouchMulti ||
-        touch_type == protocol::kTouchTriple || touch_type == protocol::kTouchQuad) {
-        // G-series ZBE4 multi-touch protocol (both axes 9-bit, 0-511):
-        // Byte 1: Finger 1 X low byte (0-255)
-        // Byte 2: [high nibble = F1 Y low 4 bits] [low nibble = F1 X high bit]
-        // Byte 3: Finger 1 Y high 5 bits (0-31)
-        // Byte 4: Touch state
-        // Byte 5: Finger 2 X low byte (0-255)
-        // Byte 6: [high nibble = F2 Y low 4 bits] [low nibble = F2 X high bit]
-        // Byte 7: Finger 2 Y high 5 bits (0-31)
+    // Smooth the coordinates before gesture handling sees them.
+    if (touch_filter_) {
+        touch_filter_->Apply(event);
+    }
 
-        event.x = msg.data[1] + 256 * (msg.data[2] & 0x01);
-        event.y = (static_cast<int16_t>(msg.data[3]) << 4) | (msg.data[2] >> 4);
+    ApplyTouchOutput(event.timestamp_us);
+    if (touch_output_ == TouchOutput::Digitizer) {
+        SendTouchReport(event);
+        return;
+    }
+    DispatchEvent(event);
+}
 
-        event.two_fingers = (touch_type == protocol::kTouchMulti);
+void IDriveController::ApplyTouchOutput(uint64_t now_us)
+{
+    TouchOutput requested = touch_output_request_;
+    if (requested == touch_output_) {
+        return;
+    }
 
-        if (event.two_fingers) {
-            event.x2 = msg.data[5] + 256 * (msg.data[6] & 0x01);
-            event.y2 = (static_cast<int16_t>(msg.data[7]) << 4) | (msg.data[6] >> 4);
+    if (touch_output_ == TouchOutput::Digitizer) {
+        DigitizerReport report;
+        if (digitizer_.LiftAll(report) && ready_) {
+            hid_.TouchReport(report, true);
         }
+    } else if (touchpad_handler_) {
+        // End drags, pinches and swipes as if the fingers lifted, without
+        // leaving a fling running.
+        InputEvent lift;
+        lift.type         = InputEvent::Type::Touchpad;
+        lift.state        = protocol::kTouchFingerRemoved;
+        lift.timestamp_us = now_us;
+        bool kinetic      = touchpad_handler_->IsKineticEnabled();
+        DispatchEvent(lift);
+        touchpad_handler_->SetKineticEnabled(false);
+        touchpad_handler_->SetKineticEnabled(kinetic);
+    }
+
+    touch_output_ = requested;
+    ESP_LOGI(kTag, "Touch output: %s",
+             requested == TouchOutput::Digitizer ? "digitizer" : "mouse");
+}
+
+void IDriveController::SendTouchReport(const InputEvent &event)
+{
+    if (!ready_ || !hid_.IsConnected()) {
+        return;
+    }
+
+    // No gesture processing: one frame, one report.
+    DigitizerReport report;
+    bool            lifts = digitizer_.Encode(event, report);
+    if (report.count == 0) {
+        return;
+    }
+    hid_.BeginInput(LatencySource::Touchpad, event.timestamp_us);
+    hid_.TouchReport(report, lifts);
+    hid_.EndInput();
+}
+
+bool IDriveController::DecodeTouchpadFrame(const CanMessage &msg, InputEvent &event)
+{
+    if (msg.length < 8)
+        return false;
+
+    uint8_t touch_type = msg.data[4];
+
+    event              = InputEvent();
+    event.type         = InputEvent::Type::Touchpad;
+    event.state        = touch_type;
+    event.timestamp_us = msg.timestamp_us;
+
+    if (touch_type == protocol::kTouchFingerRemoved) {
+        return true;
+    }
+
+    if (touch_type != protocol::kTouchSingle && touch_type != protocol::kTouchMulti &&
+        touch_type != protocol::kTouchTriple && touch_type != protocol::kTouchQuad) {
+        return false;
+    }
+
+    // G-series ZBE4 multi-touch protocol (both axes 9-bit, 0-511):
+    // Byte 1: Finger 1 X low byte (0-255)
+    // Byte 2: [high nibble = F1 Y low 4 bits] [low nibble = F1 X high bit]
+    // Byte 3: Finger 1 Y high 5 bits (0-31)
+    // Byte 4: Touch state
+    // Byte 5: Finger 2 X low byte (0-255)
+    // Byte 6: [high nibble = F2 Y low 4 bits] [low nibble = F2 X high bit]
+    // Byte 7: Finger 2 Y high 5 bits (0-31)
+
+    event.x = msg.data[1] + 256 * (msg.data[2] & 0x01);
+    event.y = (static_cast<int16_t>(msg.data[3]) << 4) | (msg.data[2] >> 4);
+
+    event.two_fingers = (touch_type == protocol::kTouchMulti);
 
-        DispatchEvent(event);
+    if (event.two_fingers) {
+        event.x2 = msg.data[5] + 256 * (msg.data[6] & 0x01);
+        event.y2 = (static_cast<int16_t>(msg.data[7]) << 4) | (msg.data[6] >> 4);
     }
+    return true;
 }
 
 void IDriveController::HandleStatusMessage(const CanMessage &msg)
@@ -276,14 +407,13 @@ void IDriveController::HandleStatusMessage(const CanMessage &msg)
         touchpad_active_              = false;
         cooldown_start_time_          = 0;
         touchpad_init_ignore_counter_ = 0;
-        last_reinit_time_             = utils::GetMillis();
         init_start_time_              = utils::GetMillis();
 
         // Reset protocol state and return to detection mode.
         // The next matching CAN frame will re-detect the same protocol.
-        if (active_protocol_) {
-            active_protocol_->Reset();
-            active_protocol_ = nullptr;
+        ControllerProtocol *protocol = active_protocol_.exchange(nullptr);
+        if (protocol) {
+            protocol->Reset();
         }
 
         SendRotaryInit();
@@ -296,6 +426,18 @@ void IDriveController::HandleStatusMessage(const CanMessage &msg)
 
 void IDriveController::OnProtocolEvent(const InputEvent &event)
 {
+    // Rotary deltas are merged until the end of the CAN burst.
+    if (event.type == InputEvent::Type::Rotary) {
+        InputEvent flushed {InputEvent::Type::Rotary};
+        if (rotary_coalescer_.Add(event, flushed)) {
+            DispatchEvent(flushed);
+        }
+        return;
+    }
+
+    // Other input keeps its order relative to the rotary.
+    FlushRotary();
+
     // Notify OTA trigger for button combo detection.
     if (event.type == InputEvent::Type::Button && ota_trigger_) {
         ota_trigger_->OnButtonEvent(event.id, event.state);
@@ -303,6 +445,14 @@ void IDriveController::OnProtocolEvent(const InputEvent &event)
     DispatchEvent(event);
 }
 
+void IDriveController::FlushRotary()
+{
+    InputEvent merged {InputEvent::Type::Rotary};
+    if (rotary_coalescer_.Take(merged)) {
+        DispatchEvent(merged);
+    }
+}
+
 // =============================================================================
 // CAN Commands
 // =============================================================================
@@ -334,6 +484,34 @@ void IDriveController::SendPollCommand()
     can_.Send(can_id::kPoll, data, 8);
 }
 
+// =============================================================================
+// Scheduler Jobs
+// =============================================================================
+
+void IDriveController::RetryTouchpadInit()
+{
+    // Keep sending touchpad init until we get a response on 0xBF.
+    if (!touchpad_init_done_ || touchpad_active_) {
+        return;
+    }
+
+    SendTouchpadInit();
+    if (++touchpad_init_retry_count_ % 20 == 0) {
+        ESP_LOGI(kTag, "Touchpad init retry #%d...", touchpad_init_retry_count_);
+    }
+}
+
+void IDriveController::RetryRotaryInit()
+{
+    // Retry rotary init while no protocol has been detected yet.
+    if (active_protocol_) {
+        return;
+    }
+
+    ESP_LOGW(kTag, "No init response - retrying...");
+    SendRotaryInit();
+}
+
 // =============================================================================
 // Event Dispatch
 // =============================================================================
@@ -344,11 +522,21 @@ void IDriveController::DispatchEvent(const InputEvent &event)
         return;
     }
 
+    LatencySource source = LatencySource::None;
+    switch (event.type) {
+        case InputEvent::Type::Button:   source = LatencySource::Button;   break;
+        case InputEvent::Type::Joystick: source = LatencySource::Joystick; break;
+        case InputEvent::Type::Rotary:   source = LatencySource::Rotary;   break;
+        case InputEvent::Type::Touchpad: source = LatencySource::Touchpad; break;
+    }
+
+    hid_.BeginInput(source, event.timestamp_us);
     for (auto &handler : handlers_) {
         if (handler->Handle(event)) {
             break;
         }
     }
+    hid_.EndInput();
 }
 
 }  // namespace idrive
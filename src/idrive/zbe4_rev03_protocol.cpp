@@ -20,6 +20,65 @@ constexpr uint8_t kIdleByte4 = 0x00;
 constexpr uint8_t kIdleByte5 = 0x00;
 constexpr uint8_t kIdleByte6 = 0xC0;
 constexpr uint8_t kIdleByte7 = 0xF8;
+
+// Button bytes[4..7] packed big-endian into one word, byte[4] on top.
+constexpr uint32_t PackButtons(uint8_t b4, uint8_t b5, uint8_t b6, uint8_t b7)
+{
+    return (static_cast<uint32_t>(b4) << 24) | (static_cast<uint32_t>(b5) << 16) |
+           (static_cast<uint32_t>(b6) << 8) | b7;
+}
+
+constexpr uint32_t kIdleButtons = PackButtons(kIdleByte4, kIdleByte5, kIdleByte6, kIdleByte7);
+
+struct ButtonBit {
+    uint8_t byte;  // Frame byte, 4..7
+    uint8_t bit;   // Bit in that byte
+    uint8_t id;    // protocol::kButton*
+};
+
+constexpr ButtonBit kButtonBits[] = {
+    {4, 2, protocol::kButtonMenu},   {4, 5, protocol::kButtonBack},
+    {5, 0, protocol::kButtonOption}, {5, 3, protocol::kButtonTel},
+    {6, 0, protocol::kButtonCd},     {6, 3, protocol::kButtonNav},
+    {7, 0, protocol::kButtonMap},
+};
+
+// Packed word bit to button ID (0 for bits that are not buttons).
+struct ButtonTable {
+    uint8_t  id[32] = {};
+    uint32_t mask   = 0;
+};
+
+constexpr ButtonTable MakeButtonTable()
+{
+    ButtonTable table;
+    for (const ButtonBit &b : kButtonBits) {
+        uint32_t bit  = (7u - b.byte) * 8u + b.bit;
+        table.id[bit] = b.id;
+        table.mask |= 1u << bit;
+    }
+    return table;
+}
+
+constexpr ButtonTable kButtonTable = MakeButtonTable();
+
+static_assert(kButtonTable.id[26] == protocol::kButtonMenu &&
+                  kButtonTable.id[0] == protocol::kButtonMap,
+              "byte[4] must pack to the top of the button word");
+static_assert((kButtonTable.mask & kIdleButtons) == 0, "button bits must be clear at rest");
+
+// Joystick byte[3] values; anything else is not a direction.
+bool DecodeStick(uint8_t raw, uint8_t &joy_id)
+{
+    switch (raw) {
+        case 0x01: joy_id = protocol::kStickCenter; return true;
+        case 0x10: joy_id = protocol::kStickUp;     return true;
+        case 0x70: joy_id = protocol::kStickDown;   return true;
+        case 0xA0: joy_id = protocol::kStickLeft;   return true;
+        case 0x40: joy_id = protocol::kStickRight;  return true;
+        default:                                    return false;
+    }
+}
 }  // namespace
 
 void ZBE4Rev03Protocol::OnDetected()
@@ -32,27 +91,36 @@ void ZBE4Rev03Protocol::Reset()
 {
     init_done_        = false;
     position_set_     = false;
-    last_button_id_   = 0;
+    buttons_          = 0;
+    stick_raw_        = 0;
     last_joystick_id_ = 0;
     joystick_active_  = false;
-    menu_pressed_     = false;
-    back_pressed_     = false;
 }
 
-void ZBE4Rev03Protocol::HandleButtonEdge(bool now, bool &previous, uint8_t button_id)
+void ZBE4Rev03Protocol::EmitButton(uint8_t button_id, bool pressed)
 {
-    if (now == previous)
-        return;
-    previous = now;
-
     if (config::kDebugKeys) {
-        ESP_LOGI(kTag, "Button %s: 0x%02X", now ? "press" : "release", button_id);
+        ESP_LOGI(kTag, "Button %s: 0x%02X", pressed ? "press" : "release", button_id);
     }
 
     InputEvent event;
     event.type  = InputEvent::Type::Button;
     event.id    = button_id;
-    event.state = now ? protocol::kInputPressed : protocol::kInputReleased;
+    event.state = pressed ? protocol::kInputPressed : protocol::kInputReleased;
+    Emit(event);
+}
+
+void ZBE4Rev03Protocol::EmitStick(uint8_t joy_id, uint8_t state)
+{
+    if (config::kDebugKeys && state != protocol::kInputHeld) {
+        ESP_LOGI(kTag, "Joystick %s: 0x%02X",
+                 state == protocol::kInputPressed ? "press" : "release", joy_id);
+    }
+
+    InputEvent event;
+    event.type  = InputEvent::Type::Joystick;
+    event.id    = joy_id;
+    event.state = state;
     Emit(event);
 }
 
@@ -65,117 +133,55 @@ void ZBE4Rev03Protocol::OnMessage(const CanMessage &msg)
     uint16_t new_position = static_cast<uint16_t>(msg.data[1]) |
                             (static_cast<uint16_t>(msg.data[2]) << 8);
 
-    // MENU and BACK are bitfields in byte[4] - handle edge detection first.
-    // They can be pressed simultaneously (needed for OTA button combo).
-    bool menu_now = (msg.data[4] & 0x04) != 0;
-    bool back_now = (msg.data[4] & 0x20) != 0;
-    HandleButtonEdge(menu_now, menu_pressed_, protocol::kButtonMenu);
-    HandleButtonEdge(back_now, back_pressed_, protocol::kButtonBack);
-
-    if (menu_now || back_now)
-        return;
-
-    // Idle frame: bytes[3..7] at rest values.
-    bool idle = (msg.data[3] == kIdleByte3 && msg.data[4] == kIdleByte4 &&
-                 msg.data[5] == kIdleByte5 && msg.data[6] == kIdleByte6 &&
-                 msg.data[7] == kIdleByte7);
-
-    if (!idle) {
-        // Press frame: decode joystick (byte[3]) or button (bytes[5..7]).
-
-        if (msg.data[3] != 0x00) {
-            uint8_t joy_id = 0;
-            bool    known  = true;
-
-            switch (msg.data[3]) {
-                case 0x01: joy_id = protocol::kStickCenter; break;
-                case 0x10: joy_id = protocol::kStickUp;     break;
-                case 0x70: joy_id = protocol::kStickDown;   break;
-                case 0xA0: joy_id = protocol::kStickLeft;   break;
-                case 0x40: joy_id = protocol::kStickRight;  break;
-                default:   known  = false;                  break;
-            }
-
-            if (known) {
-                last_joystick_id_ = joy_id;
-                joystick_active_  = true;
-
-                if (config::kDebugKeys) {
-                    ESP_LOGI(kTag, "Joystick press: 0x%02X", joy_id);
-                }
-
-                InputEvent event;
-                event.type  = InputEvent::Type::Joystick;
-                event.id    = joy_id;
-                event.state = protocol::kInputPressed;
-                Emit(event);
-                return;
-            }
+    // Joystick: byte[3] holds one direction. A change releases the old one
+    // and presses the new one, in the same frame; every frame it stays is a
+    // held frame (with no timed repeat the cursor steps on those).
+    uint8_t stick_raw = msg.data[3];
+    if (stick_raw == stick_raw_) {
+        if (joystick_active_) {
+            EmitStick(last_joystick_id_, protocol::kInputHeld);
         }
+    } else {
+        stick_raw_ = stick_raw;
 
-        // Buttons encoded as bits relative to idle baseline.
-        uint8_t button_id    = 0;
-        bool    known_button = true;
-
-        if      (msg.data[5] & 0x01) button_id = protocol::kButtonOption;
-        else if (msg.data[5] & 0x08) button_id = protocol::kButtonTel;
-        else if (msg.data[6] & 0x01) button_id = protocol::kButtonCd;
-        else if (msg.data[6] & 0x08) button_id = protocol::kButtonNav;
-        else if (msg.data[7] & 0x01) button_id = protocol::kButtonMap;
-        else                         known_button = false;
-
-        if (known_button && button_id != 0) {
-            last_button_id_ = button_id;
-
-            if (config::kDebugKeys) {
-                ESP_LOGI(kTag, "Button press: 0x%02X", button_id);
-            }
-
-            InputEvent event;
-            event.type  = InputEvent::Type::Button;
-            event.id    = button_id;
-            event.state = protocol::kInputPressed;
-            Emit(event);
-            return;
+        if (joystick_active_) {
+            EmitStick(last_joystick_id_, protocol::kInputReleased);
+            joystick_active_ = false;
         }
 
-        if (config::kDebugKeys) {
-            ESP_LOGW(kTag, "Unknown press frame: [%02X %02X %02X %02X %02X]",
-                     msg.data[3], msg.data[4], msg.data[5], msg.data[6], msg.data[7]);
+        uint8_t joy_id = 0;
+        if (DecodeStick(stick_raw, joy_id)) {
+            last_joystick_id_ = joy_id;
+            joystick_active_  = true;
+            EmitStick(joy_id, protocol::kInputPressed);
+        } else if (stick_raw != kIdleByte3 && config::kDebugKeys) {
+            ESP_LOGW(kTag, "Unknown joystick byte: 0x%02X", stick_raw);
         }
-        return;
     }
 
-    // Idle frame: emit pending releases, then check for rotary movement.
+    // Buttons: bits relative to the idle baseline, diffed against the last
+    // frame. Every changed bit is one edge, taken highest bit first.
+    uint32_t raw =
+        PackButtons(msg.data[4], msg.data[5], msg.data[6], msg.data[7]) ^ kIdleButtons;
+    uint32_t buttons = raw & kButtonTable.mask;
+    uint32_t changed = buttons ^ buttons_;
+    buttons_         = buttons;
+
+    while (changed != 0) {
+        uint32_t bit = 31 - __builtin_clz(changed);
+        changed &= ~(1u << bit);
+        EmitButton(kButtonTable.id[bit], (buttons >> bit) & 1u);
+    }
 
-    if (joystick_active_) {
-        if (config::kDebugKeys) {
-            ESP_LOGI(kTag, "Joystick release: 0x%02X", last_joystick_id_);
-        }
-        InputEvent event;
-        event.type  = InputEvent::Type::Joystick;
-        event.id    = last_joystick_id_;
-        event.state = protocol::kInputReleased;
-        Emit(event);
-        joystick_active_  = false;
-        last_joystick_id_ = 0;
-        return;
+    if (config::kDebugKeys && (raw & ~kButtonTable.mask) != 0) {
+        ESP_LOGW(kTag, "Unknown button bits: [%02X %02X %02X %02X]", msg.data[4], msg.data[5],
+                 msg.data[6], msg.data[7]);
     }
 
-    if (last_button_id_ != 0) {
-        if (config::kDebugKeys) {
-            ESP_LOGI(kTag, "Button release: 0x%02X", last_button_id_);
-        }
-        InputEvent event;
-        event.type  = InputEvent::Type::Button;
-        event.id    = last_button_id_;
-        event.state = protocol::kInputReleased;
-        Emit(event);
-        last_button_id_ = 0;
+    // Rotary: only idle frames carry a position to compare.
+    if (stick_raw != kIdleByte3 || raw != 0)
         return;
-    }
 
-    // Rotary: idle frame where byte[1] position changed.
     if (!position_set_) {
         position_     = new_position;
         position_set_ = true;
@@ -0,0 +1,126 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+
+#include "input/digitizer_encoder.h"
+
+#include "config/config.h"
+
+namespace idrive {
+
+namespace {
+
+int32_t Clamp(int32_t v)
+{
+    return v < 0 ? 0 : (v > DigitizerEncoder::kRawMax ? DigitizerEncoder::kRawMax : v);
+}
+
+}  // namespace
+
+uint16_t DigitizerEncoder::ScaleX(int32_t x)
+{
+    return static_cast<uint16_t>(Clamp(x) * kDigitizerLogicalMax / kRawMax);
+}
+
+uint16_t DigitizerEncoder::ScaleY(int32_t y)
+{
+    return static_cast<uint16_t>((kRawMax - Clamp(y)) * kDigitizerLogicalMax / kRawMax);
+}
+
+void DigitizerEncoder::Put(DigitizerContact &contact, const Slot &slot, bool tip)
+{
+    uint16_t x   = ScaleX(slot.x);
+    uint16_t y   = ScaleY(slot.y);
+    contact.tip  = tip ? 1 : 0;
+    contact.id   = slot.id;
+    contact.x[0] = static_cast<uint8_t>(x & 0xFF);
+    contact.x[1] = static_cast<uint8_t>(x >> 8);
+    contact.y[0] = static_cast<uint8_t>(y & 0xFF);
+    contact.y[1] = static_cast<uint8_t>(y >> 8);
+}
+
+bool DigitizerEncoder::Encode(const InputEvent &event, DigitizerReport &report)
+{
+    // Finger positions in this frame. 3/4-finger states carry only one.
+    int16_t px[kDigitizerContacts] = {};
+    int16_t py[kDigitizerContacts] = {};
+    size_t  n                      = 0;
+    if (event.state != protocol::kTouchFingerRemoved) {
+        px[n]   = event.x;
+        py[n++] = event.y;
+        if (event.two_fingers) {
+            px[n]   = event.x2;
+            py[n++] = event.y2;
+        }
+    }
+
+    // Squared distance from a position to a contact that is down (0 for a
+    // free slot, which any position may take).
+    auto cost = [&](size_t point, size_t s) -> int64_t {
+        if (!slots_[s].active) {
+            return 0;
+        }
+        int64_t dx = px[point] - slots_[s].x;
+        int64_t dy = py[point] - slots_[s].y;
+        return dx * dx + dy * dy;
+    };
+
+    // Positions go to the slots in order, or crossed over if that keeps the
+    // contacts already down closer to where they were.
+    bool crossed = false;
+    if (n == 1) {
+        crossed = slots_[1].active && (!slots_[0].active || cost(0, 1) < cost(0, 0));
+    } else if (n == 2) {
+        crossed = cost(0, 1) + cost(1, 0) < cost(0, 0) + cost(1, 1);
+    }
+
+    report     = DigitizerReport();
+    bool lifts = false;
+    for (size_t s = 0; s < kDigitizerContacts; ++s) {
+        Slot &slot  = slots_[s];
+        bool  taken = false;
+        for (size_t i = 0; i < n; ++i) {
+            if ((crossed ? kDigitizerContacts - 1 - i : i) == s) {
+                if (!slot.active) {
+                    slot.active = true;
+                    slot.id     = next_id_++;
+                }
+                slot.x = px[i];
+                slot.y = py[i];
+                taken  = true;
+            }
+        }
+
+        if (taken) {
+            Put(report.contacts[report.count++], slot, true);
+        } else if (slot.active) {
+            // Lifted: once more with the tip switch off, at its last position.
+            slot.active = false;
+            Put(report.contacts[report.count++], slot, false);
+            lifts = true;
+        }
+    }
+    return lifts;
+}
+
+bool DigitizerEncoder::LiftAll(DigitizerReport &report)
+{
+    report = DigitizerReport();
+    for (Slot &slot : slots_) {
+        if (slot.active) {
+            slot.active = false;
+            Put(report.contacts[report.count++], slot, false);
+        }
+    }
+    return report.count > 0;
+}
+
+uint8_t DigitizerEncoder::ActiveContacts() const
+{
+    uint8_t count = 0;
+    for (const Slot &slot : slots_) {
+        count += slot.active ? 1 : 0;
+    }
+    return count;
+}
+
+}  // namespace idrive
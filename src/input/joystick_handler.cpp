@@ -14,9 +14,69 @@ namespace {
 const char *kTag = "JOYSTICK";
 }
 
-JoystickHandler::JoystickHandler(UsbHidDevice &hid, bool as_mouse, int move_step)
+JoystickHandler::JoystickHandler(UsbHidDevice &hid, bool as_mouse, int move_step,
+                                 uint32_t repeat_delay_ms, uint32_t repeat_rate_hz)
     : InputHandler(hid), as_mouse_(as_mouse), move_step_(move_step)
-{}
+{
+    SetRepeat(repeat_delay_ms, repeat_rate_hz);
+}
+
+void JoystickHandler::SetAsMouse(bool as_mouse)
+{
+    as_mouse_ = as_mouse;
+    repeat_.Release();
+}
+
+void JoystickHandler::SetRepeat(uint32_t delay_ms, uint32_t rate_hz)
+{
+    StickRepeatParams params;
+    params.delay_us    = delay_ms * 1000;
+    params.interval_us = rate_hz ? 1000000 / rate_hz : 0;
+    params.start_speed = config::kJoystickGlideStartSpeed;
+    params.max_speed   = config::kJoystickGlideMaxSpeed;
+    params.ramp_us     = config::kJoystickGlideRampMs * 1000;
+    repeat_.SetParams(params);
+    repeat_.Release();
+    repeat_rate_hz_ = rate_hz;
+}
+
+uint8_t JoystickHandler::ArrowKey(uint8_t direction)
+{
+    if (direction & protocol::kStickUp) {
+        return hid::key::kUp;
+    }
+    if (direction & protocol::kStickDown) {
+        return hid::key::kDown;
+    }
+    if (direction & protocol::kStickLeft) {
+        return hid::key::kLeft;
+    }
+    if (direction & protocol::kStickRight) {
+        return hid::key::kRight;
+    }
+    return 0;
+}
+
+void JoystickHandler::Tick(uint64_t now_us)
+{
+    if (!IsRepeating()) {
+        return;
+    }
+
+    if (as_mouse_) {
+        int32_t dx = 0;
+        int32_t dy = 0;
+        repeat_.TakeGlide(now_us, dx, dy);
+        if (dx != 0 || dy != 0) {
+            hid_.MouseMove(static_cast<int16_t>(dx), static_cast<int16_t>(dy));
+        }
+    } else if (repeat_.TakeRepeat(now_us)) {
+        uint8_t key = ArrowKey(repeat_.Direction());
+        if (key != 0) {
+            hid_.KeyPressAndRelease(key);
+        }
+    }
+}
 
 bool JoystickHandler::Handle(const InputEvent &event)
 {
@@ -26,12 +86,20 @@ bool JoystickHandler::Handle(const InputEvent &event)
 
     uint8_t direction = event.id;
     uint8_t state     = event.state;
+    bool    pushed    = state == protocol::kInputPressed || state == protocol::kInputHeld;
+    bool    stick     = direction != protocol::kStickCenter;
+
+    // Any release ends a hold, whatever direction it reports.
+    if (state == protocol::kInputReleased) {
+        repeat_.Release();
+    }
 
     if (as_mouse_) {
-        // Joystick as mouse movement.
-        if (state == protocol::kInputPressed || state == protocol::kInputHeld) {
-            int8_t x = 0;
-            int8_t y = 0;
+        // Joystick as mouse movement. With timed repeat, only the press
+        // steps; the glide from Tick() takes over while it is held.
+        if (pushed && stick && (!IsRepeating() || repeat_.Press(direction, event.timestamp_us))) {
+            int16_t x = 0;
+            int16_t y = 0;
 
             if (direction & protocol::kStickUp) {
                 y = -move_step_;
@@ -53,7 +121,7 @@ bool JoystickHandler::Handle(const InputEvent &event)
         }
 
         // Center press as left click.
-        if (direction == protocol::kStickCenter) {
+        if (!stick) {
             if (state == protocol::kInputPressed) {
                 ESP_LOGI(kTag, "Joystick center pressed - left click");
                 hid_.MouseButtonPress(hid::mouse::kButtonLeft);
@@ -62,21 +130,16 @@ bool JoystickHandler::Handle(const InputEvent &event)
                 hid_.MouseButtonRelease(hid::mouse::kButtonLeft);
             }
         }
-    } else {
-        // Joystick as arrow keys.
-        uint8_t key = 0;
-
-        if (direction & protocol::kStickUp) {
-            key = hid::key::kUp;
-        } else if (direction & protocol::kStickDown) {
-            key = hid::key::kDown;
-        } else if (direction & protocol::kStickLeft) {
-            key = hid::key::kLeft;
-        } else if (direction & protocol::kStickRight) {
-            key = hid::key::kRight;
-        } else if (direction == protocol::kStickCenter) {
-            key = hid::key::kEnter;
+    } else if (stick && IsRepeating()) {
+        // Arrow keys, typed: one key on the press, repeats from Tick().
+        uint8_t key = ArrowKey(direction);
+        if (key != 0 && pushed && repeat_.Press(direction, event.timestamp_us)) {
+            ESP_LOGI(kTag, "Joystick arrow key: 0x%02X", key);
+            hid_.KeyPressAndRelease(key);
         }
+    } else {
+        // Joystick as arrow keys (Enter for the center), held until release.
+        uint8_t key = stick ? ArrowKey(direction) : hid::key::kEnter;
 
         if (key != 0) {
             if (state == protocol::kInputPressed) {
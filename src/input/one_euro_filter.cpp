@@ -0,0 +1,111 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+
+#include "input/one_euro_filter.h"
+
+#include <cstdlib>
+
+#include "config/config.h"
+
+namespace idrive {
+
+namespace {
+
+// 1e9 / (2 * pi): time constant in us of a 1 mHz low-pass.
+constexpr uint64_t kTauUsPerMhz = 159154943;
+
+// Keep the cutoff (and so the smoothing factor) in a sane range.
+constexpr uint32_t kMaxCutoffMhz = 1000000;
+
+}  // namespace
+
+uint32_t OneEuroAxis::TauUs(uint32_t cutoff_mhz)
+{
+    if (cutoff_mhz == 0) {
+        return UINT32_MAX;
+    }
+    return static_cast<uint32_t>(kTauUsPerMhz / cutoff_mhz);
+}
+
+uint32_t OneEuroAxis::Alpha(uint32_t cutoff_mhz, uint32_t dt_us)
+{
+    // alpha = dt / (dt + tau)
+    uint64_t tau = TauUs(cutoff_mhz);
+    return static_cast<uint32_t>((static_cast<uint64_t>(dt_us) << 16) / (dt_us + tau));
+}
+
+int16_t OneEuroAxis::Step(int16_t raw, uint64_t t_us, const OneEuroParams &params,
+                          uint32_t &lag_us)
+{
+    int32_t sample = static_cast<int32_t>(raw) << kFracBits;
+
+    if (!primed_) {
+        value_   = sample;
+        speed_   = 0;
+        last_us_ = t_us;
+        primed_  = true;
+        lag_us   = 0;
+        return raw;
+    }
+
+    uint64_t elapsed = t_us - last_us_;
+    uint32_t dt_us   = elapsed < kMinDtUs ? kMinDtUs
+                     : elapsed > kMaxDtUs ? kMaxDtUs
+                                          : static_cast<uint32_t>(elapsed);
+    last_us_         = t_us;
+
+    // Speed estimate, itself low-passed so noise does not open the cutoff.
+    int64_t raw_speed = static_cast<int64_t>(sample - value_) * 1000000 / dt_us;
+    int64_t alpha_d   = Alpha(params.d_cutoff_mhz, dt_us);
+    speed_ += static_cast<int32_t>(((raw_speed - speed_) * alpha_d) >> 16);
+
+    // Cutoff grows with speed (Q4 speed -> whole units/s).
+    uint64_t cutoff = params.min_cutoff_mhz +
+                      ((static_cast<uint64_t>(params.beta_mhz) * std::abs(speed_)) >> kFracBits);
+    if (cutoff > kMaxCutoffMhz) {
+        cutoff = kMaxCutoffMhz;
+    }
+
+    int64_t alpha = Alpha(static_cast<uint32_t>(cutoff), dt_us);
+    value_ += static_cast<int32_t>((static_cast<int64_t>(sample - value_) * alpha) >> 16);
+
+    // A first-order low-pass trails a moving input by its time constant.
+    lag_us = TauUs(static_cast<uint32_t>(cutoff));
+    return static_cast<int16_t>((value_ + (1 << (kFracBits - 1))) >> kFracBits);
+}
+
+void OneEuroTouchFilter::Apply(InputEvent &event)
+{
+    // A lift, or a change in finger count, starts a new contact: the
+    // coordinates jump and must not be smoothed across.
+    if (event.state != last_state_) {
+        Reset();
+        last_state_ = event.state;
+    }
+    if (event.state == protocol::kTouchFingerRemoved) {
+        return;
+    }
+
+    uint32_t lag_x = 0;
+    uint32_t lag_y = 0;
+    event.x        = x_.Step(event.x, event.timestamp_us, params_, lag_x);
+    event.y        = y_.Step(event.y, event.timestamp_us, params_, lag_y);
+
+    if (event.two_fingers) {
+        uint32_t lag = 0;
+        event.x2     = x2_.Step(event.x2, event.timestamp_us, params_, lag);
+        event.y2     = y2_.Step(event.y2, event.timestamp_us, params_, lag);
+    }
+
+    added_latency_.Record(lag_x > lag_y ? lag_x : lag_y);
+}
+
+void OneEuroTouchFilter::Reset()
+{
+    x_.Reset();
+    y_.Reset();
+    x2_.Reset();
+    y2_.Reset();
+}
+
+}  // namespace idrive
@@ -0,0 +1,120 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+
+#include "input/rotary_accel.h"
+
+#include <cstdlib>
+
+#include "hid/hid_mouse.h"
+
+namespace idrive {
+
+namespace {
+
+// Unity up to a comfortable turning speed, then rising to the profile's cap.
+constexpr RotaryGainPoint kModerate[] = {{0, 256}, {10, 256}, {30, 512}, {60, 1024}};
+constexpr RotaryGainPoint kFast[]     = {{0, 256}, {10, 256}, {25, 768}, {50, 1792}, {80, 2560}};
+
+template <size_t N>
+int32_t Interpolate(const RotaryGainPoint (&curve)[N], uint32_t speed)
+{
+    for (size_t i = 1; i < N; ++i) {
+        if (speed < curve[i].speed) {
+            const RotaryGainPoint &a = curve[i - 1];
+            const RotaryGainPoint &b = curve[i];
+            return a.gain + (static_cast<int32_t>(b.gain) - a.gain) *
+                                static_cast<int32_t>(speed - a.speed) / (b.speed - a.speed);
+        }
+    }
+    return curve[N - 1].gain;
+}
+
+}  // namespace
+
+void RotaryAccel::SetProfile(RotaryAccelProfile profile)
+{
+    profile_ = profile;
+    Reset();
+}
+
+int32_t RotaryAccel::GainAt(uint32_t speed) const
+{
+    switch (profile_) {
+        case RotaryAccelProfile::Moderate: return Interpolate(kModerate, speed);
+        case RotaryAccelProfile::Fast:     return Interpolate(kFast, speed);
+        case RotaryAccelProfile::Off:      break;
+    }
+    return kGainOne;
+}
+
+void RotaryAccel::Reset()
+{
+    head_      = 0;
+    count_     = 0;
+    direction_ = 0;
+    speed_     = 0;
+    remainder_.Reset();
+}
+
+uint32_t RotaryAccel::EstimateSpeed(uint64_t now_us) const
+{
+    // Detents after the oldest event still in the window, over the time since
+    // it. A lone event (first detent, or after a pause) has no speed.
+    uint64_t window_us = config::kRotaryVelocityWindowMs * 1000ULL;
+    uint32_t detents   = 0;
+    uint64_t oldest_us = now_us;
+    for (size_t i = 0; i < count_; ++i) {
+        const Sample &s = history_[(head_ + kHistory - 1 - i) % kHistory];
+        if (now_us - s.t_us > window_us) {
+            break;
+        }
+        detents += i == 0 ? 0 : history_[(head_ + kHistory - i) % kHistory].detents;
+        oldest_us = s.t_us;
+    }
+    if (now_us == oldest_us) {
+        return 0;
+    }
+    return static_cast<uint32_t>(detents * 1000000ULL / (now_us - oldest_us));
+}
+
+int32_t RotaryAccel::Apply(int32_t detents, uint64_t t_us)
+{
+    if (detents == 0) {
+        return 0;
+    }
+
+    int8_t direction = detents > 0 ? 1 : -1;
+    if (direction != direction_) {
+        Reset();
+        direction_ = direction;
+    }
+
+    Sample &sample = history_[head_];
+    sample.t_us    = t_us;
+    sample.detents = static_cast<uint16_t>(std::abs(detents));
+    head_          = (head_ + 1) % kHistory;
+    count_         = count_ < kHistory ? count_ + 1 : kHistory;
+
+    speed_       = EstimateSpeed(t_us);
+    int32_t gain = GainAt(speed_);
+
+    // At unity gain a detent is exactly a detent; a fraction left over from a
+    // faster spin must not add a stray one.
+    if (gain == kGainOne) {
+        remainder_.Reset();
+    }
+
+    // A corrupt position jump can be tens of thousands of detents; clip it to
+    // one report's range rather than overflow the accumulator.
+    int64_t units_q8 = static_cast<int64_t>(detents) * gain * kWheelUnitsPerDetent;
+    int64_t limit_q8 = static_cast<int64_t>(kMouseReportMax) * kGainOne;
+    if (units_q8 > limit_q8) {
+        units_q8 = limit_q8;
+    } else if (units_q8 < -limit_q8) {
+        units_q8 = -limit_q8;
+    }
+    remainder_.Add(static_cast<int32_t>(units_q8));
+    return remainder_.Take(kMouseReportMax);
+}
+
+}  // namespace idrive
@@ -4,10 +4,9 @@
 #include "input/rotary_handler.h"
 
 #include "esp_log.h"
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
 
 #include "hid/hid_keycodes.h"
+#include "hid/hid_mouse.h"
 
 namespace idrive {
 
@@ -31,9 +30,13 @@ bool RotaryHandler::Handle(const InputEvent &event)
     // Volume/track controls are on steering wheel.
     if (steps != 0) {
         // Positive = scroll down, Negative = scroll up (natural scrolling)
-        int8_t scroll = static_cast<int8_t>(-steps);  // Invert for natural feel
-        ESP_LOGI(kTag, "Rotary scroll: %d steps -> wheel %d", steps, scroll);
-        hid_.MouseScroll(scroll);
+        int32_t units = accel_.Apply(-steps, event.timestamp_us);
+        ESP_LOGI(kTag, "Rotary scroll: %d steps -> wheel %ld/%ld (%lu detents/s)", steps,
+                 static_cast<long>(units), static_cast<long>(kWheelUnitsPerDetent),
+                 static_cast<unsigned long>(accel_.Speed()));
+        if (units != 0) {
+            hid_.MouseScrollHiRes(units);
+        }
     }
 
     return true;
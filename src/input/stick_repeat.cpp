@@ -0,0 +1,134 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+
+#include "input/stick_repeat.h"
+
+#include "config/config.h"
+#include "hid/hid_mouse.h"
+
+namespace idrive {
+
+bool StickRepeat::Press(uint8_t direction, uint64_t t_us)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (direction == direction_) {
+        return false;  // Held frame, or the press repeated
+    }
+
+    direction_ = direction;
+    press_us_  = t_us;
+    next_us_   = t_us + params_.delay_us;
+    glide_us_  = next_us_;
+    held_      = false;
+    distance_.Reset();
+    return true;
+}
+
+void StickRepeat::Release()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    direction_ = 0;
+    held_      = false;
+    distance_.Reset();
+}
+
+void StickRepeat::MarkHeld()
+{
+    if (!held_) {
+        held_ = true;
+        stats_.holds++;
+    }
+}
+
+bool StickRepeat::TakeRepeat(uint64_t now_us)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (direction_ == 0 || params_.interval_us == 0 || now_us < next_us_) {
+        return false;
+    }
+
+    MarkHeld();
+    uint64_t missed = (now_us - next_us_) / params_.interval_us;
+    next_us_ += (missed + 1) * params_.interval_us;
+    stats_.skipped += static_cast<uint32_t>(missed);
+    stats_.repeats++;
+    return true;
+}
+
+int32_t StickRepeat::SpeedAt(uint64_t t_us) const
+{
+    uint64_t start_us = press_us_ + params_.delay_us;
+    uint64_t ramp_us  = t_us > start_us ? t_us - start_us : 0;
+    if (ramp_us >= params_.ramp_us) {
+        return params_.max_speed;
+    }
+    int64_t rise = params_.max_speed - params_.start_speed;
+    return params_.start_speed +
+           static_cast<int32_t>(rise * static_cast<int64_t>(ramp_us) / params_.ramp_us);
+}
+
+void StickRepeat::TakeGlide(uint64_t now_us, int32_t &dx, int32_t &dy)
+{
+    dx = 0;
+    dy = 0;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (direction_ == 0 || now_us <= glide_us_) {
+        return;
+    }
+
+    // Distance at the speed halfway through the step, exact on the linear ramp.
+    MarkHeld();
+    uint64_t from_us = now_us - glide_us_ > kMaxStepUs ? now_us - kMaxStepUs : glide_us_;
+    uint64_t step_us = now_us - from_us;
+    int64_t  speed   = SpeedAt(from_us + step_us / 2);
+    glide_us_        = now_us;
+    distance_.Add(static_cast<int32_t>(speed * static_cast<int64_t>(step_us) *
+                                       SubpixelAccumulator::kOne / 1000000));
+
+    int32_t distance = distance_.Take(kMouseReportMax);
+    if (direction_ & protocol::kStickUp) {
+        dy = -distance;
+    }
+    if (direction_ & protocol::kStickDown) {
+        dy = distance;
+    }
+    if (direction_ & protocol::kStickLeft) {
+        dx = -distance;
+    }
+    if (direction_ & protocol::kStickRight) {
+        dx = distance;
+    }
+}
+
+uint8_t StickRepeat::Direction() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return direction_;
+}
+
+void StickRepeat::SetParams(const StickRepeatParams &params)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    params_ = params;
+}
+
+StickRepeatParams StickRepeat::Params() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return params_;
+}
+
+StickRepeatStats StickRepeat::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void StickRepeat::ResetStats()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_ = StickRepeatStats();
+}
+
+}  // namespace idrive
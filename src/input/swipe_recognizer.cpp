@@ -0,0 +1,158 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+
+#include "input/swipe_recognizer.h"
+
+#include <cstdlib>
+
+#include "config/config.h"
+
+namespace idrive {
+
+namespace {
+
+using State = SwipeRecognizer::State;
+using Event = SwipeRecognizer::Event;
+
+enum class Action : uint8_t {
+    None,
+    Begin,   // Anchor a new contact at this sample
+    Fire,    // Report the swipe
+    Reject,  // Give up on this contact
+};
+
+struct Transition {
+    State  next;
+    Action action;
+};
+
+constexpr size_t kStates = static_cast<size_t>(State::kCount);
+constexpr size_t kEvents = static_cast<size_t>(Event::kCount);
+
+// Columns: Lift, Release, Count, Expired, Swipe, Drift, Move.
+// Idle only sees Lift, Release or Count (a 3/4-finger sample with no contact
+// anchored). A finger count change while tracking re-anchors, since fingers
+// rarely land together; dropping below three fingers before a swipe abandons
+// the contact. After firing or rejecting, the contact is ignored until every
+// finger has lifted, so fingers put back down cannot fire it again.
+constexpr Transition kTransitions[kStates][kEvents] = {
+    // Idle
+    {{State::Idle, Action::None}, {State::Idle, Action::None},
+     {State::Tracking, Action::Begin}, {State::Tracking, Action::Begin},
+     {State::Tracking, Action::Begin}, {State::Tracking, Action::Begin},
+     {State::Tracking, Action::Begin}},
+    // Tracking
+    {{State::Idle, Action::None}, {State::Idle, Action::None},
+     {State::Tracking, Action::Begin}, {State::Rejected, Action::Reject},
+     {State::Fired, Action::Fire}, {State::Rejected, Action::Reject},
+     {State::Tracking, Action::None}},
+    // Fired
+    {{State::Idle, Action::None}, {State::Fired, Action::None}, {State::Fired, Action::None},
+     {State::Fired, Action::None}, {State::Fired, Action::None}, {State::Fired, Action::None},
+     {State::Fired, Action::None}},
+    // Rejected
+    {{State::Idle, Action::None}, {State::Rejected, Action::None},
+     {State::Rejected, Action::None}, {State::Rejected, Action::None},
+     {State::Rejected, Action::None}, {State::Rejected, Action::None},
+     {State::Rejected, Action::None}},
+};
+
+}  // namespace
+
+const char *SwipeDirectionName(SwipeDirection direction)
+{
+    switch (direction) {
+        case SwipeDirection::Up:    return "up";
+        case SwipeDirection::Down:  return "down";
+        case SwipeDirection::Left:  return "left";
+        case SwipeDirection::Right: return "right";
+    }
+    return "?";
+}
+
+uint8_t SwipeRecognizer::Fingers(uint8_t touch_state)
+{
+    switch (touch_state) {
+        case protocol::kTouchTriple: return 3;
+        case protocol::kTouchQuad:   return 4;
+        default:                     return 0;
+    }
+}
+
+SwipeRecognizer::Event SwipeRecognizer::Classify(const InputEvent &event, uint8_t fingers)
+{
+    if (event.state == protocol::kTouchFingerRemoved) {
+        return Event::Lift;
+    }
+    if (fingers == 0) {
+        return Event::Release;
+    }
+    if (fingers != fingers_ || state_ == State::Idle) {
+        return Event::Count;
+    }
+    if (event.timestamp_us - anchor_us_ > static_cast<uint64_t>(params_.max_duration) * 1000) {
+        return Event::Expired;
+    }
+
+    // Touchpad Y increases upward.
+    int32_t dx    = event.x - anchor_x_;
+    int32_t dy    = event.y - anchor_y_;
+    int32_t ax    = std::abs(dx);
+    int32_t ay    = std::abs(dy);
+    int32_t along = ax > ay ? ax : ay;
+    int32_t off   = ax > ay ? ay : ax;
+
+    if (along < params_.min_distance) {
+        return Event::Move;
+    }
+    if (along < off * params_.axis_ratio) {
+        return Event::Drift;
+    }
+    if (ax > ay) {
+        direction_ = dx > 0 ? SwipeDirection::Right : SwipeDirection::Left;
+    } else {
+        direction_ = dy > 0 ? SwipeDirection::Up : SwipeDirection::Down;
+    }
+    return Event::Swipe;
+}
+
+SwipeResult SwipeRecognizer::Feed(const InputEvent &event)
+{
+    SwipeResult result;
+    if (event.type != InputEvent::Type::Touchpad) {
+        return result;
+    }
+
+    uint8_t           fingers    = Fingers(event.state);
+    Event             e          = Classify(event, fingers);
+    const Transition &transition = kTransitions[static_cast<size_t>(state_)]
+                                               [static_cast<size_t>(e)];
+
+    switch (transition.action) {
+        case Action::None:
+            break;
+        case Action::Begin:
+            if (state_ == State::Idle) {
+                stats_.contacts++;
+            }
+            fingers_   = fingers;
+            anchor_x_  = event.x;
+            anchor_y_  = event.y;
+            anchor_us_ = event.timestamp_us;
+            break;
+        case Action::Fire:
+            result.fired     = true;
+            result.fingers   = fingers_;
+            result.direction = direction_;
+            stats_.fired++;
+            break;
+        case Action::Reject:
+            stats_.rejected++;
+            break;
+    }
+
+    state_ = transition.next;
+    return result;
+}
+
+}  // namespace idrive
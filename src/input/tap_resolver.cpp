@@ -0,0 +1,187 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+
+#include "input/tap_resolver.h"
+
+#include <cstdlib>
+
+namespace idrive {
+
+void TapResolver::Begin(State state, int16_t x, int16_t y, uint64_t t_us)
+{
+    state_   = state;
+    down_us_ = t_us;
+    down_x_  = x;
+    down_y_  = y;
+    moved_   = false;
+}
+
+TapAction TapResolver::Emit(TapAction action, uint64_t t_us)
+{
+    switch (action) {
+        case TapAction::Click:
+            stats_.clicks++;
+            click_latency_.Record(static_cast<uint32_t>(t_us - lift_us_));
+            break;
+        case TapAction::DoubleClick:
+            // The first tap's click waited for the second lift.
+            stats_.double_clicks++;
+            click_latency_.Record(static_cast<uint32_t>(t_us - lift_us_));
+            break;
+        case TapAction::DragStart:
+            stats_.drags++;
+            break;
+        case TapAction::None:
+        case TapAction::DragEnd:
+            break;
+    }
+    return action;
+}
+
+TapAction TapResolver::TouchDown(int16_t x, int16_t y, uint64_t t_us)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    bool in_window = t_us - lift_us_ < params_.window_us;
+
+    switch (state_) {
+        case State::TapPending:
+            if (in_window) {
+                Begin(State::SecondTouch, x, y, t_us);
+                return TapAction::None;
+            }
+            // The timer has not caught up yet; the old tap still clicks.
+            Begin(State::Touching, x, y, t_us);
+            return Emit(TapAction::Click, t_us);
+        case State::WaitSecond:
+            if (in_window) {
+                state_ = State::Dragging;
+                return Emit(TapAction::DragStart, t_us);
+            }
+            break;
+        case State::Dragging:
+            return TapAction::None;
+        default:
+            break;
+    }
+    Begin(State::Touching, x, y, t_us);
+    return TapAction::None;
+}
+
+TapAction TapResolver::Move(int16_t x, int16_t y, uint64_t t_us)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (std::abs(x - down_x_) > params_.max_movement ||
+        std::abs(y - down_y_) > params_.max_movement) {
+        moved_ = true;
+    }
+
+    // Moving on the second touch is a tap-drag.
+    if (state_ == State::SecondTouch && moved_) {
+        state_ = State::Dragging;
+        return Emit(TapAction::DragStart, t_us);
+    }
+    return TapAction::None;
+}
+
+TapAction TapResolver::TouchUp(uint64_t t_us)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    bool is_tap = t_us - down_us_ < params_.tap_max_us && !moved_;
+
+    switch (state_) {
+        case State::Touching:
+            if (!is_tap) {
+                state_ = State::Idle;
+                return TapAction::None;
+            }
+            lift_us_ = t_us;
+            if (mode_ == TapMode::FastClick) {
+                state_ = State::WaitSecond;
+                return Emit(TapAction::Click, t_us);
+            }
+            state_ = State::TapPending;
+            return TapAction::None;
+        case State::SecondTouch:
+            // A second tap is a double click. A late lift the timer missed
+            // as a hold is still the first tap's click.
+            state_ = State::Idle;
+            return Emit(is_tap ? TapAction::DoubleClick : TapAction::Click, t_us);
+        case State::Dragging:
+            state_ = State::Idle;
+            return Emit(TapAction::DragEnd, t_us);
+        default:
+            return TapAction::None;
+    }
+}
+
+TapAction TapResolver::Cancel(uint64_t t_us)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    switch (state_) {
+        case State::TapPending:
+            return TapAction::None;  // Still clicks when the window expires
+        case State::SecondTouch:
+            state_ = State::Idle;
+            return Emit(TapAction::Click, t_us);
+        case State::Dragging:
+            state_ = State::Idle;
+            return Emit(TapAction::DragEnd, t_us);
+        default:
+            state_ = State::Idle;
+            return TapAction::None;
+    }
+}
+
+TapAction TapResolver::Tick(uint64_t now_us)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    switch (state_) {
+        case State::TapPending:
+            if (now_us - lift_us_ >= params_.window_us) {
+                state_ = State::Idle;
+                return Emit(TapAction::Click, now_us);
+            }
+            break;
+        case State::WaitSecond:
+            if (now_us - lift_us_ >= params_.window_us) {
+                state_ = State::Idle;
+            }
+            break;
+        case State::SecondTouch:
+            if (now_us - down_us_ >= params_.hold_us) {
+                state_ = State::Dragging;
+                return Emit(TapAction::DragStart, now_us);
+            }
+            break;
+        default:
+            break;
+    }
+    return TapAction::None;
+}
+
+void TapResolver::SetMode(TapMode mode)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    mode_ = mode;
+}
+
+TapStats TapResolver::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+utils::LatencyHistogram TapResolver::ClickLatency() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return click_latency_;
+}
+
+void TapResolver::ResetStats()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_ = TapStats();
+    click_latency_.Reset();
+}
+
+}  // namespace idrive
@@ -6,119 +6,367 @@
 #include <cmath>
 
 #include "esp_log.h"
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
 
 #include "config/config.h"
 #include "hid/hid_keycodes.h"
-#include "utils/utils.h"
+#include "hid/hid_mouse.h"
 
 namespace idrive {
 
 namespace {
+
 const char *kTag = "TOUCHPAD";
+
+constexpr SwipeAction Consumer(uint16_t usage)
+{
+    return {SwipeAction::Kind::Consumer, usage};
+}
+
+// Squared-spacing ratio (Q8) for a change of `percent` in finger spacing, so
+// spacing thresholds compare against squared distances without a sqrt.
+constexpr int64_t SquaredRatioQ8(int percent)
+{
+    return static_cast<int64_t>(100 + percent) * (100 + percent) * 256 / 10000;
+}
+
+constexpr int64_t kPinchEnterQ8    = SquaredRatioQ8(config::kPinchEnterPercent);
+constexpr int64_t kPinchBreakoutQ8 = SquaredRatioQ8(config::kPinchBreakoutPercent);
+constexpr int64_t kPinchStepQ8     = SquaredRatioQ8(config::kPinchStepPercent);
+constexpr int     kMaxZoomSteps    = 8;  // Per sample
+
+// Squared finger spacing of a two-finger sample.
+int64_t SpacingSquared(const InputEvent &event)
+{
+    int64_t dx     = event.x2 - event.x;
+    int64_t dy     = event.y2 - event.y;
+    int64_t d2     = dx * dx + dy * dy;
+    int64_t min_d2 = static_cast<int64_t>(config::kPinchMinSpacing) * config::kPinchMinSpacing;
+    return d2 > min_d2 ? d2 : min_d2;
+}
+
+// True if d2 differs from ref_d2 by at least the ratio, either way.
+bool SpacingChanged(int64_t d2, int64_t ref_d2, int64_t ratio_q8)
+{
+    return d2 * 256 >= ref_d2 * ratio_q8 || d2 * ratio_q8 <= ref_d2 * 256;
 }
 
+// Default swipe bindings, [fingers - 3][Up, Down, Left, Right]. Three fingers
+// navigate (app switcher, home, back, forward); four control media.
+constexpr SwipeAction kDefaultSwipeActions[2][kSwipeDirections] = {
+    {Consumer(hid::android::kRecents), Consumer(hid::android::kHome),
+     Consumer(hid::android::kBack), Consumer(hid::android::kForward)},
+    {Consumer(hid::media::kPlayPause), Consumer(hid::media::kMute),
+     Consumer(hid::media::kPrevTrack), Consumer(hid::media::kNextTrack)},
+};
+
+}  // namespace
+
 TouchpadHandler::TouchpadHandler(UsbHidDevice &hid, int min_travel, int x_multiplier,
-                                 int y_multiplier)
+                                 int y_multiplier, PointerAccelProfile accel, PinchMode pinch,
+                                 TapMode tap)
     : InputHandler(hid),
       min_travel_(min_travel),
       x_multiplier_(x_multiplier),
-      y_multiplier_(y_multiplier)
-{}
+      y_multiplier_(y_multiplier),
+      accel_(accel),
+      pinch_mode_(pinch),
+      tap_(tap)
+{
+    TapParams taps;
+    taps.tap_max_us   = config::kTapMaxDurationMs * 1000;
+    taps.window_us    = config::kDoubleTapWindowMs * 1000;
+    taps.hold_us      = config::kTapHoldDelayMs * 1000;
+    taps.max_movement = config::kTapMaxMovement;
+    tap_.SetParams(taps);
+
+    KineticScrollParams params;
+    params.min_start_q8 = static_cast<int32_t>(config::kKineticMinStartSpeed) << 8;
+    params.stop_q8      = static_cast<int32_t>(config::kKineticStopSpeed) << 8;
+    params.max_q8       = static_cast<int32_t>(config::kKineticMaxSpeed) << 8;
+    params.decay_us     = config::kKineticDecayMs * 1000;
+    kinetic_.SetParams(params);
+    kinetic_enabled_ = config::kKineticScroll;
+    pan_enabled_     = config::kTwoFingerPan;
+
+    SwipeParams swipe;
+    swipe.min_distance = config::kSwipeMinDistance;
+    swipe.axis_ratio   = config::kSwipeAxisRatio;
+    swipe.max_duration = config::kSwipeMaxDurationMs;
+    swipe_.SetParams(swipe);
+    swipes_enabled_ = config::kSwipeGestures;
+    for (size_t f = 0; f < 2; ++f) {
+        for (size_t d = 0; d < kSwipeDirections; ++d) {
+            swipe_actions_[f][d] = kDefaultSwipeActions[f][d];
+        }
+    }
+}
+
+void TouchpadHandler::ResetRemainders()
+{
+    pointer_x_.Reset();
+    pointer_y_.Reset();
+    scroll_.Reset();
+    pan_.Reset();
+    hid_.DropScrollFraction();
+}
 
-uint32_t TouchpadHandler::GetMillis() const
+void TouchpadHandler::SetKineticEnabled(bool enabled)
 {
-    return xTaskGetTickCount() * portTICK_PERIOD_MS;
+    kinetic_enabled_ = enabled;
+    if (!enabled) {
+        kinetic_.Stop();
+    }
 }
 
-void TouchpadHandler::HandleFingerDown(const InputEvent &event)
+void TouchpadHandler::StartFling(uint64_t lift_us)
 {
-    uint32_t now = GetMillis();
+    // Only vertical scrolls fling, and not if the fingers came to rest before
+    // lifting.
+    if (!kinetic_enabled_ || two_finger_mode_ != TwoFingerMode::Scroll ||
+        scroll_axis_ != ScrollAxis::Vertical ||
+        lift_us - scroll_velocity_.LastUs() > config::kKineticLiftWindowMs * 1000) {
+        return;
+    }
 
-    // Record touch start
-    touch_start_time_ = now;
-    touch_start_x_    = event.x;
-    touch_start_y_    = event.y;
-    touch_moved_      = false;
+    int32_t velocity = scroll_velocity_.Velocity();
+    if (kinetic_.Start(velocity, lift_us)) {
+        ESP_LOGD(kTag, "Kinetic scroll: %ld/256 detents/s", static_cast<long>(velocity));
+    }
+}
 
-    // Check if this is the second tap in a double-tap sequence
-    if (tap_state_ == TapState::WaitingForSecondTap) {
-        if (now - last_tap_time_ < config::kDoubleTapWindowMs) {
-            // Second tap detected - enter drag mode
-            tap_state_ = TapState::Dragging;
-            hid_.MouseButtonPress(hid::mouse::kButtonLeft);
-            ESP_LOGI(kTag, "Tap-drag started (tap-tap-hold)");
-        } else {
-            // Too slow - reset to idle
-            tap_state_ = TapState::Idle;
-        }
+void TouchpadHandler::TickKinetic(uint64_t now_us)
+{
+    int32_t units = kinetic_.Tick(now_us);
+    if (units != 0) {
+        hid_.MouseScrollHiRes(units);
     }
 }
 
-void TouchpadHandler::HandleFingerUp(const InputEvent &event)
+void TouchpadHandler::SetPanEnabled(bool enabled)
 {
-    uint32_t now            = GetMillis();
-    uint32_t touch_duration = now - touch_start_time_;
+    pan_enabled_ = enabled;
+    pan_.Reset();
+    if (!enabled && scroll_axis_ == ScrollAxis::Horizontal) {
+        scroll_axis_ = ScrollAxis::Vertical;
+    }
+}
 
-    // Handle drag release
-    if (tap_state_ == TapState::Dragging) {
-        hid_.MouseButtonRelease(hid::mouse::kButtonLeft);
-        tap_state_ = TapState::Idle;
-        ESP_LOGI(kTag, "Tap-drag ended");
+void TouchpadHandler::LockScrollAxis()
+{
+    int32_t ax = std::abs(travel_x_);
+    int32_t ay = std::abs(travel_y_);
+    if (ax < config::kScrollAxisLockTravel && ay < config::kScrollAxisLockTravel) {
         return;
     }
 
-    // Check if this was a valid tap (short duration, minimal movement)
-    bool is_tap = (touch_duration < config::kTapMaxDurationMs) && !touch_moved_;
+    // The other axis is dropped until lift, so a vertical scroll does not
+    // wander sideways through a list and a pan does not scroll the page.
+    if (ax > ay) {
+        scroll_axis_ = ScrollAxis::Horizontal;
+        scroll_.Reset();
+    } else {
+        scroll_axis_ = ScrollAxis::Vertical;
+        pan_.Reset();
+    }
+    ESP_LOGD(kTag, "Two-finger %s", ax > ay ? "pan" : "scroll");
+}
 
-    if (is_tap) {
-        if (tap_state_ == TapState::Idle) {
-            // First tap - wait for possible second tap
-            tap_state_     = TapState::WaitingForSecondTap;
-            last_tap_time_ = now;
-            ESP_LOGD(kTag, "Single tap detected, waiting for second tap...");
+void TouchpadHandler::SetPinchMode(PinchMode mode)
+{
+    EndPinch();
+    pinch_mode_ = mode;
+}
 
-            // Send click immediately (responsive feel)
-            // If user does tap-tap-hold, they'll get click + drag
-            hid_.MouseClick(hid::mouse::kButtonLeft);
-            ESP_LOGI(kTag, "Tap -> Left Click");
-        } else if (tap_state_ == TapState::WaitingForSecondTap) {
-            // This shouldn't happen (finger down would have caught it)
-            tap_state_ = TapState::Idle;
+void TouchpadHandler::EndPinch()
+{
+    if (two_finger_mode_ == TwoFingerMode::Pinch && pinch_mode_ == PinchMode::CtrlWheel) {
+        hid_.ModifierRelease(hid::key::kModLeftCtrl);
+    }
+    two_finger_mode_ = TwoFingerMode::Undecided;
+}
+
+bool TouchpadHandler::HandlePinch(const InputEvent &event)
+{
+    int64_t d2 = SpacingSquared(event);
+
+    // Hysteresis: an undecided contact turns into a pinch at a small spacing
+    // change, a scroll only at a much larger one.
+    if ((two_finger_mode_ == TwoFingerMode::Undecided &&
+         SpacingChanged(d2, pinch_ref_d2_, kPinchEnterQ8)) ||
+        (two_finger_mode_ == TwoFingerMode::Scroll &&
+         SpacingChanged(d2, pinch_ref_d2_, kPinchBreakoutQ8))) {
+        two_finger_mode_ = TwoFingerMode::Pinch;
+        scroll_.Reset();
+        pan_.Reset();
+        hid_.DropScrollFraction();
+        pinch_stats_.pinches++;
+        if (pinch_mode_ == PinchMode::CtrlWheel) {
+            hid_.ModifierPress(hid::key::kModLeftCtrl);
         }
+        ESP_LOGD(kTag, "Pinch started");
+    }
+    if (two_finger_mode_ != TwoFingerMode::Pinch) {
+        return false;
+    }
+
+    // One zoom step per kPinchStepPercent change in spacing since the last.
+    int steps = 0;
+    while (steps < kMaxZoomSteps && d2 * 256 >= pinch_ref_d2_ * kPinchStepQ8) {
+        pinch_ref_d2_ = pinch_ref_d2_ * kPinchStepQ8 / 256;
+        steps++;
+    }
+    while (steps > -kMaxZoomSteps && d2 * kPinchStepQ8 <= pinch_ref_d2_ * 256) {
+        pinch_ref_d2_ = pinch_ref_d2_ * 256 / kPinchStepQ8;
+        steps--;
+    }
+    if (steps == 0) {
+        return true;
+    }
+
+    pinch_stats_.steps += static_cast<uint32_t>(std::abs(steps));
+    ESP_LOGD(kTag, "Zoom %s x%d", steps > 0 ? "in" : "out", std::abs(steps));
+    if (pinch_mode_ == PinchMode::CtrlWheel) {
+        // One detent per zoom step, with or without the resolution multiplier.
+        hid_.MouseScrollHiRes(steps * kWheelUnitsPerDetent);
     } else {
-        // Not a tap - reset state
-        if (tap_state_ == TapState::WaitingForSecondTap) {
-            // Timeout will handle this, or next touch
+        uint16_t usage = steps > 0 ? hid::android::kZoomIn : hid::android::kZoomOut;
+        for (int i = 0; i < std::abs(steps); ++i) {
+            hid_.MediaKeyPressAndRelease(usage);
         }
-        // Don't reset if dragging was handled above
+    }
+    return true;
+}
+
+void TouchpadHandler::SetSwipesEnabled(bool enabled)
+{
+    swipes_enabled_ = enabled;
+    swipe_.Reset();
+    swipe_contact_ = false;
+}
+
+void TouchpadHandler::SetSwipeAction(uint8_t fingers, SwipeDirection direction,
+                                     SwipeAction action)
+{
+    if (fingers == 3 || fingers == 4) {
+        swipe_actions_[fingers - 3][static_cast<size_t>(direction)] = action;
     }
 }
 
+SwipeAction TouchpadHandler::GetSwipeAction(uint8_t fingers, SwipeDirection direction) const
+{
+    if (fingers != 3 && fingers != 4) {
+        return {};
+    }
+    return swipe_actions_[fingers - 3][static_cast<size_t>(direction)];
+}
+
+bool TouchpadHandler::HandleSwipe(const InputEvent &event)
+{
+    SwipeResult swipe = swipe_.Feed(event);
+
+    if (swipe.fired) {
+        SwipeAction action = GetSwipeAction(swipe.fingers, swipe.direction);
+        ESP_LOGI(kTag, "Swipe: %u fingers %s", swipe.fingers,
+                 SwipeDirectionName(swipe.direction));
+        if (action.kind == SwipeAction::Kind::Key) {
+            hid_.KeyPressAndRelease(static_cast<uint8_t>(action.code));
+        } else if (action.kind == SwipeAction::Kind::Consumer) {
+            hid_.MediaKeyPressAndRelease(action.code);
+        }
+    }
+
+    if (swipe_.InGesture() && !swipe_contact_) {
+        // Whatever one or two fingers were doing is over.
+        ApplyTap(tap_.Cancel(event.timestamp_us));
+        EndPinch();
+        tracking_             = false;
+        tracking_two_fingers_ = false;
+        same_contact_         = false;
+        swipe_contact_        = true;
+        kinetic_.Stop();
+        ResetRemainders();
+        ESP_LOGD(kTag, "Swipe contact started");
+    }
+
+    if (!swipe_contact_) {
+        return false;
+    }
+
+    // Fingers left behind as a swipe lifts must not move the pointer, scroll
+    // or tap; the contact ends only when the pad is clear.
+    if (event.state == protocol::kTouchFingerRemoved) {
+        swipe_contact_ = false;
+    }
+    return true;
+}
+
+void TouchpadHandler::ApplyTap(TapAction action)
+{
+    switch (action) {
+        case TapAction::None:
+            break;
+        case TapAction::Click:
+            hid_.MouseClick(hid::mouse::kButtonLeft);
+            ESP_LOGI(kTag, "Tap -> Left Click");
+            break;
+        case TapAction::DoubleClick:
+            // The tap engine releases the first click before pressing again.
+            hid_.MouseClick(hid::mouse::kButtonLeft);
+            hid_.MouseClick(hid::mouse::kButtonLeft);
+            ESP_LOGI(kTag, "Tap-tap -> Double Click");
+            break;
+        case TapAction::DragStart:
+            hid_.MouseButtonPress(hid::mouse::kButtonLeft);
+            ESP_LOGI(kTag, "Tap-drag started (tap-tap-hold)");
+            break;
+        case TapAction::DragEnd:
+            hid_.MouseButtonRelease(hid::mouse::kButtonLeft);
+            ESP_LOGI(kTag, "Tap-drag ended");
+            break;
+    }
+}
+
+void TouchpadHandler::TickTaps(uint64_t now_us)
+{
+    ApplyTap(tap_.Tick(now_us));
+}
+
 bool TouchpadHandler::Handle(const InputEvent &event)
 {
     if (event.type != InputEvent::Type::Touchpad) {
         return false;
     }
 
+    // =========================================================================
+    // Three/four-finger swipes
+    // =========================================================================
+    if (swipes_enabled_ && HandleSwipe(event)) {
+        return true;
+    }
+
     // =========================================================================
     // Finger removed
     // =========================================================================
     if (event.state == protocol::kTouchFingerRemoved) {
         // Handle single-finger tap detection on finger up
         if (tracking_ && !tracking_two_fingers_) {
-            HandleFingerUp(event);
+            ApplyTap(tap_.TouchUp(event.timestamp_us));
+        }
+        if (tracking_two_fingers_) {
+            StartFling(event.timestamp_us);
+            EndPinch();
         }
 
         tracking_             = false;
         tracking_two_fingers_ = false;
+        same_contact_         = false;
+        ResetRemainders();
         ESP_LOGD(kTag, "Finger(s) removed");
         return true;
     }
 
     // =========================================================================
-    // Two-finger gesture (scroll only)
+    // Two-finger gesture (scroll or pinch)
     // =========================================================================
     if (event.two_fingers) {
         if (!tracking_two_fingers_) {
@@ -129,29 +377,91 @@ bool TouchpadHandler::Handle(const InputEvent &event)
             prev_y2_              = event.y2;
             tracking_two_fingers_ = true;
             tracking_             = false;
-            ESP_LOGD(kTag, "Two-finger scroll started");
+            ResetRemainders();
+
+            // A second finger is not a tap (or the end of a tap-drag).
+            ApplyTap(tap_.Cancel(event.timestamp_us));
+
+            // Touching the pad again catches a running fling.
+            kinetic_.Stop();
+            scroll_velocity_.Reset();
+            scroll_position_ = 0;
+            scroll_velocity_.Add(scroll_position_, event.timestamp_us);
+
+            // Without pinch, two fingers always scroll.
+            two_finger_mode_ =
+                pinch_mode_ == PinchMode::Off ? TwoFingerMode::Scroll : TwoFingerMode::Undecided;
+            pinch_ref_d2_ = SpacingSquared(event);
+
+            // Without pan there is no axis to pick.
+            scroll_axis_ = pan_enabled_ ? ScrollAxis::Free : ScrollAxis::Vertical;
+            travel_x_    = 0;
+            travel_y_    = 0;
+            ESP_LOGD(kTag, "Two-finger gesture started");
+            return true;
+        }
+
+        if (pinch_mode_ != PinchMode::Off && HandlePinch(event)) {
+            prev_x_  = event.x;
+            prev_y_  = event.y;
+            prev_x2_ = event.x2;
+            prev_y2_ = event.y2;
             return true;
         }
 
-        // Two-finger scroll (average Y movement of both fingers)
-        int16_t delta_y1    = event.y - prev_y_;
-        int16_t delta_y2    = event.y2 - prev_y2_;
-        int16_t avg_delta_y = (delta_y1 + delta_y2) / 2;
+        // Two-finger scroll and pan (average movement of both fingers). Below
+        // the travel threshold an axis is not consumed, so slow motion builds up.
+        int16_t avg_delta_x = ((event.x - prev_x_) + (event.x2 - prev_x2_)) / 2;
+        int16_t avg_delta_y = ((event.y - prev_y_) + (event.y2 - prev_y2_)) / 2;
 
         if (std::abs(avg_delta_y) >= min_travel_) {
-            int8_t scroll = utils::Constrain(avg_delta_y * config::kScrollMultiplier / 10, -127, 127);
+            int32_t scaled =
+                avg_delta_y * config::kScrollMultiplier * SubpixelAccumulator::kOne / 10;
+            scroll_.Add(scaled * kWheelUnitsPerDetent);
+            scroll_position_ += scaled;
+            travel_y_ += avg_delta_y;
+            prev_y_  = event.y;
+            prev_y2_ = event.y2;
+        }
+        if (std::abs(avg_delta_x) >= min_travel_) {
+            pan_.Add(avg_delta_x * config::kPanMultiplier * SubpixelAccumulator::kOne *
+                     kWheelUnitsPerDetent / 10);
+            travel_x_ += avg_delta_x;
+            prev_x_  = event.x;
+            prev_x2_ = event.x2;
+        }
 
+        if (scroll_axis_ == ScrollAxis::Free) {
+            LockScrollAxis();
+        }
+
+        // Until the contact is known not to be a pinch, output is held back in
+        // the accumulators (it goes out once the lock travel is reached).
+        if (two_finger_mode_ == TwoFingerMode::Undecided &&
+            (std::abs(travel_x_) >= config::kPinchScrollLock ||
+             std::abs(travel_y_) >= config::kPinchScrollLock)) {
+            two_finger_mode_ = TwoFingerMode::Scroll;
+        }
+
+        if (two_finger_mode_ == TwoFingerMode::Scroll && scroll_axis_ == ScrollAxis::Vertical) {
+            int32_t scroll = scroll_.Take(kMouseReportMax);
             if (scroll != 0) {
-                ESP_LOGD(kTag, "Scroll: %d", scroll);
-                hid_.MouseScroll(scroll);
+                ESP_LOGD(kTag, "Scroll: %ld/%ld", static_cast<long>(scroll),
+                         static_cast<long>(kWheelUnitsPerDetent));
+                hid_.MouseScrollHiRes(scroll);
+            }
+        } else if (two_finger_mode_ == TwoFingerMode::Scroll &&
+                   scroll_axis_ == ScrollAxis::Horizontal) {
+            int32_t pan = pan_.Take(kMouseReportMax);
+            if (pan != 0) {
+                ESP_LOGD(kTag, "Pan: %ld/%ld", static_cast<long>(pan),
+                         static_cast<long>(kWheelUnitsPerDetent));
+                hid_.MousePanHiRes(pan);
             }
-
-            prev_y_  = event.y;
-            prev_y2_ = event.y2;
         }
 
-        prev_x_  = event.x;
-        prev_x2_ = event.x2;
+        // Every sample counts, so fingers coming to rest pull the speed down.
+        scroll_velocity_.Add(scroll_position_, event.timestamp_us);
         return true;
     }
 
@@ -161,18 +471,30 @@ bool TouchpadHandler::Handle(const InputEvent &event)
     if (tracking_two_fingers_) {
         tracking_two_fingers_ = false;
         tracking_             = false;
-        ESP_LOGD(kTag, "Two-finger scroll ended");
+        same_contact_         = true;
+        StartFling(event.timestamp_us);
+        EndPinch();
+        ESP_LOGD(kTag, "Two-finger gesture ended");
     }
 
     // =========================================================================
     // Single finger - first touch
     // =========================================================================
     if (!tracking_) {
-        prev_x_   = event.x;
-        prev_y_   = event.y;
-        tracking_ = true;
+        prev_x_       = event.x;
+        prev_y_       = event.y;
+        prev_move_us_ = event.timestamp_us;
+        tracking_     = true;
+        ResetRemainders();
+
+        // A new touch stops a fling; the finger left behind when one of two
+        // lifts is the same contact and does not.
+        if (!same_contact_) {
+            kinetic_.Stop();
+        }
+        same_contact_ = false;
 
-        HandleFingerDown(event);
+        ApplyTap(tap_.TouchDown(event.x, event.y, event.timestamp_us));
         ESP_LOGD(kTag, "Touchpad: touch started at x=%d, y=%d", event.x, event.y);
         return true;
     }
@@ -183,37 +505,37 @@ bool TouchpadHandler::Handle(const InputEvent &event)
     int16_t delta_x = event.x - prev_x_;
     int16_t delta_y = event.y - prev_y_;
 
-    // Check if finger moved significantly (for tap detection)
-    int16_t total_move_x = std::abs(event.x - touch_start_x_);
-    int16_t total_move_y = std::abs(event.y - touch_start_y_);
-    if (total_move_x > config::kTapMaxMovement || total_move_y > config::kTapMaxMovement) {
-        touch_moved_ = true;
+    // Moving far enough rules out a tap; on a second touch it starts a drag,
+    // pressed before the motion goes out.
+    ApplyTap(tap_.Move(event.x, event.y, event.timestamp_us));
 
-        // If we were waiting for second tap and user moved, cancel it
-        if (tap_state_ == TapState::WaitingForSecondTap) {
-            tap_state_ = TapState::Idle;
-        }
-    }
-
-    // Apply threshold to avoid jitter
-    if (std::abs(delta_x) < min_travel_) {
-        delta_x = 0;
-    }
-    if (std::abs(delta_y) < min_travel_) {
-        delta_y = 0;
+    // Ignore jitter below the travel threshold. The position is not consumed,
+    // so slow motion builds up until it crosses the threshold.
+    if (std::abs(delta_x) < min_travel_ && std::abs(delta_y) < min_travel_) {
+        return true;
     }
 
-    if (delta_x != 0 || delta_y != 0) {
-        // Scale movement for better feel
-        int8_t mouse_x = utils::Constrain(delta_x * x_multiplier_ / 10, -127, 127);
-        // Y-axis inverted (touchpad Y increases upward, screen Y increases downward)
-        int8_t mouse_y = utils::Constrain(-delta_y * y_multiplier_ / 10, -127, 127);
-
-        ESP_LOGD(kTag, "Touchpad move: x=%d, y=%d", mouse_x, mouse_y);
+    // Scale movement by the base multiplier and the acceleration gain for
+    // the finger speed since the last applied sample, in Q8 pixels.
+    uint32_t dt_us = static_cast<uint32_t>(event.timestamp_us - prev_move_us_);
+    int32_t  gain  = accel_.Gain(delta_x, delta_y, dt_us);
+
+    pointer_x_.Add(delta_x * x_multiplier_ * gain / 10);
+    // Y-axis inverted (touchpad Y increases upward, screen Y increases downward)
+    pointer_y_.Add(-delta_y * y_multiplier_ * gain / 10);
+
+    prev_x_       = event.x;
+    prev_y_       = event.y;
+    prev_move_us_ = event.timestamp_us;
+
+    // Whole pixels go out in one call, however fast the swipe; the fractions
+    // carry over to the next sample.
+    int16_t mouse_x = static_cast<int16_t>(pointer_x_.Take(kMouseReportMax));
+    int16_t mouse_y = static_cast<int16_t>(pointer_y_.Take(kMouseReportMax));
+    if (mouse_x != 0 || mouse_y != 0) {
+        ESP_LOGD(kTag, "Touchpad move: x=%d, y=%d (gain %ld/256)", mouse_x, mouse_y,
+                 static_cast<long>(gain));
         hid_.MouseMove(mouse_x, mouse_y);
-
-        prev_x_ = event.x;
-        prev_y_ = event.y;
     }
 
     return true;
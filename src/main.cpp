@@ -12,9 +12,13 @@
 #include "can/can_bus.h"
 #include "can/can_task.h"
 #include "config/config.h"
+#include "hid/tinyusb_hid_port.h"
 #include "hid/usb_hid_device.h"
 #include "idrive/idrive_controller.h"
 #include "ota/ota_manager.h"
+#include "sched/periodic_scheduler.h"
+#include "sched/scheduler_task.h"
+#include "utils/utils.h"
 
 namespace {
 const char *kTag = "MAIN";
@@ -32,30 +36,44 @@ extern "C" void app_main()
     // Create OTA manager (before other initializations).
     idrive::ota::OtaManager ota_manager;
 
+    // The CAN bus (RX ring), scheduler and controller (dispatch table) are
+    // too large for the 3.5 KB main task stack, so they live in static storage.
+
     // Create CAN bus instance.
-    idrive::CanBus can(GPIO_NUM_4, GPIO_NUM_5);
+    static idrive::CanBus can(GPIO_NUM_4, GPIO_NUM_5);
 
     // Create event-driven CAN task.
-    idrive::CanTask can_task(can);
+    static idrive::CanTask can_task(can);
+
+    // Periodic CAN TX scheduler (poll, light keepalive, init retries).
+    static idrive::PeriodicScheduler scheduler;
+    static idrive::SchedulerTask     scheduler_task(scheduler);
 
-    // Get USB HID device instance.
-    idrive::UsbHidDevice &hid = idrive::GetUsbHidDevice();
+    // Get USB HID device instance and its TinyUSB port.
+    idrive::UsbHidDevice         &hid = idrive::GetUsbHidDevice();
+    static idrive::TinyUsbHidPort usb_port;
 
     // Configuration.
     idrive::Config config {
-        .joystick_as_mouse  = false,  // Arrow keys mode (volume/tracks on steering wheel)
-        .light_brightness   = 255,
-        .poll_interval_ms   = idrive::config::kPollIntervalMs,
-        .light_keepalive_ms = idrive::config::kLightKeepaliveMs,
-        .min_mouse_travel   = idrive::config::kMinMouseTravel,
-        .joystick_move_step = idrive::config::kJoystickMoveStep,
+        .joystick_as_mouse        = false,  // Arrow keys mode (volume/tracks on steering wheel)
+        .light_brightness         = 255,
+        .poll_interval_ms         = idrive::config::kPollIntervalMs,
+        .light_keepalive_ms       = idrive::config::kLightKeepaliveMs,
+        .min_mouse_travel         = idrive::config::kMinMouseTravel,
+        .joystick_move_step       = idrive::config::kJoystickMoveStep,
+        .joystick_repeat_delay_ms = idrive::config::kJoystickRepeatDelayMs,
+        .joystick_repeat_rate_hz  = idrive::config::kJoystickRepeatRateHz,
+        .pointer_accel            = idrive::PointerAccelProfile::MacOs,
+        .rotary_accel             = idrive::RotaryAccelProfile::Moderate,
+        .pinch_mode               = idrive::PinchMode::CtrlWheel,
+        .tap_mode                 = idrive::TapMode::Deferred,
     };
 
     // Create iDrive controller.
-    idrive::IDriveController controller(can, hid, config);
+    static idrive::IDriveController controller(can, hid, scheduler, config);
 
     // Initialize USB HID device.
-    if (!hid.Init()) {
+    if (!usb_port.Init(hid)) {
         ESP_LOGE(kTag, "Failed to initialize USB HID device");
         return;
     }
@@ -64,7 +82,8 @@ extern "C" void app_main()
     // Allow USB enumeration to complete.
     vTaskDelay(pdMS_TO_TICKS(1000));
 
-    // Initialize CAN bus.
+    // Initialize CAN bus, filtering down to the IDs the controller consumes.
+    can.SetAcceptedIds(controller.GetRxIds());
     if (!can.Init(idrive::config::kCanBaudrate)) {
         ESP_LOGE(kTag, "Failed to initialize CAN bus");
         return;
@@ -83,12 +102,21 @@ extern "C" void app_main()
     // Initialize iDrive controller.
     controller.Init();
 
+    // Start deadline-driven periodic TX (controller registered its jobs above).
+    if (!scheduler_task.Start()) {
+        ESP_LOGE(kTag, "Failed to start scheduler task");
+        return;
+    }
+
     // Initialize OTA manager and connect trigger to controller.
     ota_manager.Init();
     controller.SetOtaTrigger(&ota_manager.GetTrigger());
 
     ESP_LOGI(kTag, "Entering main loop...");
-    ESP_LOGI(kTag, "Task distribution: USB on Core 0, CAN on Core 1");
+    ESP_LOGI(kTag, "Task distribution: USB on Core 0, CAN and scheduler on Core 1");
+
+    uint32_t last_stats_time   = idrive::utils::GetMillis();
+    size_t   trace_dump_offset = 0;
 
     // Main loop - CAN processing is now handled by dedicated task.
     while (true) {
@@ -102,15 +130,130 @@ extern "C" void app_main()
             continue;
         }
 
-        // CAN processing is now event-driven in CAN task (Core 1).
-        // Main loop only handles periodic controller updates.
+        // CAN processing is now event-driven in CAN task (Core 1) and
+        // periodic CAN TX runs in the scheduler task.
+        // Main loop only handles the controller state machine.
 
-        // Update controller state (handles timing, polling commands, etc.).
+        // Update controller state (detection, cooldown, readiness).
         controller.Update();
 
         // Update OTA trigger detection.
         ota_manager.Update();
 
+        // Periodic TX timing and RX queue report.
+        if (idrive::config::kDebugStats &&
+            idrive::utils::GetMillis() - last_stats_time >= idrive::config::kStatsIntervalMs) {
+            last_stats_time = idrive::utils::GetMillis();
+            scheduler_task.LogStats();
+
+            idrive::CanRxStats rx = can.GetRxStats();
+            ESP_LOGI(kTag,
+                     "CAN RX ring: received=%lu filtered=%lu overruns=%lu high-water=%lu/%lu",
+                     static_cast<unsigned long>(rx.received),
+                     static_cast<unsigned long>(rx.filtered),
+                     static_cast<unsigned long>(rx.overruns),
+                     static_cast<unsigned long>(rx.high_water),
+                     static_cast<unsigned long>(rx.capacity));
+
+            idrive::TimedReleaseStats taps = hid.GetReleaseStats();
+            ESP_LOGI(kTag,
+                     "HID taps: queued=%lu fired=%lu late=%lu (max %lu us) preempted=%lu "
+                     "overflows=%lu",
+                     static_cast<unsigned long>(taps.scheduled),
+                     static_cast<unsigned long>(taps.fired), static_cast<unsigned long>(taps.late),
+                     static_cast<unsigned long>(taps.max_late_us),
+                     static_cast<unsigned long>(taps.preempted),
+                     static_cast<unsigned long>(taps.overflows));
+
+            idrive::HidReportStats reports = hid.GetReportStats();
+            ESP_LOGI(kTag,
+                     "HID reports: sent=%lu coalesced=%lu dropped=%lu rejected=%lu saturated=%lu "
+                     "stalls=%lu",
+                     static_cast<unsigned long>(reports.sent),
+                     static_cast<unsigned long>(reports.coalesced),
+                     static_cast<unsigned long>(reports.dropped),
+                     static_cast<unsigned long>(reports.rejected),
+                     static_cast<unsigned long>(reports.saturated),
+                     static_cast<unsigned long>(reports.stalls));
+
+            hid.LogLatency(kTag);
+            if (idrive::config::kDebugLatencyCsv) {
+                hid.ExportLatencyCsv();
+            }
+
+            idrive::CanTraceStats trace = can.GetTrace().GetStats();
+            ESP_LOGI(kTag, "CAN trace: recorded=%lu overwritten=%lu held=%lu (%lu/%lu bytes)",
+                     static_cast<unsigned long>(trace.recorded),
+                     static_cast<unsigned long>(trace.overwritten),
+                     static_cast<unsigned long>(trace.records),
+                     static_cast<unsigned long>(trace.bytes),
+                     static_cast<unsigned long>(trace.capacity));
+
+            if (idrive::JoystickHandler *joystick = controller.GetJoystickHandler()) {
+                idrive::StickRepeatStats hold = joystick->GetRepeatStats();
+                ESP_LOGI(kTag, "Joystick: holds=%lu repeats=%lu skipped=%lu",
+                         static_cast<unsigned long>(hold.holds),
+                         static_cast<unsigned long>(hold.repeats),
+                         static_cast<unsigned long>(hold.skipped));
+            }
+
+            idrive::CoalesceStats rotary = controller.GetRotaryCoalesceStats();
+            ESP_LOGI(kTag, "Rotary: events=%lu dispatched=%lu saved=%lu",
+                     static_cast<unsigned long>(rotary.events),
+                     static_cast<unsigned long>(rotary.dispatched),
+                     static_cast<unsigned long>(rotary.events - rotary.dispatched));
+
+            // Filter state is only written from the CAN task; a torn read here
+            // just skews one debug line.
+            if (const idrive::TouchFilter *filter = controller.GetTouchFilter()) {
+                const idrive::utils::LatencyHistogram &lag = filter->AddedLatency();
+                ESP_LOGI(kTag, "Touch filter (%s): samples=%lu lag p50=%lu p99=%lu max=%lu us",
+                         filter->Name(), static_cast<unsigned long>(lag.Count()),
+                         static_cast<unsigned long>(lag.PercentileUs(50)),
+                         static_cast<unsigned long>(lag.PercentileUs(99)),
+                         static_cast<unsigned long>(lag.MaxUs()));
+            }
+
+            if (const idrive::TouchpadHandler *touchpad = controller.GetTouchpadHandler()) {
+                idrive::KineticScrollStats kinetic = touchpad->GetKinetic().GetStats();
+                ESP_LOGI(kTag, "Kinetic scroll: flings=%lu cancelled=%lu detents=%lu",
+                         static_cast<unsigned long>(kinetic.flings),
+                         static_cast<unsigned long>(kinetic.cancelled),
+                         static_cast<unsigned long>(kinetic.units / idrive::kWheelUnitsPerDetent));
+
+                const idrive::TouchpadHandler::PinchStats &pinch = touchpad->GetPinchStats();
+                ESP_LOGI(kTag, "Pinch: pinches=%lu zoom steps=%lu",
+                         static_cast<unsigned long>(pinch.pinches),
+                         static_cast<unsigned long>(pinch.steps));
+
+                const idrive::TapResolver      &taps  = touchpad->GetTapResolver();
+                idrive::TapStats                tap   = taps.GetStats();
+                idrive::utils::LatencyHistogram delay = taps.ClickLatency();
+                ESP_LOGI(kTag,
+                         "Taps (%s): clicks=%lu double=%lu drags=%lu click delay p50=%lu "
+                         "max=%lu us",
+                         taps.Mode() == idrive::TapMode::Deferred ? "deferred" : "fast",
+                         static_cast<unsigned long>(tap.clicks),
+                         static_cast<unsigned long>(tap.double_clicks),
+                         static_cast<unsigned long>(tap.drags),
+                         static_cast<unsigned long>(delay.PercentileUs(50)),
+                         static_cast<unsigned long>(delay.MaxUs()));
+            }
+        }
+
+        // Print the CAN trace once it has frozen, a chunk per pass so the
+        // watchdog is still fed while a slow console drains. Then clear it
+        // so recording resumes and the next alert gets a trace of its own.
+        if (idrive::config::kCanTrace && can.GetTrace().IsFrozen(idrive::utils::GetMicros())) {
+            idrive::CanTrace &trace = can.GetTrace();
+
+            trace_dump_offset = trace.Dump(trace_dump_offset, idrive::config::kCanTraceDumpChunk);
+            if (trace_dump_offset >= trace.GetStats().bytes) {
+                trace.Clear();
+                trace_dump_offset = 0;
+            }
+        }
+
         // Yield to other tasks - can be slower now since CAN is event-driven.
         vTaskDelay(pdMS_TO_TICKS(50));
     }
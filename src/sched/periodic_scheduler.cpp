@@ -0,0 +1,120 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+
+#include "sched/periodic_scheduler.h"
+
+namespace idrive {
+
+PeriodicScheduler::JobId PeriodicScheduler::Add(const char *name, uint32_t period_us,
+                                                Callback callback, uint64_t now_us)
+{
+    if (job_count_ >= kMaxJobs || period_us == 0 || !callback) {
+        return kInvalidJob;
+    }
+
+    Job &job      = jobs_[job_count_];
+    job.name      = name;
+    job.period_us = period_us;
+    job.deadline  = now_us + period_us;
+    job.last_run  = 0;
+    job.callback  = std::move(callback);
+    job.stats     = PeriodicStats {};
+
+    return static_cast<JobId>(job_count_++);
+}
+
+void PeriodicScheduler::SetPeriod(JobId id, uint32_t period_us, uint64_t now_us)
+{
+    if (id >= job_count_ || period_us == 0) {
+        return;
+    }
+    jobs_[id].period_us = period_us;
+    jobs_[id].deadline  = now_us + period_us;
+}
+
+uint64_t PeriodicScheduler::RunDue(uint64_t now_us)
+{
+    for (size_t i = 0; i < job_count_; ++i) {
+        Job &job = jobs_[i];
+        if (now_us < job.deadline) {
+            continue;
+        }
+
+        RecordRun(job, now_us);
+        job.callback();
+
+        // Advance by whole periods so the job stays phase-locked to its
+        // original schedule instead of drifting by its own lateness.
+        job.deadline += job.period_us;
+        if (job.deadline <= now_us) {
+            uint64_t behind = (now_us - job.deadline) / job.period_us + 1;
+            job.stats.missed += static_cast<uint32_t>(behind);
+            job.deadline += behind * job.period_us;
+        }
+    }
+
+    return NextDeadline();
+}
+
+uint64_t PeriodicScheduler::NextDeadline() const
+{
+    uint64_t next = kNever;
+    for (size_t i = 0; i < job_count_; ++i) {
+        if (jobs_[i].deadline < next) {
+            next = jobs_[i].deadline;
+        }
+    }
+    return next;
+}
+
+const char *PeriodicScheduler::GetName(JobId id) const
+{
+    return id < job_count_ ? jobs_[id].name : nullptr;
+}
+
+uint32_t PeriodicScheduler::GetPeriod(JobId id) const
+{
+    return id < job_count_ ? jobs_[id].period_us : 0;
+}
+
+const PeriodicStats *PeriodicScheduler::GetStats(JobId id) const
+{
+    return id < job_count_ ? &jobs_[id].stats : nullptr;
+}
+
+void PeriodicScheduler::ResetStats()
+{
+    for (size_t i = 0; i < job_count_; ++i) {
+        jobs_[i].stats    = PeriodicStats {};
+        jobs_[i].last_run = 0;
+    }
+}
+
+void PeriodicScheduler::RecordRun(Job &job, uint64_t now_us)
+{
+    PeriodicStats &stats  = job.stats;
+    uint32_t       jitter = static_cast<uint32_t>(now_us - job.deadline);
+
+    stats.last_jitter_us = jitter;
+    stats.total_jitter_us += jitter;
+    if (jitter > stats.max_jitter_us) {
+        stats.max_jitter_us = jitter;
+    }
+
+    if (stats.runs > 0) {
+        uint32_t period        = static_cast<uint32_t>(now_us - job.last_run);
+        stats.last_period_us   = period;
+        stats.total_period_us += period;
+        if (period < stats.min_period_us) {
+            stats.min_period_us = period;
+        }
+        if (period > stats.max_period_us) {
+            stats.max_period_us = period;
+        }
+    }
+
+    job.last_run = now_us;
+    stats.runs++;
+}
+
+}  // namespace idrive
@@ -0,0 +1,151 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+
+#include "sched/scheduler_task.h"
+
+#include "esp_log.h"
+
+namespace idrive {
+
+namespace {
+const char *kTag = "SCHED";
+}
+
+SchedulerTask::SchedulerTask(PeriodicScheduler &scheduler) : scheduler_(scheduler) {}
+
+SchedulerTask::~SchedulerTask()
+{
+    Stop();
+}
+
+bool SchedulerTask::Start(BaseType_t core_id, UBaseType_t priority)
+{
+    if (task_handle_) {
+        ESP_LOGW(kTag, "Scheduler task already running");
+        return true;
+    }
+
+    if (!timer_) {
+        esp_timer_create_args_t args = {};
+        args.callback                = TimerCallback;
+        args.arg                     = this;
+        args.dispatch_method         = ESP_TIMER_TASK;
+        args.name                    = "sched";
+
+        esp_err_t err = esp_timer_create(&args, &timer_);
+        if (err != ESP_OK) {
+            ESP_LOGE(kTag, "Failed to create timer: %s", esp_err_to_name(err));
+            return false;
+        }
+    }
+
+    running_ = true;
+
+    BaseType_t ret = xTaskCreatePinnedToCore(TaskFunction, "SCHED",
+                                             scheduler_task_config::kStackSize, this, priority,
+                                             &task_handle_, core_id);
+
+    if (ret != pdPASS) {
+        ESP_LOGE(kTag, "Failed to create scheduler task");
+        running_ = false;
+        return false;
+    }
+
+    ESP_LOGI(kTag, "Scheduler task started on core %d, priority %lu, %u jobs",
+             static_cast<int>(core_id), static_cast<unsigned long>(priority),
+             static_cast<unsigned>(scheduler_.JobCount()));
+    return true;
+}
+
+void SchedulerTask::Stop()
+{
+    if (timer_) {
+        esp_timer_stop(timer_);
+    }
+
+    if (task_handle_) {
+        ESP_LOGI(kTag, "Stopping scheduler task");
+        running_ = false;
+
+        // Wake up the task so it can exit.
+        xTaskNotifyGive(task_handle_);
+
+        // Wait for task to finish.
+        vTaskDelay(pdMS_TO_TICKS(200));
+
+        // Delete task if still running.
+        if (task_handle_) {
+            vTaskDelete(task_handle_);
+            task_handle_ = nullptr;
+        }
+    }
+
+    if (timer_) {
+        esp_timer_delete(timer_);
+        timer_ = nullptr;
+    }
+}
+
+void SchedulerTask::LogStats() const
+{
+    for (size_t i = 0; i < scheduler_.JobCount(); ++i) {
+        auto                 id    = static_cast<PeriodicScheduler::JobId>(i);
+        const PeriodicStats *stats = scheduler_.GetStats(id);
+
+        ESP_LOGI(kTag,
+                 "%-10s period %lu us: runs=%lu missed=%lu "
+                 "measured min/mean/max=%lu/%lu/%lu us jitter mean/max=%lu/%lu us",
+                 scheduler_.GetName(id), static_cast<unsigned long>(scheduler_.GetPeriod(id)),
+                 static_cast<unsigned long>(stats->runs), static_cast<unsigned long>(stats->missed),
+                 static_cast<unsigned long>(stats->runs > 1 ? stats->min_period_us : 0),
+                 static_cast<unsigned long>(stats->MeanPeriodUs()),
+                 static_cast<unsigned long>(stats->max_period_us),
+                 static_cast<unsigned long>(stats->MeanJitterUs()),
+                 static_cast<unsigned long>(stats->max_jitter_us));
+    }
+}
+
+void SchedulerTask::TimerCallback(void *arg)
+{
+    auto *self = static_cast<SchedulerTask *>(arg);
+    if (self->task_handle_) {
+        xTaskNotifyGive(self->task_handle_);
+    }
+}
+
+void SchedulerTask::TaskFunction(void *arg)
+{
+    auto *self = static_cast<SchedulerTask *>(arg);
+    self->Run();
+}
+
+void SchedulerTask::Run()
+{
+    ESP_LOGI(kTag, "Scheduler task running on core %d", xPortGetCoreID());
+
+    while (running_) {
+        uint64_t next = scheduler_.RunDue(static_cast<uint64_t>(esp_timer_get_time()));
+
+        if (next == PeriodicScheduler::kNever) {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(scheduler_task_config::kIdleTimeoutMs));
+            continue;
+        }
+
+        // Arm a one-shot for the next deadline. Deadlines that are already
+        // due (or nearly so) still go through the timer to yield the CPU.
+        int64_t wait_us = static_cast<int64_t>(next) - esp_timer_get_time();
+        if (wait_us < static_cast<int64_t>(scheduler_task_config::kMinArmUs)) {
+            wait_us = scheduler_task_config::kMinArmUs;
+        }
+
+        esp_timer_stop(timer_);
+        esp_timer_start_once(timer_, static_cast<uint64_t>(wait_us));
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+
+    ESP_LOGI(kTag, "Scheduler task exiting");
+    task_handle_ = nullptr;
+    vTaskDelete(nullptr);
+}
+
+}  // namespace idrive
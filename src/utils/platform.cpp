@@ -0,0 +1,30 @@
+// Copyright 2024 BMW iDrive ESP32-S3 Project
+// SPDX-License-Identifier: MIT
+//
+// ESP-IDF implementation of the platform functions in utils.h.
+// The host build links host/src/platform.cpp (virtual clock) instead.
+
+#include "utils/utils.h"
+
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+namespace idrive::utils {
+
+uint32_t GetMillis()
+{
+    return static_cast<uint32_t>(esp_timer_get_time() / 1000ULL);
+}
+
+uint64_t GetMicros()
+{
+    return static_cast<uint64_t>(esp_timer_get_time());
+}
+
+uintptr_t CurrentTaskId()
+{
+    return reinterpret_cast<uintptr_t>(xTaskGetCurrentTaskHandle());
+}
+
+}  // namespace idrive::utils